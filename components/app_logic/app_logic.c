@@ -1,38 +1,62 @@
 // app_logic.c
 
 #include "app_logic.h"
+#include "sdkconfig.h"
 #include "esp_log.h"
 #include "feature_motor.h" 
 #include <string.h> // ****** 1. 新增：为了使用strcpy，需要包含此头文件 ******
 
 // --- 引用依赖组件的头文件 ---
 #include "event_manager.h"
+#include "event_trace.h"
 #include "feature_anim_player.h" 
+#include "feature_button.h"
 
 // --- 引用4G模块的头文件 ---
 #include "feature_4g_ml307.h"
 
 #define TAG "APP_LOGIC"
 
+// 连续短按合并成一次切换，避免积压多次完整的动画切换
+static const event_bus_policy_t s_short_press_policy = {
+    .coalesce = EVENT_COALESCE_COUNTED_MERGE,
+};
+
+// app_logic 关心的主题，在任务启动前订阅
+static const EventType_t s_app_logic_topics[] = {
+    EVENT_BUTTON_LONG_PRESS,
+#if CONFIG_APP_LOGIC_TRACE_DUMP_ON_DOUBLE_CLICK
+    EVENT_BUTTON_DOUBLE_CLICK,
+#endif
+    EVENT_4G_NETWORK_READY,
+    EVENT_4G_NETWORK_LOST,
+    EVENT_4G_NETWORK_ERROR,
+};
+
+static event_subscriber_t s_app_logic_subscriber = EVENT_SUBSCRIBER_INVALID;
+
 static void main_event_handler_task(void *pvParameters)
 {
-    QueueHandle_t queue = get_event_queue();
     AppEvent_t received_event;
     anim_type_t current_anim = ANIM_TYPE_AINI; 
 
     ESP_LOGI(TAG, "核心逻辑任务已启动，等待事件...");
 
     while(1) {
-        if (xQueueReceive(queue, &received_event, portMAX_DELAY) == pdPASS) {
+        if (event_bus_receive(s_app_logic_subscriber, &received_event, portMAX_DELAY) == pdPASS) {
             
             switch (received_event.event_type) {
                 
                 case EVENT_BUTTON_SHORT_PRESS:
-                    ESP_LOGI(TAG, "收到按键短按，切换动画...");
+                    // count 为同一按键合并的短按次数，一次性前进到最终的动画
+                    ESP_LOGI(TAG, "收到按键%u短按 (x%u)，切换动画...",
+                             BUTTON_EVENT_ID(received_event.arg), received_event.count);
                     
-                    current_anim++;
-                    if (current_anim > ANIM_TYPE_ZUOGUOYOUPAN) { 
-                        current_anim = ANIM_TYPE_AINI;
+                    for (uint32_t i = 0; i < received_event.count; i++) {
+                        current_anim++;
+                        if (current_anim > ANIM_TYPE_ZUOGUOYOUPAN) { 
+                            current_anim = ANIM_TYPE_AINI;
+                        }
                     }
                     anim_player_switch_animation(current_anim);
                     break;
@@ -44,14 +68,40 @@ static void main_event_handler_task(void *pvParameters)
                     Feature4GEvent_t event_ws_connect;
                     event_ws_connect.event_type = EVENT_4G_WEBSOCKET_CONNECT;
                     // 设置要连接的服务器URL
-                    strcpy(event_ws_connect.data.ws_connect.url, "wss://echo.websocket.events");
+                    event_ws_connect.payload = event_payload_from_str("wss://echo.websocket.events");
+                    if (event_ws_connect.payload == NULL) {
+                        ESP_LOGW(TAG, "分配WebSocket URL负载失败!");
+                        break;
+                    }
                     
                     BaseType_t send_result_connect = feature_4g_send_event(&event_ws_connect);
                     if (send_result_connect != pdPASS) {
                         ESP_LOGW(TAG, "发送WebSocket连接事件到4G模块失败! 返回值: %d", send_result_connect);
                     }
+                    // 4G队列已持有自己的引用
+                    event_payload_release(event_ws_connect.payload);
+                    break;
+
+                case EVENT_4G_NETWORK_READY:
+                    ESP_LOGI(TAG, "4G网络已就绪");
+                    break;
+
+                case EVENT_4G_NETWORK_LOST:
+                    ESP_LOGW(TAG, "4G网络已断开，等待模组自动恢复...");
                     break;
 
+                case EVENT_4G_NETWORK_ERROR:
+                    ESP_LOGW(TAG, "4G模组启动失败，后台重试中...");
+                    break;
+
+#if CONFIG_APP_LOGIC_TRACE_DUMP_ON_DOUBLE_CLICK
+                case EVENT_BUTTON_DOUBLE_CLICK:
+                    // 调试固件: 双击输出事件延迟统计，用于排查按键到动画/网络动作的响应时间
+                    ESP_LOGI(TAG, "收到双击事件，输出事件延迟统计...");
+                    event_trace_dump(0);
+                    break;
+#endif
+
                 // // ****** 3. 修改：将双击事件的行为从MQTT测试改为发送WebSocket消息 ******
                 // case EVENT_BUTTON_DOUBLE_CLICK:
                 //     ESP_LOGI(TAG, "收到双击事件，请求发送WebSocket文本消息...");
@@ -59,24 +109,36 @@ static void main_event_handler_task(void *pvParameters)
                 //     Feature4GEvent_t event_ws_send_text;
                 //     event_ws_send_text.event_type = EVENT_4G_WEBSOCKET_SEND_TEXT;
                 //     // 设置要发送的文本内容
-                //     strcpy(event_ws_send_text.data.ws_send_text.text, "Hello, this is a test message from ESP32!");
+                //     event_ws_send_text.payload = event_payload_from_str("Hello, this is a test message from ESP32!");
 
                 //     BaseType_t send_result_send = feature_4g_send_event(&event_ws_send_text);
                 //     if (send_result_send != pdPASS) {
                 //         ESP_LOGW(TAG, "发送WebSocket文本事件到4G模块失败! 返回值: %d", send_result_send);
                 //     }
+                //     event_payload_release(event_ws_send_text.payload);
                 //     break;
                 
                 default:
                     ESP_LOGW(TAG, "收到未知的事件类型: %d", received_event.event_type);
                     break;
             }
+            event_payload_release(received_event.payload);
         }
     }
 }
 
 void app_logic_task_start(void)
 {
+    s_app_logic_subscriber = event_bus_subscriber_create("app_logic", EVENT_BUS_DEFAULT_DEPTH);
+    if (s_app_logic_subscriber == EVENT_SUBSCRIBER_INVALID) {
+        ESP_LOGE(TAG, "创建事件订阅者失败，核心逻辑任务无法启动!");
+        return;
+    }
+    event_bus_subscribe_with_policy(s_app_logic_subscriber, EVENT_BUTTON_SHORT_PRESS, &s_short_press_policy);
+    for (size_t i = 0; i < sizeof(s_app_logic_topics) / sizeof(s_app_logic_topics[0]); i++) {
+        event_bus_subscribe(s_app_logic_subscriber, s_app_logic_topics[i]);
+    }
+
     xTaskCreate(
         main_event_handler_task,
         "main_event_task",
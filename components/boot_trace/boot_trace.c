@@ -0,0 +1,62 @@
+#include "boot_trace.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#define TAG "BOOT_TRACE"
+
+static boot_trace_stage_t s_stages[BOOT_TRACE_MAX_STAGES];
+static uint32_t s_total_marks = 0;   // 累计记录次数，取模即为环形写入位置
+static int64_t s_last_timestamp_us = 0;
+static portMUX_TYPE s_trace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void boot_trace_mark(const char *name)
+{
+    // 先取时间再进临界区，临界区内只做拷贝
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&s_trace_lock);
+    boot_trace_stage_t *stage = &s_stages[s_total_marks % BOOT_TRACE_MAX_STAGES];
+    strlcpy(stage->name, name ? name : "?", sizeof(stage->name));
+    stage->timestamp_us = now;
+    stage->delta_us = now - s_last_timestamp_us;
+    s_last_timestamp_us = now;
+    s_total_marks++;
+    taskEXIT_CRITICAL(&s_trace_lock);
+}
+
+void boot_trace_get_summary(boot_trace_summary_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_trace_lock);
+    uint32_t count = s_total_marks < BOOT_TRACE_MAX_STAGES ? s_total_marks : BOOT_TRACE_MAX_STAGES;
+    uint32_t first = s_total_marks - count; // 最早一条仍保留的记录
+    for (uint32_t i = 0; i < count; i++) {
+        out->stages[i] = s_stages[(first + i) % BOOT_TRACE_MAX_STAGES];
+    }
+    out->count = count;
+    out->dropped = first;
+    out->total_us = s_last_timestamp_us;
+    taskEXIT_CRITICAL(&s_trace_lock);
+}
+
+void boot_trace_dump(void)
+{
+    // 汇总结构体较大，放在静态区，避免占用调用方 (通常是 main 任务) 的栈
+    static boot_trace_summary_t s_summary;
+    boot_trace_get_summary(&s_summary);
+
+    for (uint32_t i = 0; i < s_summary.count; i++) {
+        const boot_trace_stage_t *stage = &s_summary.stages[i];
+        ESP_LOGI(TAG, "BOOT_TRACE,%lu,%s,%lld,%lld",
+                 (unsigned long)(s_summary.dropped + i), stage->name,
+                 (long long)stage->timestamp_us, (long long)stage->delta_us);
+    }
+    ESP_LOGI(TAG, "BOOT_TRACE_TOTAL,%lu,%lld,%lu",
+             (unsigned long)s_summary.count, (long long)s_summary.total_us,
+             (unsigned long)s_summary.dropped);
+}
@@ -0,0 +1,64 @@
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 环形缓冲区最多保留的阶段数，超出后覆盖最早的记录
+#define BOOT_TRACE_MAX_STAGES 24
+// 阶段名称最大长度 (含结束符)，过长会被截断
+#define BOOT_TRACE_NAME_LEN   24
+
+/**
+ * @brief 单个启动阶段的记录
+ */
+typedef struct {
+    char     name[BOOT_TRACE_NAME_LEN]; // 阶段名称
+    int64_t  timestamp_us;              // 阶段完成时刻 (esp_timer 时间，上电起算)
+    int64_t  delta_us;                  // 距上一个阶段的耗时
+} boot_trace_stage_t;
+
+/**
+ * @brief 启动耗时汇总，按记录顺序排列 (最早的在前)
+ */
+typedef struct {
+    uint32_t           count;         // stages 中有效的记录数
+    uint32_t           dropped;       // 因环形缓冲区写满而被覆盖的记录数
+    int64_t            total_us;      // 最后一个阶段的时间戳
+    boot_trace_stage_t stages[BOOT_TRACE_MAX_STAGES];
+} boot_trace_summary_t;
+
+/**
+ * @brief 记录一个启动阶段完成的时间点
+ *
+ * 可在任意任务中调用 (不可在ISR中调用)，名称会被拷贝，调用方无需保留字符串。
+ *
+ * @param name 阶段名称，建议只使用字母、数字和下划线，便于解析
+ */
+void boot_trace_mark(const char *name);
+
+/**
+ * @brief 获取当前已记录的启动阶段汇总
+ *
+ * @param out 输出参数，不可为NULL
+ */
+void boot_trace_get_summary(boot_trace_summary_t *out);
+
+/**
+ * @brief 通过日志输出启动耗时汇总
+ *
+ * 每个阶段输出一行，格式固定，便于脚本从串口日志中解析:
+ *   BOOT_TRACE,<序号>,<阶段名>,<时间戳us>,<阶段耗时us>
+ * 最后输出一行合计:
+ *   BOOT_TRACE_TOTAL,<阶段数>,<总耗时us>,<被覆盖数>
+ */
+void boot_trace_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,23 +1,98 @@
 #include "bsp_button.h"
 #include "driver/gpio.h"
 #include "soc/gpio_num.h"
+#include "esp_attr.h"
+#include "esp_log.h"
 
-#define BUTTON_GPIO GPIO_NUM_47
+#define TAG "BSP_BUTTON"
+
+// 按键引脚表，下标即按键ID。增加按键只需在这里追加引脚 (并同步 BSP_BUTTON_NUM)
+static const gpio_num_t s_button_pins[BSP_BUTTON_NUM] = {
+    GPIO_NUM_47,
+};
+
+static bsp_button_edge_cb_t s_edge_cb = NULL;
+static void *s_edge_cb_arg = NULL;
+
+static void IRAM_ATTR button_gpio_isr_handler(void *arg)
+{
+    if (s_edge_cb) {
+        s_edge_cb((uint32_t)(uintptr_t)arg, s_edge_cb_arg);
+    }
+}
 
 esp_err_t bsp_button_init(void)
 {
+    uint64_t pin_mask = 0;
+    for (int i = 0; i < BSP_BUTTON_NUM; i++) {
+        pin_mask |= (1ULL << s_button_pins[i]);
+    }
+
     gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << BUTTON_GPIO),
+        .pin_bit_mask = pin_mask,
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_ENABLE, // 使用内部上拉电阻
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,   // 中断在注册边沿回调时再打开
     };
     return gpio_config(&io_conf);
 }
 
-bool bsp_button_is_pressed(void)
+bool bsp_button_is_pressed(uint32_t button_id)
 {
+    if (button_id >= BSP_BUTTON_NUM) {
+        return false;
+    }
     // 因为使用了上拉电阻，所以当按钮按下时，GPIO电平为低(0)
-    return (gpio_get_level(BUTTON_GPIO) == 0);
+    return (gpio_get_level(s_button_pins[button_id]) == 0);
+}
+
+uint32_t bsp_button_get_pressed_mask(void)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < BSP_BUTTON_NUM; i++) {
+        if (gpio_get_level(s_button_pins[i]) == 0) {
+            mask |= (1UL << i);
+        }
+    }
+    return mask;
+}
+
+esp_err_t bsp_button_set_edge_callback(bsp_button_edge_cb_t cb, void *arg)
+{
+    if (cb == NULL) {
+        for (int i = 0; i < BSP_BUTTON_NUM; i++) {
+            gpio_intr_disable(s_button_pins[i]);
+            gpio_isr_handler_remove(s_button_pins[i]);
+        }
+        s_edge_cb = NULL;
+        s_edge_cb_arg = NULL;
+        return ESP_OK;
+    }
+
+    // GPIO中断服务可能已被其他模块安装，重复安装返回 ESP_ERR_INVALID_STATE，可以忽略
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "安装GPIO中断服务失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    s_edge_cb_arg = arg;
+    s_edge_cb = cb;
+
+    // 按下和释放都需要感知，使用双边沿触发，中断参数为按键ID
+    for (int i = 0; i < BSP_BUTTON_NUM && ret == ESP_OK; i++) {
+        ret = gpio_set_intr_type(s_button_pins[i], GPIO_INTR_ANYEDGE);
+        if (ret == ESP_OK) {
+            ret = gpio_isr_handler_add(s_button_pins[i], button_gpio_isr_handler, (void *)(uintptr_t)i);
+        }
+        if (ret == ESP_OK) {
+            ret = gpio_intr_enable(s_button_pins[i]);
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "配置按键中断失败: %s", esp_err_to_name(ret));
+        s_edge_cb = NULL;
+    }
+    return ret;
 }
@@ -17,6 +17,7 @@
 #include "driver/spi_master.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 
 // =================================================================================================
 // SECTION 2: INTERNAL GC9A01 DRIVER (PRIVATE IMPLEMENTATION)
@@ -295,6 +296,7 @@ static esp_lcd_panel_handle_t s_panel_handle = NULL;
 static SemaphoreHandle_t s_dma_done_sem = NULL;
 static SemaphoreHandle_t s_lcd_mutex = NULL;
 static uint8_t s_last_brightness = 255;
+static volatile int64_t s_draw_done_us = 0; // 最近一次DMA传输完成的时刻 (esp_timer 时基)
 
 // --- Private BSP functions ---
 
@@ -302,6 +304,7 @@ static bool IRAM_ATTR lcd_trans_done_cb(esp_lcd_panel_io_handle_t panel_io, esp_
 {
     SemaphoreHandle_t dma_done_sem = (SemaphoreHandle_t)user_ctx;
     BaseType_t task_woken = pdFALSE;
+    s_draw_done_us = esp_timer_get_time();
     xSemaphoreGiveFromISR(dma_done_sem, &task_woken);
     return (task_woken == pdTRUE);
 }
@@ -401,6 +404,11 @@ void bsp_lcd_wait_for_draw_done(void)
     xSemaphoreTake(s_dma_done_sem, portMAX_DELAY);
 }
 
+int64_t bsp_lcd_get_draw_done_us(void)
+{
+    return s_draw_done_us;
+}
+
 esp_err_t bsp_lcd_set_power(bool on)
 {
     esp_err_t ret = ESP_FAIL;
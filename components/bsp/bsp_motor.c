@@ -1,6 +1,7 @@
 #include "bsp_motor.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_attr.h"
 
 static const char* TAG = "mada_driver";
 
@@ -8,6 +9,9 @@ static const char* TAG = "mada_driver";
 static struct {
     mada_driver_config_t config;
     bool is_initialized;
+    bool fade_installed;
+    mada_driver_fade_done_cb_t fade_cb;
+    void* fade_arg;
 } s_driver_state = {
     .is_initialized = false
 };
@@ -17,10 +21,12 @@ static struct {
 #define PWM_RESOLUTION      LEDC_TIMER_8_BIT
 #define PWM_TIMER           LEDC_TIMER_0
 #define PWM_SPEED_MODE      LEDC_LOW_SPEED_MODE
+#define PWM_MAX_DUTY        ((1 << PWM_RESOLUTION) - 1)
 
 // 内部函数声明
 static esp_err_t initialize_pwm(void);
 static esp_err_t initialize_digital(void);
+static void prv_fade_abort(void);
 
 
 esp_err_t mada_driver_init(const mada_driver_config_t* config) {
@@ -50,6 +56,11 @@ void mada_driver_deinit(void) {
     if (!s_driver_state.is_initialized) return;
     
     mada_driver_off();
+    if (s_driver_state.fade_installed) {
+        ledc_fade_func_uninstall();
+        s_driver_state.fade_installed = false;
+        s_driver_state.fade_cb = NULL;
+    }
     // 可以添加 gpio_reset_pin 等清理操作
     s_driver_state.is_initialized = false;
     ESP_LOGI(TAG, "Mada driver deinitialized.");
@@ -59,6 +70,7 @@ void mada_driver_on(void) {
     if (!s_driver_state.is_initialized) return;
 
     if (s_driver_state.config.mode == MADA_CONTROL_PWM) {
+        prv_fade_abort();
         // 默认50%强度启动
         uint32_t duty = (50 * 255) / 100;
         ledc_set_duty(PWM_SPEED_MODE, s_driver_state.config.ledc_channel, duty);
@@ -72,6 +84,7 @@ void mada_driver_off(void) {
     if (!s_driver_state.is_initialized) return;
 
     if (s_driver_state.config.mode == MADA_CONTROL_PWM) {
+        prv_fade_abort();
         ledc_set_duty(PWM_SPEED_MODE, s_driver_state.config.ledc_channel, 0);
         ledc_update_duty(PWM_SPEED_MODE, s_driver_state.config.ledc_channel);
     } else {
@@ -84,11 +97,81 @@ void mada_driver_set_intensity(uint8_t intensity) {
     
     if (intensity > 100) intensity = 100;
 
-    uint32_t duty = (intensity * ((1 << PWM_RESOLUTION) - 1)) / 100;
+    prv_fade_abort();
+    uint32_t duty = (intensity * PWM_MAX_DUTY) / 100;
     ledc_set_duty(PWM_SPEED_MODE, s_driver_state.config.ledc_channel, duty);
     ledc_update_duty(PWM_SPEED_MODE, s_driver_state.config.ledc_channel);
 }
 
+static bool IRAM_ATTR prv_fade_end_isr(const ledc_cb_param_t* param, void* arg) {
+    if (param->event != LEDC_FADE_END_EVT || s_driver_state.fade_cb == NULL) {
+        return false;
+    }
+    return s_driver_state.fade_cb(s_driver_state.fade_arg);
+}
+
+esp_err_t mada_driver_fade_init(mada_driver_fade_done_cb_t cb, void* arg) {
+    ESP_RETURN_ON_FALSE(s_driver_state.is_initialized, ESP_ERR_INVALID_STATE, TAG, "Driver not initialized");
+    if (s_driver_state.config.mode != MADA_CONTROL_PWM) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    s_driver_state.fade_cb = cb;
+    s_driver_state.fade_arg = arg;
+    if (s_driver_state.fade_installed) {
+        return ESP_OK;
+    }
+
+    ESP_RETURN_ON_ERROR(ledc_fade_func_install(0), TAG, "ledc_fade_func_install failed");
+    ledc_cbs_t cbs = {
+        .fade_cb = prv_fade_end_isr,
+    };
+    esp_err_t ret = ledc_cb_register(PWM_SPEED_MODE, s_driver_state.config.ledc_channel, &cbs, NULL);
+    if (ret != ESP_OK) {
+        ledc_fade_func_uninstall();
+        ESP_LOGE(TAG, "ledc_cb_register failed");
+        return ret;
+    }
+    s_driver_state.fade_installed = true;
+    return ESP_OK;
+}
+
+esp_err_t mada_driver_fade_start(uint8_t level, uint32_t time_ms) {
+    if (!s_driver_state.is_initialized || !s_driver_state.fade_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t duty = ((uint32_t)level * PWM_MAX_DUTY) / 255;
+    ESP_RETURN_ON_ERROR(ledc_set_fade_with_time(PWM_SPEED_MODE, s_driver_state.config.ledc_channel, duty, (int)time_ms),
+                        TAG, "ledc_set_fade_with_time failed");
+    return ledc_fade_start(PWM_SPEED_MODE, s_driver_state.config.ledc_channel, LEDC_FADE_NO_WAIT);
+}
+
+void mada_driver_fade_stop(void) {
+    if (!s_driver_state.is_initialized) return;
+    prv_fade_abort();
+}
+
+void mada_driver_set_level(uint8_t level) {
+    if (!s_driver_state.is_initialized) return;
+
+    if (s_driver_state.config.mode == MADA_CONTROL_PWM) {
+        prv_fade_abort();
+        uint32_t duty = ((uint32_t)level * PWM_MAX_DUTY) / 255;
+        ledc_set_duty(PWM_SPEED_MODE, s_driver_state.config.ledc_channel, duty);
+        ledc_update_duty(PWM_SPEED_MODE, s_driver_state.config.ledc_channel);
+    } else {
+        gpio_set_level(s_driver_state.config.pin, level > 0 ? 1 : 0);
+    }
+}
+
+// 正在渐变的通道不能直接改占空比，先停掉硬件渐变
+static void prv_fade_abort(void) {
+    if (s_driver_state.fade_installed) {
+        ledc_fade_stop(PWM_SPEED_MODE, s_driver_state.config.ledc_channel);
+    }
+}
+
 static esp_err_t initialize_pwm() {
     ledc_timer_config_t ledc_timer = {
         .speed_mode = PWM_SPEED_MODE,
@@ -10,7 +10,11 @@ static const char* TAG = "BSP_ML307";
 #define MODEM_UART_TX_PIN   GPIO_NUM_14
 #define MODEM_UART_RX_PIN   GPIO_NUM_13
 #define MODEM_PWRKEY_PIN    GPIO_NUM_15
+#define MODEM_UART_RTS_PIN  GPIO_NUM_NC  // 当前板子未引出 RTS/CTS，接线后填入引脚即可启用硬件流控
+#define MODEM_UART_CTS_PIN  GPIO_NUM_NC
+#define MODEM_UART_RX_BUFFER_SIZE (16 * 1024)  // 驱动接收环形缓冲区，高波特率下没有流控时靠它吸收突发
 #define MODEM_BAUD_RATE     115200
+#define MODEM_MAX_BAUD_RATE 921600  // 协商上限，走线短且模组支持时可提高到 3000000
 // ====================================================================
 
 /**
@@ -22,7 +26,11 @@ void bsp_ml307_get_config(bsp_ml307_config_t *config)
         config->uart_tx_pin = MODEM_UART_TX_PIN;
         config->uart_rx_pin = MODEM_UART_RX_PIN;
         config->pwrkey_pin  = MODEM_PWRKEY_PIN;
+        config->uart_rts_pin = MODEM_UART_RTS_PIN;
+        config->uart_cts_pin = MODEM_UART_CTS_PIN;
+        config->uart_rx_buffer_size = MODEM_UART_RX_BUFFER_SIZE;
         config->baud_rate   = MODEM_BAUD_RATE;
+        config->max_baud_rate = MODEM_MAX_BAUD_RATE;
     }
 }
 
@@ -3,19 +3,52 @@
 
 #include "esp_err.h"
 #include <stdbool.h>
+#include <stdint.h>
+
+// 板上按键数量，按键ID为 0 ~ BSP_BUTTON_NUM-1
+#define BSP_BUTTON_NUM 1
+
 /**
- * @brief 初始化按钮的GPIO
+ * @brief 初始化所有按钮的GPIO
  * 
  * @return esp_err_t 
  */
 esp_err_t bsp_button_init(void);
 
 /**
- * @brief 获取按钮当前是否被按下
+ * @brief 获取指定按钮当前是否被按下
  * 
+ * @param button_id 按键ID
  * @return true 按钮被按下
- * @return false 按钮未被按下
+ * @return false 按钮未被按下 (或ID非法)
+ */
+bool bsp_button_is_pressed(uint32_t button_id);
+
+/**
+ * @brief 一次读取所有按钮的状态
+ * 
+ * @return 位掩码，第 i 位为1表示按键 i 被按下
+ */
+uint32_t bsp_button_get_pressed_mask(void);
+
+/**
+ * @brief 按键边沿回调，在GPIO中断上下文中执行，只能调用 FromISR 类接口
+ *
+ * @param button_id 产生边沿的按键ID
+ * @param arg       注册时传入的参数
+ */
+typedef void (*bsp_button_edge_cb_t)(uint32_t button_id, void *arg);
+
+/**
+ * @brief 注册按键边沿回调，并打开所有按键的按下/释放双边沿中断
+ *
+ * 回调只表示"电平可能发生了变化"，按键存在抖动，调用方需要自行消抖后
+ * 再读取稳定电平。
+ *
+ * @param cb  回调函数，传NULL则关闭中断并注销回调
+ * @param arg 传给回调的参数
+ * @return esp_err_t 
  */
-bool bsp_button_is_pressed(void);
+esp_err_t bsp_button_set_edge_callback(bsp_button_edge_cb_t cb, void *arg);
 
-#endif // BSP_BUTTON_Hv
\ No newline at end of file
+#endif // BSP_BUTTON_H
@@ -44,6 +44,16 @@ esp_err_t bsp_lcd_draw_bitmap(int x_start, int y_start, int x_end, int y_end, co
  */
 void bsp_lcd_wait_for_draw_done(void);
 
+/**
+ * @brief 获取最近一次DMA传输完成的时刻
+ *
+ * 时间戳在传输完成中断中以 esp_timer_get_time() 记录，与事件总线等模块共用同一时基，
+ * 可用于把其他输出 (如震动) 对齐到画面真正上屏的时间。
+ *
+ * @return int64_t 微秒时间戳，尚未完成过传输时为 0
+ */
+int64_t bsp_lcd_get_draw_done_us(void);
+
 /**
  * @brief 控制屏幕的电源（开/关）
  * @param on true: 打开屏幕, false: 关闭屏幕
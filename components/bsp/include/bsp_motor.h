@@ -4,6 +4,8 @@
 #include "driver/gpio.h"
 #include "driver/ledc.h"
 #include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 // 定义马达的控制模式
 typedef enum {
@@ -48,4 +50,40 @@ void mada_driver_off(void);
  */
 void mada_driver_set_intensity(uint8_t intensity);
 
+/**
+ * @brief 硬件渐变结束回调 (在 LEDC 中断上下文中调用，必须放在 IRAM 且不能阻塞)
+ *
+ * @return true 表示唤醒了更高优先级的任务，需要在退出中断时切换
+ */
+typedef bool (*mada_driver_fade_done_cb_t)(void* arg);
+
+/**
+ * @brief 安装 LEDC 硬件渐变服务并注册渐变结束回调 (仅PWM模式)
+ *
+ * @return ESP_ERR_NOT_SUPPORTED 数字模式下不支持硬件渐变
+ */
+esp_err_t mada_driver_fade_init(mada_driver_fade_done_cb_t cb, void* arg);
+
+/**
+ * @brief 以硬件渐变方式在 time_ms 内把输出变化到 level，立即返回
+ *
+ * 渐变完成后调用 mada_driver_fade_init() 注册的回调。不可在中断中调用:
+ * IDF 的渐变接口在回调返回后才释放通道，新的渐变必须由任务发起。
+ *
+ * @param level 目标强度 (0-255，按占空比分辨率缩放)
+ */
+esp_err_t mada_driver_fade_start(uint8_t level, uint32_t time_ms);
+
+/**
+ * @brief 中止正在进行的硬件渐变，输出停留在当前占空比
+ */
+void mada_driver_fade_stop(void);
+
+/**
+ * @brief 立即设置输出强度 (0-255)
+ *
+ * PWM 模式下按分辨率换算占空比；数字模式下 level > 0 即为开启。
+ */
+void mada_driver_set_level(uint8_t level);
+
 #endif // MADA_DRIVER_H
\ No newline at end of file
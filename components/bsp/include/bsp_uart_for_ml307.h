@@ -16,7 +16,11 @@ typedef struct {
     gpio_num_t uart_tx_pin; ///< UART发送引脚
     gpio_num_t uart_rx_pin; ///< UART接收引脚
     gpio_num_t pwrkey_pin;  ///< 电源按键引脚
-    int baud_rate;          ///< UART通信波特率
+    gpio_num_t uart_rts_pin; ///< UART RTS引脚，GPIO_NUM_NC 表示不使用硬件流控
+    gpio_num_t uart_cts_pin; ///< UART CTS引脚，GPIO_NUM_NC 表示不使用硬件流控
+    int uart_rx_buffer_size; ///< UART驱动接收缓冲区字节数
+    int baud_rate;          ///< UART通信波特率 (模组出厂默认值)
+    int max_baud_rate;      ///< 波特率协商的上限
 } bsp_ml307_config_t;
 
 /**
@@ -1,25 +1,390 @@
 #include "event_manager.h"
 #include "esp_log.h"
+#include "event_trace.h"
+#include "esp_attr.h"
+#include <stdbool.h>
+#include <string.h>
 
 #define TAG "EVENT_MANAGER"
 
-// 将全局变量改为静态变量，只能在本文件内访问
-static QueueHandle_t s_app_event_queue = NULL; // <-- 修改点：添加 static 并重命名 (例如使用 s_ 前缀)
+_Static_assert(EVENT_BUS_MAX_SUBSCRIBERS <= 32, "订阅者位图为32位");
 
-// 新增的实现函数，返回静态的队列句柄
-QueueHandle_t get_event_queue(void) // <-- 新增的函数实现
+#define TOKEN_SCALE (1000)  // 令牌以千分之一为单位计数，避免浮点运算
+
+typedef struct {
+    const char*       name;
+    QueueHandle_t     queue;
+    event_bus_stats_t stats;
+} event_subscriber_slot_t;
+
+// 每个 (订阅者, 主题) 的策略和运行状态
+typedef struct {
+    event_bus_policy_t policy;
+    bool               pending;      // 合并类策略: 队列中已有该主题的占位项
+    uint16_t           merge_count;  // 合并类策略: 待处理事件合并了多少个事件
+    AppEvent_t         latest;       // 合并类策略: 待处理事件的内容 (持有负载引用)
+    uint32_t           tokens;       // 令牌桶剩余令牌 (TOKEN_SCALE 为一个令牌)
+    TickType_t         last_refill;
+} topic_state_t;
+
+// 每个主题一个订阅者位图，发布时按位遍历，不做任何字符串匹配
+static volatile uint32_t s_topic_subscribers[EVENT_TYPE_MAX];
+// 配置了非默认策略的订阅者位图，其余订阅者走无锁快速路径
+static volatile uint32_t s_topic_policy_mask[EVENT_TYPE_MAX];
+static topic_state_t s_topic_state[EVENT_BUS_MAX_SUBSCRIBERS][EVENT_TYPE_MAX];
+static event_subscriber_slot_t s_subscribers[EVENT_BUS_MAX_SUBSCRIBERS];
+static uint32_t s_subscriber_count = 0;
+static bool s_bus_initialized = false;
+static portMUX_TYPE s_bus_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static inline bool prv_subscriber_valid(event_subscriber_t subscriber)
+{
+    return subscriber >= 0 && (uint32_t)subscriber < s_subscriber_count;
+}
+
+static inline bool prv_topic_valid(EventType_t topic)
+{
+    return topic > EVENT_NONE && topic < EVENT_TYPE_MAX;
+}
+
+static inline bool prv_is_merging(const topic_state_t *state)
+{
+    return state->policy.coalesce == EVENT_COALESCE_LATEST_WINS ||
+           state->policy.coalesce == EVENT_COALESCE_COUNTED_MERGE;
+}
+
+static inline TickType_t prv_tick_now(void)
+{
+    return xPortInIsrContext() ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+}
+
+// 令牌桶: 按经过的时间补充令牌，够一个令牌则放行。调用方需持有 s_bus_lock
+static bool prv_take_token_locked(topic_state_t *state)
+{
+    if (state->policy.rate_per_sec == 0) {
+        return true;
+    }
+
+    TickType_t now = prv_tick_now();
+    uint32_t elapsed_ms = (uint32_t)(now - state->last_refill) * portTICK_PERIOD_MS;
+    uint32_t capacity = (uint32_t)state->policy.burst * TOKEN_SCALE;
+    // elapsed_ms * rate 即补充的千分之一令牌数，桶满后不再累计，防止溢出
+    uint64_t refill = (uint64_t)elapsed_ms * state->policy.rate_per_sec;
+    state->tokens = (refill >= capacity - state->tokens) ? capacity : state->tokens + (uint32_t)refill;
+    state->last_refill = now;
+
+    if (state->tokens < TOKEN_SCALE) {
+        return false;
+    }
+    state->tokens -= TOKEN_SCALE;
+    return true;
+}
+
+// 占位项的 count 为0，普通事件由发布时填为1
+static inline bool prv_is_placeholder(const AppEvent_t *event)
+{
+    return event->count == 0 && prv_topic_valid(event->event_type);
+}
+
+// 丢弃一个已出队的事件。合并类主题的占位项需要同时清除待处理状态
+static void prv_discard_dequeued(int id, const AppEvent_t *event)
 {
-    return s_app_event_queue;
+    event_payload_t *payload = event->payload;
+    if (prv_is_placeholder(event)) {
+        topic_state_t *state = &s_topic_state[id][event->event_type];
+        portENTER_CRITICAL_SAFE(&s_bus_lock);
+        if (prv_is_merging(state) && state->pending) {
+            state->pending = false;
+            payload = state->latest.payload;
+            state->latest.payload = NULL;
+        }
+        portEXIT_CRITICAL_SAFE(&s_bus_lock);
+    }
+    event_payload_release(payload);
 }
-// 初始化消息队列
-void event_queue_init(void)
+
+static bool prv_queue_send(QueueHandle_t queue, const AppEvent_t *event, TickType_t wait, BaseType_t *pxHigherPriorityTaskWoken)
 {
-    // 创建一个队列，可以容纳10个 AppEvent_t 类型的消息
-    // 对于大多数应用来说，10-20的深度是足够的
-    s_app_event_queue = xQueueCreate(10, sizeof(AppEvent_t));
-    if (s_app_event_queue == NULL) {
-        ESP_LOGE(TAG, "消息队列创建失败!");
+    if (xPortInIsrContext()) {
+        return xQueueSendFromISR(queue, event, pxHigherPriorityTaskWoken) == pdPASS;
+    }
+    return xQueueSend(queue, event, wait) == pdPASS;
+}
+
+// 按订阅者的策略投递一个事件，返回 false 表示事件因队列已满被丢弃
+static bool prv_deliver_with_policy(int id, const AppEvent_t *event, TickType_t wait, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    event_subscriber_slot_t *subscriber = &s_subscribers[id];
+    topic_state_t *state = &s_topic_state[id][event->event_type];
+    event_payload_t *replaced = NULL;
+
+    portENTER_CRITICAL_SAFE(&s_bus_lock);
+    if (!prv_take_token_locked(state)) {
+        subscriber->stats.rate_limited++;
+        portEXIT_CRITICAL_SAFE(&s_bus_lock);
+        return true;
+    }
+
+    bool merging = prv_is_merging(state);
+    if (merging && state->pending && state->policy.coalesce == EVENT_COALESCE_COUNTED_MERGE &&
+        state->latest.arg != event->arg) {
+        // 计数合并只合并 arg 相同的事件，arg 不同的事件按普通事件单独入队
+        merging = false;
+    }
+    if (merging) {
+        if (state->pending) {
+            // 已有待处理事件，合并到它上面，不再入队
+            if (state->policy.coalesce == EVENT_COALESCE_LATEST_WINS) {
+                replaced = state->latest.payload;
+                state->latest = *event;
+                event_payload_ref(event->payload);
+            }
+            if (state->merge_count < UINT16_MAX) {
+                state->merge_count++;
+            }
+            subscriber->stats.merged++;
+            portEXIT_CRITICAL_SAFE(&s_bus_lock);
+            event_payload_release(replaced);
+            return true;
+        }
+        state->pending = true;
+        state->merge_count = 1;
+        state->latest = *event;
+        event_payload_ref(event->payload);
+    }
+    portEXIT_CRITICAL_SAFE(&s_bus_lock);
+
+    // 合并类主题只入队一个不带负载的占位项 (count 为0)，出队时再换成待处理事件的内容
+    AppEvent_t item = *event;
+    if (merging) {
+        item.payload = NULL;
+        item.count = 0;
     } else {
-        ESP_LOGI(TAG, "消息队列创建成功!");
+        event_payload_ref(event->payload);
+    }
+
+    bool sent = prv_queue_send(subscriber->queue, &item, wait, pxHigherPriorityTaskWoken);
+    if (!sent && state->policy.coalesce == EVENT_COALESCE_DROP_OLDEST) {
+        // 挤掉队列中最早的事件腾出位置
+        AppEvent_t oldest;
+        BaseType_t got = xPortInIsrContext()
+                       ? xQueueReceiveFromISR(subscriber->queue, &oldest, pxHigherPriorityTaskWoken)
+                       : xQueueReceive(subscriber->queue, &oldest, 0);
+        if (got == pdPASS) {
+            prv_discard_dequeued(id, &oldest);
+            subscriber->stats.dropped++;
+        }
+        sent = prv_queue_send(subscriber->queue, &item, 0, pxHigherPriorityTaskWoken);
+    }
+
+    if (!sent) {
+        if (merging) {
+            portENTER_CRITICAL_SAFE(&s_bus_lock);
+            state->pending = false;
+            replaced = state->latest.payload;
+            state->latest.payload = NULL;
+            portEXIT_CRITICAL_SAFE(&s_bus_lock);
+            event_payload_release(replaced);
+        } else {
+            event_payload_release(item.payload);
+        }
+        subscriber->stats.dropped++;
     }
-}
\ No newline at end of file
+    return sent;
+}
+
+static esp_err_t prv_publish(const AppEvent_t *published, TickType_t wait, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    // 拷贝一份打上发布时间戳，出队时据此计算延迟
+    AppEvent_t stamped = *published;
+    stamped.publish_us = event_trace_now_us();
+    stamped.count = 1;
+    const AppEvent_t *event = &stamped;
+
+    // 位图是32位对齐变量，读取本身是原子的
+    uint32_t mask = s_topic_subscribers[event->event_type];
+    uint32_t policy_mask = s_topic_policy_mask[event->event_type];
+    esp_err_t ret = ESP_OK;
+
+    while (mask) {
+        int id = __builtin_ctz(mask);
+        mask &= mask - 1;
+
+        if (policy_mask & (1UL << id)) {
+            if (!prv_deliver_with_policy(id, event, wait, pxHigherPriorityTaskWoken)) {
+                ret = ESP_FAIL;
+            }
+            continue;
+        }
+
+        // 默认策略走无锁快速路径，队列里的每一份事件都持有一个负载引用
+        event_payload_ref(event->payload);
+        if (!prv_queue_send(s_subscribers[id].queue, event, wait, pxHigherPriorityTaskWoken)) {
+            event_payload_release(event->payload);
+            s_subscribers[id].stats.dropped++;
+            ret = ESP_FAIL;
+        }
+    }
+    return ret;
+}
+
+void event_bus_init(void)
+{
+    taskENTER_CRITICAL(&s_bus_lock);
+    for (int i = 0; i < EVENT_TYPE_MAX; i++) {
+        s_topic_subscribers[i] = 0;
+        s_topic_policy_mask[i] = 0;
+    }
+    memset(s_topic_state, 0, sizeof(s_topic_state));
+    s_subscriber_count = 0;
+    s_bus_initialized = true;
+    taskEXIT_CRITICAL(&s_bus_lock);
+    ESP_LOGI(TAG, "事件总线初始化成功! (%d 个主题, 最多 %d 个订阅者)", EVENT_TYPE_MAX, EVENT_BUS_MAX_SUBSCRIBERS);
+}
+
+event_subscriber_t event_bus_subscriber_create(const char *name, uint32_t queue_depth)
+{
+    if (!s_bus_initialized) {
+        ESP_LOGE(TAG, "事件总线未初始化!");
+        return EVENT_SUBSCRIBER_INVALID;
+    }
+
+    // 队列在临界区外创建，槽位在临界区内分配
+    QueueHandle_t queue = xQueueCreate(queue_depth ? queue_depth : EVENT_BUS_DEFAULT_DEPTH, sizeof(AppEvent_t));
+    if (queue == NULL) {
+        ESP_LOGE(TAG, "订阅者 '%s' 队列创建失败!", name);
+        return EVENT_SUBSCRIBER_INVALID;
+    }
+
+    event_subscriber_t handle = EVENT_SUBSCRIBER_INVALID;
+    taskENTER_CRITICAL(&s_bus_lock);
+    if (s_subscriber_count < EVENT_BUS_MAX_SUBSCRIBERS) {
+        handle = (event_subscriber_t)s_subscriber_count;
+        s_subscribers[handle].name = name;
+        s_subscribers[handle].queue = queue;
+        memset(&s_subscribers[handle].stats, 0, sizeof(s_subscribers[handle].stats));
+        s_subscriber_count++;
+    }
+    taskEXIT_CRITICAL(&s_bus_lock);
+
+    if (handle == EVENT_SUBSCRIBER_INVALID) {
+        ESP_LOGE(TAG, "订阅者数量已达上限，无法创建 '%s'", name);
+        vQueueDelete(queue);
+    } else {
+        ESP_LOGI(TAG, "创建订阅者 '%s' (id=%d)", name, handle);
+    }
+    return handle;
+}
+
+esp_err_t event_bus_subscribe(event_subscriber_t subscriber, EventType_t topic)
+{
+    return event_bus_subscribe_with_policy(subscriber, topic, NULL);
+}
+
+esp_err_t event_bus_subscribe_with_policy(event_subscriber_t subscriber, EventType_t topic, const event_bus_policy_t *policy)
+{
+    if (!prv_subscriber_valid(subscriber) || !prv_topic_valid(topic)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    event_bus_policy_t effective = { .coalesce = EVENT_COALESCE_NONE, .rate_per_sec = 0, .burst = 0 };
+    if (policy) {
+        if (policy->coalesce > EVENT_COALESCE_COUNTED_MERGE) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        effective = *policy;
+        if (effective.rate_per_sec > 0 && effective.burst == 0) {
+            effective.burst = 1;
+        }
+    }
+    bool has_policy = effective.coalesce != EVENT_COALESCE_NONE || effective.rate_per_sec > 0;
+
+    taskENTER_CRITICAL(&s_bus_lock);
+    topic_state_t *state = &s_topic_state[subscriber][topic];
+    state->policy = effective;
+    state->tokens = (uint32_t)effective.burst * TOKEN_SCALE;
+    state->last_refill = xTaskGetTickCount();
+    if (has_policy) {
+        s_topic_policy_mask[topic] |= (1UL << subscriber);
+    } else {
+        s_topic_policy_mask[topic] &= ~(1UL << subscriber);
+    }
+    s_topic_subscribers[topic] |= (1UL << subscriber);
+    taskEXIT_CRITICAL(&s_bus_lock);
+    return ESP_OK;
+}
+
+esp_err_t event_bus_unsubscribe(event_subscriber_t subscriber, EventType_t topic)
+{
+    if (!prv_subscriber_valid(subscriber) || !prv_topic_valid(topic)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&s_bus_lock);
+    s_topic_subscribers[topic] &= ~(1UL << subscriber);
+    taskEXIT_CRITICAL(&s_bus_lock);
+    return ESP_OK;
+}
+
+esp_err_t event_bus_publish(const AppEvent_t *event, TickType_t wait)
+{
+    if (event == NULL || !prv_topic_valid(event->event_type)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_bus_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return prv_publish(event, wait, NULL);
+}
+
+esp_err_t IRAM_ATTR event_bus_publish_from_isr(const AppEvent_t *event, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (event == NULL || !prv_topic_valid(event->event_type) || !s_bus_initialized) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return prv_publish(event, 0, pxHigherPriorityTaskWoken);
+}
+
+BaseType_t event_bus_receive(event_subscriber_t subscriber, AppEvent_t *out_event, TickType_t wait)
+{
+    if (!prv_subscriber_valid(subscriber) || out_event == NULL) {
+        return pdFAIL;
+    }
+    if (xQueueReceive(s_subscribers[subscriber].queue, out_event, wait) != pdPASS) {
+        return pdFAIL;
+    }
+    if (!prv_topic_valid(out_event->event_type)) {
+        return pdPASS;
+    }
+
+    // 合并类主题: 把占位项换成待处理事件的内容。
+    // 延迟按占位项 (即第一个被合并的事件) 的发布时间计算，反映最早那次事件等了多久
+    uint32_t publish_us = out_event->publish_us;
+    if (prv_is_placeholder(out_event)) {
+        topic_state_t *state = &s_topic_state[subscriber][out_event->event_type];
+        taskENTER_CRITICAL(&s_bus_lock);
+        if (prv_is_merging(state) && state->pending) {
+            *out_event = state->latest;
+            if (state->policy.coalesce == EVENT_COALESCE_COUNTED_MERGE) {
+                out_event->count = state->merge_count;
+            }
+            state->latest.payload = NULL;
+            state->pending = false;
+        } else {
+            out_event->count = 1;
+        }
+        taskEXIT_CRITICAL(&s_bus_lock);
+    }
+
+    event_trace_record((uint8_t)out_event->event_type, (uint8_t)out_event->producer, (uint8_t)subscriber,
+                       event_trace_now_us() - publish_us);
+    return pdPASS;
+}
+
+void event_bus_get_stats(event_subscriber_t subscriber, event_bus_stats_t *out_stats)
+{
+    if (!prv_subscriber_valid(subscriber) || out_stats == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_bus_lock);
+    *out_stats = s_subscribers[subscriber].stats;
+    taskEXIT_CRITICAL(&s_bus_lock);
+}
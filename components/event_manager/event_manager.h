@@ -3,29 +3,169 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "esp_err.h"
+#include "event_payload.h"
+#include <stdint.h>
 
-// 1. 定义所有可能的消息/事件类型
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 1. 定义所有可能的消息/事件类型 (同时也是事件总线的主题ID)
 typedef enum {
     EVENT_NONE = 0,
     EVENT_BUTTON_SHORT_PRESS,   // 按钮短按事件
     EVENT_BUTTON_LONG_PRESS,    // <-- 新增：按钮长按事件
     EVENT_BUTTON_DOUBLE_CLICK,  // <-- 新增：按钮双击事件
+    EVENT_BUTTON_MULTI_CLICK,   // 三连击及以上 (次数见 arg)
+    EVENT_BUTTON_HOLD_REPEAT,   // 长按后的重复触发 (次数见 arg)
+    EVENT_BUTTON_CHORD,         // 组合键 (组合键下标见 arg)
+    EVENT_4G_NETWORK_READY,     // 4G模组已检测到并注网成功
+    EVENT_4G_NETWORK_LOST,      // 4G网络断开 (模组会自动重新注网)
+    EVENT_4G_NETWORK_ERROR,     // 4G模组检测或注网失败，后台继续重试
     // 未来可以在这里添加更多事件，例如：
     // EVENT_SENSOR_DATA_READY,
     // EVENT_WIFI_CONNECTED,
+    EVENT_TYPE_MAX,             // 主题数量，必须放在最后
 } EventType_t;
 
-// 2. 定义消息的结构体
+// 事件的发布者，用于延迟追踪 (见 event_trace.h)
+typedef enum {
+    EVENT_PRODUCER_UNKNOWN = 0,
+    EVENT_PRODUCER_BUTTON,
+    EVENT_PRODUCER_4G,
+    EVENT_PRODUCER_APP_LOGIC,
+    EVENT_PRODUCER_TIMER,
+} EventProducer_t;
+
+// 2. 定义消息的结构体 (只有几个字，入队出队的拷贝开销很小)
 typedef struct {
-    EventType_t event_type; // 必须有，用来区分消息类型
-    void*       p_data;     // 可选，一个指针，用来传递额外的数据
-    uint32_t    data_len;   // 可选，数据长度
+    EventType_t      event_type; // 必须有，用来区分消息类型
+    uint32_t         arg;        // 可选，一个小的整型参数 (例如计数、错误码)
+    event_payload_t* payload;    // 可选，较大的数据通过引用计数负载传递，见 event_payload.h
+    uint16_t         producer;   // 可选，发布者 (EventProducer_t)
+    uint16_t         count;      // 由事件总线填写: COUNTED_MERGE 时为合并的事件个数，其余为1
+    uint32_t         publish_us; // 由事件总线在发布时填写，发布者无需设置
 } AppEvent_t;
 
-// 5. 新增一个函数声明，用于获取消息队列句柄
-QueueHandle_t get_event_queue(void); // <-- 新增这一行
+// 3. 事件总线配置
+#define EVENT_BUS_MAX_SUBSCRIBERS   (8)   // 最多订阅者数量 (不超过32，按位图分发)
+#define EVENT_BUS_DEFAULT_DEPTH     (10)  // 订阅者队列的默认深度
+
+// 订阅者句柄，由 event_bus_subscriber_create() 返回，小于0表示无效
+typedef int event_subscriber_t;
+#define EVENT_SUBSCRIBER_INVALID    (-1)
+
+// 4. 每个订阅者对每个主题可以单独配置合并策略和限流
+typedef enum {
+    EVENT_COALESCE_NONE = 0,      // 默认: 每个事件单独入队，队列满时丢弃新事件
+    EVENT_COALESCE_DROP_OLDEST,   // 每个事件单独入队，队列满时丢弃队列中最早的事件
+    EVENT_COALESCE_LATEST_WINS,   // 同一主题最多一个待处理事件，新事件替换旧事件
+    EVENT_COALESCE_COUNTED_MERGE, // arg 相同的事件最多一个待处理，保留第一个事件的内容，count 为合并的事件个数;
+                                  // 待处理期间 arg 不同的事件 (例如另一个按键) 单独入队，不会被合并
+} event_coalesce_t;
+
+typedef struct {
+    event_coalesce_t coalesce;
+    uint16_t rate_per_sec;   // 令牌桶速率 (每秒允许的事件数)，0表示不限流
+    uint16_t burst;          // 令牌桶容量 (允许的突发事件数)，限流时至少为1
+} event_bus_policy_t;
+
+/**
+ * @brief 订阅者的事件统计
+ */
+typedef struct {
+    uint32_t dropped;        // 队列已满被丢弃的事件数 (含 DROP_OLDEST 挤出的旧事件)
+    uint32_t merged;         // 被合并到待处理事件中的事件数
+    uint32_t rate_limited;   // 被令牌桶限流丢弃的事件数
+} event_bus_stats_t;
+
+/**
+ * @brief 初始化事件总线
+ *
+ * 必须在任何订阅/发布之前调用一次。
+ */
+void event_bus_init(void);
+
+/**
+ * @brief 创建一个订阅者，每个订阅者拥有独立的有界队列
+ *
+ * 一个订阅者通常对应一个消费任务，可以订阅任意多个主题。
+ *
+ * @param name        订阅者名称 (仅用于日志)，需保持有效
+ * @param queue_depth 队列深度，传0使用 EVENT_BUS_DEFAULT_DEPTH
+ *
+ * @return 订阅者句柄，失败返回 EVENT_SUBSCRIBER_INVALID
+ */
+event_subscriber_t event_bus_subscriber_create(const char *name, uint32_t queue_depth);
+
+/**
+ * @brief 订阅一个主题
+ *
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 句柄或主题非法
+ */
+esp_err_t event_bus_subscribe(event_subscriber_t subscriber, EventType_t topic);
+
+/**
+ * @brief 按指定策略订阅一个主题
+ *
+ * 策略只影响该订阅者，同一主题的其他订阅者互不影响。对已订阅的主题再次调用会更新策略。
+ * 合并类策略的事件在 event_bus_receive() 取出时才组装，因此取到的总是最新的内容。
+ *
+ * @param policy 为NULL时等同于 event_bus_subscribe()
+ *
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 句柄、主题或策略非法
+ */
+esp_err_t event_bus_subscribe_with_policy(event_subscriber_t subscriber, EventType_t topic, const event_bus_policy_t *policy);
+
+/**
+ * @brief 取消订阅一个主题，队列中已有的该主题事件不会被清除
+ *
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 句柄或主题非法
+ */
+esp_err_t event_bus_unsubscribe(event_subscriber_t subscriber, EventType_t topic);
+
+/**
+ * @brief 发布一个事件到所有订阅了该主题的订阅者
+ *
+ * 事件按值拷贝到每个订阅者的队列。某个订阅者队列已满时只丢弃该订阅者的副本，
+ * 不影响其他订阅者，并计入其丢弃计数。没有订阅者时直接返回 ESP_OK。
+ * 被合并或限流的事件视为正常处理，不会导致返回失败。
+ * 事件带负载时，每个成功投递的订阅者各持有一个引用，发布者仍需释放自己的引用。
+ *
+ * @param event 要发布的事件，event_type 即主题
+ * @param wait  每个订阅者队列已满时的最长等待时间
+ *
+ * @return ESP_OK 全部投递成功, ESP_FAIL 至少一个订阅者丢弃了事件,
+ *         ESP_ERR_INVALID_ARG 参数非法, ESP_ERR_INVALID_STATE 总线未初始化
+ */
+esp_err_t event_bus_publish(const AppEvent_t *event, TickType_t wait);
+
+/**
+ * @brief 在中断中发布事件 (不等待)
+ *
+ * @param event                     要发布的事件
+ * @param pxHigherPriorityTaskWoken 同 xQueueSendFromISR，可为NULL
+ */
+esp_err_t event_bus_publish_from_isr(const AppEvent_t *event, BaseType_t *pxHigherPriorityTaskWoken);
+
+/**
+ * @brief 从订阅者队列中接收一个事件
+ *
+ * 收到的事件带负载时，处理完后需要调用 event_payload_release(event.payload)。
+ * 每次出队都会把 "发布 -> 出队" 的延迟写入事件追踪 (见 event_trace.h)。
+ *
+ * @return pdPASS 收到事件, pdFAIL 超时
+ */
+BaseType_t event_bus_receive(event_subscriber_t subscriber, AppEvent_t *out_event, TickType_t wait);
+
+/**
+ * @brief 获取订阅者的丢弃/合并/限流统计
+ */
+void event_bus_get_stats(event_subscriber_t subscriber, event_bus_stats_t *out_stats);
 
-// 4. 初始化函数声明
-void event_queue_init(void);
+#ifdef __cplusplus
+}
+#endif
 
-#endif // EVENT_MANAGER_H
\ No newline at end of file
+#endif // EVENT_MANAGER_H
@@ -0,0 +1,175 @@
+#include "event_payload.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+
+#define TAG "EVENT_PAYLOAD"
+
+// 块头紧挨着数据区，data 按4字节对齐
+struct event_payload {
+    struct event_payload *next_free;  // 仅在空闲链表中使用
+    volatile uint32_t     refcount;
+    uint16_t              len;
+    uint8_t               pool_index;
+    uint8_t               reserved;
+    uint32_t              data[];
+};
+
+typedef struct {
+    uint8_t         *storage;
+    uint16_t         block_size;   // 数据区容量
+    uint16_t         block_count;
+    uint16_t         in_use;
+    uint16_t         peak_in_use;
+    uint32_t         alloc_failed;
+    event_payload_t *free_list;
+} event_payload_pool_t;
+
+#define PRV_BLOCK_STRIDE(size) (sizeof(event_payload_t) + (size))
+
+static uint32_t s_small_storage[EVENT_PAYLOAD_SMALL_COUNT * PRV_BLOCK_STRIDE(EVENT_PAYLOAD_SMALL_SIZE) / sizeof(uint32_t)];
+static uint32_t s_medium_storage[EVENT_PAYLOAD_MEDIUM_COUNT * PRV_BLOCK_STRIDE(EVENT_PAYLOAD_MEDIUM_SIZE) / sizeof(uint32_t)];
+static uint32_t s_large_storage[EVENT_PAYLOAD_LARGE_COUNT * PRV_BLOCK_STRIDE(EVENT_PAYLOAD_LARGE_SIZE) / sizeof(uint32_t)];
+
+// 按块容量从小到大排列，分配时取第一个能满足的池
+static event_payload_pool_t s_pools[EVENT_PAYLOAD_POOL_COUNT] = {
+    { (uint8_t *)s_small_storage,  EVENT_PAYLOAD_SMALL_SIZE,  EVENT_PAYLOAD_SMALL_COUNT,  0, 0, 0, NULL },
+    { (uint8_t *)s_medium_storage, EVENT_PAYLOAD_MEDIUM_SIZE, EVENT_PAYLOAD_MEDIUM_COUNT, 0, 0, 0, NULL },
+    { (uint8_t *)s_large_storage,  EVENT_PAYLOAD_LARGE_SIZE,  EVENT_PAYLOAD_LARGE_COUNT,  0, 0, 0, NULL },
+};
+
+static bool s_pools_ready = false;
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 首次分配时把所有块串成空闲链表，调用方需持有 s_pool_lock
+static void prv_pools_init_locked(void)
+{
+    for (int p = 0; p < EVENT_PAYLOAD_POOL_COUNT; p++) {
+        event_payload_pool_t *pool = &s_pools[p];
+        size_t stride = PRV_BLOCK_STRIDE(pool->block_size);
+        pool->free_list = NULL;
+        for (int i = pool->block_count - 1; i >= 0; i--) {
+            event_payload_t *block = (event_payload_t *)(pool->storage + i * stride);
+            block->pool_index = (uint8_t)p;
+            block->next_free = pool->free_list;
+            pool->free_list = block;
+        }
+    }
+    s_pools_ready = true;
+}
+
+event_payload_t *IRAM_ATTR event_payload_alloc(size_t size)
+{
+    if (size == 0 || size > EVENT_PAYLOAD_MAX_SIZE) {
+        return NULL;
+    }
+
+    event_payload_t *block = NULL;
+    portENTER_CRITICAL_SAFE(&s_pool_lock);
+    if (!s_pools_ready) {
+        prv_pools_init_locked();
+    }
+    for (int p = 0; p < EVENT_PAYLOAD_POOL_COUNT; p++) {
+        event_payload_pool_t *pool = &s_pools[p];
+        if (size > pool->block_size) {
+            continue;
+        }
+        block = pool->free_list;
+        if (block == NULL) {
+            // 本级耗尽时不借用更大的块，保证大块留给确实需要的负载
+            pool->alloc_failed++;
+            break;
+        }
+        pool->free_list = block->next_free;
+        if (++pool->in_use > pool->peak_in_use) {
+            pool->peak_in_use = pool->in_use;
+        }
+        break;
+    }
+    portEXIT_CRITICAL_SAFE(&s_pool_lock);
+
+    if (block) {
+        block->next_free = NULL;
+        block->refcount = 1;
+        block->len = (uint16_t)size;
+    }
+    return block;
+}
+
+event_payload_t *event_payload_from(const void *data, size_t len)
+{
+    event_payload_t *payload = event_payload_alloc(len);
+    if (payload == NULL) {
+        ESP_LOGW(TAG, "负载分配失败 (len=%u)", (unsigned)len);
+        return NULL;
+    }
+    memcpy(payload->data, data, len);
+    return payload;
+}
+
+event_payload_t *event_payload_from_str(const char *str)
+{
+    return event_payload_from(str, strlen(str) + 1);
+}
+
+event_payload_t *IRAM_ATTR event_payload_ref(event_payload_t *payload)
+{
+    if (payload) {
+        __atomic_add_fetch(&payload->refcount, 1, __ATOMIC_RELAXED);
+    }
+    return payload;
+}
+
+void IRAM_ATTR event_payload_release(event_payload_t *payload)
+{
+    if (payload == NULL) {
+        return;
+    }
+    if (__atomic_sub_fetch(&payload->refcount, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    event_payload_pool_t *pool = &s_pools[payload->pool_index];
+    portENTER_CRITICAL_SAFE(&s_pool_lock);
+    payload->next_free = pool->free_list;
+    pool->free_list = payload;
+    pool->in_use--;
+    portEXIT_CRITICAL_SAFE(&s_pool_lock);
+}
+
+void *event_payload_data(const event_payload_t *payload)
+{
+    return payload ? (void *)payload->data : NULL;
+}
+
+size_t event_payload_len(const event_payload_t *payload)
+{
+    return payload ? payload->len : 0;
+}
+
+void event_payload_set_len(event_payload_t *payload, size_t len)
+{
+    if (payload && len <= s_pools[payload->pool_index].block_size) {
+        payload->len = (uint16_t)len;
+    }
+}
+
+size_t event_payload_capacity(const event_payload_t *payload)
+{
+    return payload ? s_pools[payload->pool_index].block_size : 0;
+}
+
+void event_payload_get_stats(int pool_index, event_payload_pool_stats_t *out_stats)
+{
+    if (pool_index < 0 || pool_index >= EVENT_PAYLOAD_POOL_COUNT || out_stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL_SAFE(&s_pool_lock);
+    out_stats->block_size = s_pools[pool_index].block_size;
+    out_stats->block_count = s_pools[pool_index].block_count;
+    out_stats->in_use = s_pools[pool_index].in_use;
+    out_stats->peak_in_use = s_pools[pool_index].peak_in_use;
+    out_stats->alloc_failed = s_pools[pool_index].alloc_failed;
+    portEXIT_CRITICAL_SAFE(&s_pool_lock);
+}
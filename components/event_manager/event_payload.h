@@ -0,0 +1,111 @@
+#ifndef EVENT_PAYLOAD_H
+#define EVENT_PAYLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 带引用计数的事件负载，数据存放在固定大小的静态内存块池中，分配/释放不使用堆。
+ *
+ * 所有权规则:
+ *  - event_payload_alloc() 返回的负载引用计数为1，归调用者所有。
+ *  - 队列 (事件总线、4G任务队列) 在入队成功时各自增加一个引用，
+ *    因此发送方在发送后 (无论成功与否) 都要释放自己持有的引用。
+ *  - 接收方处理完事件后必须调用 event_payload_release()。
+ *  - 引用计数归零时内存块自动归还到池中。
+ *  - 多个持有者共享同一负载时，数据应视为只读。
+ */
+
+// 内存块池规格: 每一级的块容量和块数量
+#define EVENT_PAYLOAD_SMALL_SIZE    (64)
+#define EVENT_PAYLOAD_SMALL_COUNT   (16)
+#define EVENT_PAYLOAD_MEDIUM_SIZE   (256)
+#define EVENT_PAYLOAD_MEDIUM_COUNT  (8)
+#define EVENT_PAYLOAD_LARGE_SIZE    (1024)
+#define EVENT_PAYLOAD_LARGE_COUNT   (4)
+
+// 单个负载的最大容量
+#define EVENT_PAYLOAD_MAX_SIZE      EVENT_PAYLOAD_LARGE_SIZE
+
+typedef struct event_payload event_payload_t;
+
+/**
+ * @brief 各级内存池的使用统计
+ */
+typedef struct {
+    uint16_t block_size;
+    uint16_t block_count;
+    uint16_t in_use;        // 当前已分配的块数
+    uint16_t peak_in_use;   // 历史最大分配块数
+    uint32_t alloc_failed;  // 因池耗尽导致的分配失败次数
+} event_payload_pool_stats_t;
+
+#define EVENT_PAYLOAD_POOL_COUNT (3)
+
+/**
+ * @brief 分配一个至少能容纳 size 字节的负载 (从能满足的最小一级池中分配)
+ *
+ * 可在任务和中断中调用。
+ *
+ * @param size 需要的字节数 (1 ~ EVENT_PAYLOAD_MAX_SIZE)
+ * @return 负载句柄，引用计数为1；池耗尽或 size 超限时返回NULL
+ */
+event_payload_t *event_payload_alloc(size_t size);
+
+/**
+ * @brief 分配负载并拷贝数据，负载长度即为 len
+ */
+event_payload_t *event_payload_from(const void *data, size_t len);
+
+/**
+ * @brief 分配负载并拷贝一个以'\0'结尾的字符串 (包含结束符)
+ */
+event_payload_t *event_payload_from_str(const char *str);
+
+/**
+ * @brief 增加一个引用
+ * @return 传入的 payload，便于链式使用；payload 为NULL时返回NULL
+ */
+event_payload_t *event_payload_ref(event_payload_t *payload);
+
+/**
+ * @brief 释放一个引用，引用计数归零时归还内存块。payload 为NULL时什么也不做。
+ */
+void event_payload_release(event_payload_t *payload);
+
+/**
+ * @brief 获取负载数据区指针
+ */
+void *event_payload_data(const event_payload_t *payload);
+
+/**
+ * @brief 获取负载的有效数据长度
+ */
+size_t event_payload_len(const event_payload_t *payload);
+
+/**
+ * @brief 设置负载的有效数据长度 (不能超过容量)，用于先分配后填充的场景
+ */
+void event_payload_set_len(event_payload_t *payload, size_t len);
+
+/**
+ * @brief 获取负载内存块的容量
+ */
+size_t event_payload_capacity(const event_payload_t *payload);
+
+/**
+ * @brief 获取指定一级内存池的统计信息
+ *
+ * @param pool_index 0 ~ EVENT_PAYLOAD_POOL_COUNT-1，从小到大
+ */
+void event_payload_get_stats(int pool_index, event_payload_pool_stats_t *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENT_PAYLOAD_H
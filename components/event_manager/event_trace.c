@@ -0,0 +1,166 @@
+#include "event_trace.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#if defined(ESP_PLATFORM) && !defined(CONFIG_IDF_TARGET_LINUX)
+#include "esp_timer.h"
+#else
+#include <time.h>
+#endif
+
+#define TAG "EVENT_TRACE"
+
+_Static_assert((EVENT_TRACE_RING_SIZE & (EVENT_TRACE_RING_SIZE - 1)) == 0, "环形缓冲区容量必须是2的幂");
+
+// 每个槽位带序号 (写入时先清零，写完再置为 写入序号+1)，
+// 读取时前后两次序号一致且非零才认为记录完整，写入方从不等待
+typedef struct {
+    volatile uint32_t seq;
+    uint32_t          meta;       // event_type | producer << 8 | subscriber << 16
+    uint32_t          latency_us;
+} trace_slot_t;
+
+static trace_slot_t s_trace_ring[EVENT_TRACE_RING_SIZE];
+static uint32_t s_trace_head = 0;
+
+uint32_t event_trace_now_us(void)
+{
+#if defined(ESP_PLATFORM) && !defined(CONFIG_IDF_TARGET_LINUX)
+    return (uint32_t)esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL);
+#endif
+}
+
+void event_trace_record(uint8_t event_type, uint8_t producer, uint8_t subscriber, uint32_t latency_us)
+{
+#if EVENT_TRACE_ENABLED
+    uint32_t seq = __atomic_fetch_add(&s_trace_head, 1, __ATOMIC_RELAXED);
+    trace_slot_t *slot = &s_trace_ring[seq & (EVENT_TRACE_RING_SIZE - 1)];
+
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->meta = (uint32_t)event_type | ((uint32_t)producer << 8) | ((uint32_t)subscriber << 16);
+    slot->latency_us = latency_us;
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELEASE);
+#else
+    (void)event_type; (void)producer; (void)subscriber; (void)latency_us;
+#endif
+}
+
+// 读取一个槽位，记录不完整 (正在被写) 时返回 false
+static bool prv_read_slot(const trace_slot_t *slot, event_trace_record_t *out)
+{
+    uint32_t seq1 = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq1 == 0) {
+        return false;
+    }
+    uint32_t meta = slot->meta;
+    uint32_t latency = slot->latency_us;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq1) {
+        return false;
+    }
+    out->event_type = (uint8_t)(meta & 0xFF);
+    out->producer = (uint8_t)((meta >> 8) & 0xFF);
+    out->subscriber = (uint8_t)((meta >> 16) & 0xFF);
+    out->latency_us = latency;
+    return true;
+}
+
+static int prv_compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t prv_percentile(const uint32_t *sorted, uint32_t count, uint32_t percent)
+{
+    // 最近秩法: 第 ceil(p/100 * n) 个元素
+    uint32_t rank = (percent * count + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+int event_trace_get_summary(uint8_t event_type, event_trace_summary_t *out_summary)
+{
+    if (out_summary == NULL) {
+        return -1;
+    }
+    memset(out_summary, 0, sizeof(*out_summary));
+
+    uint32_t *latencies = malloc(EVENT_TRACE_RING_SIZE * sizeof(uint32_t));
+    if (latencies == NULL) {
+        return -1;
+    }
+
+    uint32_t count = 0;
+    for (int i = 0; i < EVENT_TRACE_RING_SIZE; i++) {
+        event_trace_record_t record;
+        if (prv_read_slot(&s_trace_ring[i], &record) && record.event_type == event_type) {
+            latencies[count++] = record.latency_us;
+        }
+    }
+
+    if (count > 0) {
+        qsort(latencies, count, sizeof(uint32_t), prv_compare_u32);
+        out_summary->count = count;
+        out_summary->p50_us = prv_percentile(latencies, count, 50);
+        out_summary->p90_us = prv_percentile(latencies, count, 90);
+        out_summary->p99_us = prv_percentile(latencies, count, 99);
+        out_summary->max_us = latencies[count - 1];
+    }
+    free(latencies);
+    return 0;
+}
+
+void event_trace_reset(void)
+{
+    for (int i = 0; i < EVENT_TRACE_RING_SIZE; i++) {
+        __atomic_store_n(&s_trace_ring[i].seq, 0, __ATOMIC_RELEASE);
+    }
+}
+
+void event_trace_dump(int with_records)
+{
+    // 先汇总出现过的事件类型
+    uint8_t seen[256 / 8] = {0};
+    for (int i = 0; i < EVENT_TRACE_RING_SIZE; i++) {
+        event_trace_record_t record;
+        if (prv_read_slot(&s_trace_ring[i], &record)) {
+            seen[record.event_type / 8] |= (uint8_t)(1 << (record.event_type % 8));
+        }
+    }
+
+    for (int type = 0; type < 256; type++) {
+        if (!(seen[type / 8] & (1 << (type % 8)))) {
+            continue;
+        }
+        event_trace_summary_t summary;
+        if (event_trace_get_summary((uint8_t)type, &summary) == 0 && summary.count > 0) {
+            ESP_LOGI(TAG, "EVT_TRACE_SUMMARY,%d,%lu,%lu,%lu,%lu,%lu", type,
+                     (unsigned long)summary.count, (unsigned long)summary.p50_us,
+                     (unsigned long)summary.p90_us, (unsigned long)summary.p99_us,
+                     (unsigned long)summary.max_us);
+        }
+    }
+
+    if (!with_records) {
+        return;
+    }
+    // 按写入顺序从最早的记录开始输出
+    uint32_t head = __atomic_load_n(&s_trace_head, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < EVENT_TRACE_RING_SIZE; i++) {
+        event_trace_record_t record;
+        const trace_slot_t *slot = &s_trace_ring[(head + i) & (EVENT_TRACE_RING_SIZE - 1)];
+        if (prv_read_slot(slot, &record)) {
+            ESP_LOGI(TAG, "EVT_TRACE,%u,%u,%u,%lu", record.event_type, record.producer,
+                     record.subscriber, (unsigned long)record.latency_us);
+        }
+    }
+}
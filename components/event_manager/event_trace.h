@@ -0,0 +1,84 @@
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 事件延迟追踪: 事件总线在发布时打时间戳，订阅者出队时计算
+ * "发布 -> 出队" 的延迟，写入一个无锁环形缓冲区。
+ * 写入只有一次原子自增和几次普通写，可在任务和中断中使用。
+ */
+
+// 设为0可在编译期关闭追踪
+#ifndef EVENT_TRACE_ENABLED
+#define EVENT_TRACE_ENABLED      (1)
+#endif
+
+// 环形缓冲区容量 (必须是2的幂)，写满后覆盖最早的记录
+#define EVENT_TRACE_RING_SIZE    (256)
+
+/**
+ * @brief 一条追踪记录
+ */
+typedef struct {
+    uint8_t  event_type;   // 事件类型 (EventType_t)
+    uint8_t  producer;     // 发布者 (EventProducer_t)
+    uint8_t  subscriber;   // 出队的订阅者ID
+    uint32_t latency_us;   // 发布到出队的延迟
+} event_trace_record_t;
+
+/**
+ * @brief 某个事件类型的延迟统计 (基于环形缓冲区中当前保留的记录)
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} event_trace_summary_t;
+
+/**
+ * @brief 获取追踪使用的时间戳 (微秒，32位回绕，仅用于计算差值)
+ *
+ * 设备上使用 esp_timer，主机构建使用单调时钟。
+ */
+uint32_t event_trace_now_us(void);
+
+/**
+ * @brief 写入一条追踪记录 (由事件总线在出队时调用)
+ */
+void event_trace_record(uint8_t event_type, uint8_t producer, uint8_t subscriber, uint32_t latency_us);
+
+/**
+ * @brief 计算某个事件类型的延迟分位数
+ *
+ * 内部会拷贝并排序环形缓冲区，不要在时间敏感的路径上调用。
+ *
+ * @return 0 成功, -1 参数非法
+ */
+int event_trace_get_summary(uint8_t event_type, event_trace_summary_t *out_summary);
+
+/**
+ * @brief 清空追踪记录
+ */
+void event_trace_reset(void);
+
+/**
+ * @brief 通过日志 (UART) 输出所有事件类型的延迟统计和原始记录
+ *
+ * 每行格式固定，便于脚本解析:
+ *   EVT_TRACE_SUMMARY,<类型>,<个数>,<p50>,<p90>,<p99>,<max>
+ *   EVT_TRACE,<类型>,<发布者>,<订阅者>,<延迟us>   (仅当 with_records 非0)
+ */
+void event_trace_dump(int with_records);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENT_TRACE_H
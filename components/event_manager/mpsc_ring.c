@@ -0,0 +1,106 @@
+#include "mpsc_ring.h"
+#include <string.h>
+#include "esp_attr.h"
+
+// 槽位序号的含义 (pos 为全局递增位置):
+//   seq == pos          槽位空闲，可被位置 pos 的生产者抢占
+//   seq == pos + 1      槽位已写完，可被位置 pos 的消费者读取
+//   seq == pos + cap    消费者读完后交还给下一圈的生产者
+
+static inline uint32_t *prv_cell_seq(const mpsc_ring_t *ring, uint32_t pos)
+{
+    return (uint32_t *)(ring->cells + (pos & ring->mask) * ring->stride);
+}
+
+static inline uint8_t *prv_cell_data(const mpsc_ring_t *ring, uint32_t pos)
+{
+    return ring->cells + (pos & ring->mask) * ring->stride + sizeof(uint32_t);
+}
+
+esp_err_t mpsc_ring_init(mpsc_ring_t *ring, void *storage, size_t storage_size, uint32_t capacity, uint32_t item_size)
+{
+    if (ring == NULL || storage == NULL || item_size == 0 ||
+        capacity < 2 || (capacity & (capacity - 1)) != 0 ||
+        ((uintptr_t)storage & 3u) != 0 ||
+        storage_size < MPSC_RING_STORAGE_SIZE(capacity, item_size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ring->cells = (uint8_t *)storage;
+    ring->mask = capacity - 1;
+    ring->item_size = item_size;
+    ring->stride = MPSC_RING_STRIDE(item_size);
+    ring->enqueue_pos = 0;
+    ring->dequeue_pos = 0;
+    ring->push_failed = 0;
+    for (uint32_t i = 0; i < capacity; i++) {
+        *prv_cell_seq(ring, i) = i;
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return ESP_OK;
+}
+
+bool IRAM_ATTR mpsc_ring_push(mpsc_ring_t *ring, const void *item)
+{
+    uint32_t pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+    uint32_t *seq_ptr;
+
+    for (;;) {
+        seq_ptr = prv_cell_seq(ring, pos);
+        uint32_t seq = __atomic_load_n(seq_ptr, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            // 槽位空闲，抢占成功后跳出；失败时 pos 被更新为最新值后重试
+            if (__atomic_compare_exchange_n(&ring->enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 消费者还没读走上一圈的数据，缓冲区已满
+            __atomic_add_fetch(&ring->push_failed, 1, __ATOMIC_RELAXED);
+            return false;
+        } else {
+            // 其他生产者已经抢走这个位置
+            pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(prv_cell_data(ring, pos), item, ring->item_size);
+    __atomic_store_n(seq_ptr, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool mpsc_ring_pop(mpsc_ring_t *ring, void *out_item)
+{
+    return mpsc_ring_pop_batch(ring, out_item, 1) == 1;
+}
+
+size_t mpsc_ring_pop_batch(mpsc_ring_t *ring, void *out_items, size_t max_items)
+{
+    uint8_t *out = (uint8_t *)out_items;
+    uint32_t pos = ring->dequeue_pos;
+    size_t count = 0;
+
+    while (count < max_items) {
+        uint32_t *seq_ptr = prv_cell_seq(ring, pos);
+        uint32_t seq = __atomic_load_n(seq_ptr, __ATOMIC_ACQUIRE);
+        if (seq != pos + 1) {
+            // 为空，或该槽位仍在被生产者写入
+            break;
+        }
+        memcpy(out + count * ring->item_size, prv_cell_data(ring, pos), ring->item_size);
+        // 交还槽位给下一圈的生产者
+        __atomic_store_n(seq_ptr, pos + ring->mask + 1, __ATOMIC_RELEASE);
+        pos++;
+        count++;
+    }
+
+    ring->dequeue_pos = pos;
+    return count;
+}
+
+uint32_t mpsc_ring_count_approx(const mpsc_ring_t *ring)
+{
+    uint32_t head = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+    return head - ring->dequeue_pos;
+}
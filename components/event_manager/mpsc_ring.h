@@ -0,0 +1,87 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 无锁多生产者单消费者环形缓冲区 (基于每个槽位序号的有界队列算法)。
+ *
+ * - 生产者只做一次 CAS 抢占槽位 + 一次数据拷贝，不进入内核临界区，可在任务和中断中调用
+ *   (在IRAM中断里使用时，存储区必须位于内部RAM)。
+ * - 只允许一个消费者任务调用 pop 系列函数。
+ * - 元素按值拷贝，大小在初始化时固定。
+ * - 某个生产者抢到槽位但尚未写完时 (例如被中断打断)，消费者会在该槽位处暂停，
+ *   直到写入完成，之后的元素不会被越过。
+ * - 缓冲区满时 push 立即失败并计数，不会等待。
+ */
+
+typedef struct {
+    uint8_t          *cells;          // 槽位数组: [序号(4字节) + 元素] * capacity
+    uint32_t          mask;           // capacity - 1
+    uint32_t          item_size;
+    uint32_t          stride;         // 每个槽位占用的字节数 (4字节对齐)
+    volatile uint32_t enqueue_pos;    // 生产者共享，CAS 推进
+    uint32_t          dequeue_pos;    // 仅消费者访问
+    volatile uint32_t push_failed;    // 因缓冲区满而失败的 push 次数
+} mpsc_ring_t;
+
+// 计算 capacity 个 item_size 大小元素所需的存储区字节数
+#define MPSC_RING_STRIDE(item_size)                 ((sizeof(uint32_t) + (item_size) + 3u) & ~3u)
+#define MPSC_RING_STORAGE_SIZE(capacity, item_size) ((capacity) * MPSC_RING_STRIDE(item_size))
+
+/**
+ * @brief 在调用方提供的存储区上初始化环形缓冲区
+ *
+ * @param ring         环形缓冲区对象
+ * @param storage      存储区，至少 MPSC_RING_STORAGE_SIZE(capacity, item_size) 字节，4字节对齐
+ * @param storage_size 存储区大小
+ * @param capacity     元素个数，必须是2的幂
+ * @param item_size    单个元素字节数
+ *
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数非法或存储区不足
+ */
+esp_err_t mpsc_ring_init(mpsc_ring_t *ring, void *storage, size_t storage_size, uint32_t capacity, uint32_t item_size);
+
+/**
+ * @brief 写入一个元素 (多生产者安全，可在中断中调用)
+ *
+ * @return true 成功, false 缓冲区已满
+ */
+bool mpsc_ring_push(mpsc_ring_t *ring, const void *item);
+
+/**
+ * @brief 取出一个元素 (仅消费者调用)
+ *
+ * @return true 取到元素, false 缓冲区为空
+ */
+bool mpsc_ring_pop(mpsc_ring_t *ring, void *out_item);
+
+/**
+ * @brief 批量取出元素 (仅消费者调用)
+ *
+ * 一次取出尽可能多的已完成元素，元素依次拷贝到 out_items 中。
+ *
+ * @param out_items 输出缓冲区，至少 max_items * item_size 字节
+ * @param max_items 最多取出的元素个数
+ *
+ * @return 实际取出的元素个数
+ */
+size_t mpsc_ring_pop_batch(mpsc_ring_t *ring, void *out_items, size_t max_items);
+
+/**
+ * @brief 估算当前缓冲区中的元素个数 (并发写入时只是近似值)
+ */
+uint32_t mpsc_ring_count_approx(const mpsc_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPSC_RING_H
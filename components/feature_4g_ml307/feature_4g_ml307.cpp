@@ -2,23 +2,51 @@
 #include "freertos/task.h" // For TaskHandle_t
 #include "freertos/queue.h"
 #include "esp_log.h"
+#include "nvs.h"
 #include <memory> // for std::unique_ptr
 #include <string> // for std::string
 
 #include "at_modem.h"
 #include "feature_4g_ml307.h"
 #include "bsp_uart_for_ml307.h"
+#include "event_manager.h"
+#include "boot_trace.h"
 
 #define TAG "FEATURE_4G"
 #define FEATURE_4G_TASK_STACK_SIZE (1024 * 8)
 #define FEATURE_4G_TASK_PRIORITY   (5)
 #define FEATURE_4G_QUEUE_LENGTH    (10)
 
+// --- 模组后台启动的时间参数 ---
+#define MODEM_DETECT_STEP_TIMEOUT_MS    (3000)  // 单次波特率探测的最长时间
+#define MODEM_REGISTER_STEP_TIMEOUT_MS  (5000)  // 单次等待注网的最长时间
+#define MODEM_REGISTER_TIMEOUT_MS       (60000) // 注网总超时，超过后上报错误并退避重试
+#define MODEM_RETRY_BACKOFF_MS          (5000)  // 失败后的重试间隔
+
+// 协商得到的波特率保存在 NVS 中，下次启动直接使用，跳过探测和协商
+#define MODEM_NVS_NAMESPACE             "modem"
+#define MODEM_NVS_KEY_BAUD              "baud"
+
+typedef enum {
+    MODEM_STATE_DETECTING,   // 探测波特率并识别模组型号
+    MODEM_STATE_REGISTERING, // 等待SIM卡就绪和网络注册
+    MODEM_STATE_READY,       // 网络已就绪，可以处理业务事件
+} modem_state_t;
+
 // --- 模块内部的静态全局变量 ---
 static QueueHandle_t s_feature_4g_queue = NULL;
 static TaskHandle_t s_feature_4g_task_handle = NULL;
+static std::shared_ptr<AtUart> s_at_uart = nullptr; // 跨检测重试复用，避免重复安装UART驱动
 static std::unique_ptr<AtModem> s_modem = nullptr; // 使用智能指针管理modem对象生命周期
 static bool s_is_initialized = false;             // 初始化成功标志
+static bsp_ml307_config_t s_modem_config;
+static volatile modem_state_t s_modem_state = MODEM_STATE_DETECTING;
+static volatile bool s_network_ready = false;
+static TickType_t s_state_entered_tick = 0;
+static TickType_t s_next_step_delay = 0;            // 距离下一次推进状态机的等待时间
+static int s_failed_attempts = 0;
+static bool s_boot_traced = false;                // 首次启动完成后不再记录启动阶段
+static int s_saved_baud_rate = 0;                 // NVS 中保存的波特率，0 表示没有
 
 
 static void prv_handle_websocket_connect(AtModem& modem, const char* url) {
@@ -59,33 +87,216 @@ static void prv_handle_websocket_connect(AtModem& modem, const char* url) {
     
 }
 
+// --- 模组启动状态机 ---
+// 4G任务在后台逐步推进这些状态，每一步都有上限时长，期间仍会处理队列中的事件，
+// 因此 app_main 不会再被模组检测或注网阻塞。
+static void prv_post_app_event(EventType_t event_type)
+{
+    AppEvent_t event_msg = {
+        .event_type = event_type,
+        .arg = 0,
+        .payload = NULL,
+        .producer = EVENT_PRODUCER_4G
+    };
+    if (event_bus_publish(&event_msg, 0) != ESP_OK) {
+        ESP_LOGW(TAG, "发布4G状态事件失败: %d", event_type);
+    }
+}
+
+static void prv_enter_state(modem_state_t state, TickType_t delay)
+{
+    s_modem_state = state;
+    s_state_entered_tick = xTaskGetTickCount();
+    s_next_step_delay = delay;
+}
+
+static int prv_load_baud_rate(void)
+{
+    nvs_handle_t handle;
+    int32_t baud_rate = 0;
+    if (nvs_open(MODEM_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        nvs_get_i32(handle, MODEM_NVS_KEY_BAUD, &baud_rate);
+        nvs_close(handle);
+    }
+    return baud_rate;
+}
+
+static void prv_save_baud_rate(int baud_rate)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(MODEM_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_i32(handle, MODEM_NVS_KEY_BAUD, baud_rate);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "保存波特率失败: %s", esp_err_to_name(err));
+        return;
+    }
+    s_saved_baud_rate = baud_rate;
+}
+
+// 已保存的波特率说明上次协商过且稳定，不再重复协商；没有保存或模组已不在该波特率时重新协商
+static void prv_negotiate_baud_rate(void)
+{
+    int baud_rate = s_at_uart->GetBaudRate();
+    if (baud_rate == s_saved_baud_rate) {
+        return;
+    }
+    if (baud_rate < s_modem_config.max_baud_rate) {
+        baud_rate = s_at_uart->NegotiateBaudRate(s_modem_config.max_baud_rate);
+    }
+    ESP_LOGI(TAG, "模组波特率: %d", baud_rate);
+    prv_save_baud_rate(baud_rate);
+}
+
+static void prv_step_detect(void)
+{
+    if (!s_at_uart) {
+        s_at_uart = std::make_shared<AtUart>(s_modem_config.uart_tx_pin, s_modem_config.uart_rx_pin, s_modem_config.pwrkey_pin,
+                                             s_modem_config.uart_rts_pin, s_modem_config.uart_cts_pin);
+        s_at_uart->Initialize(s_modem_config.uart_rx_buffer_size);
+        // 先在上次的波特率上探测，命中后 DetectBaudRate 会直接采用
+        s_saved_baud_rate = prv_load_baud_rate();
+        if (s_saved_baud_rate > 0) {
+            s_at_uart->ProbeBaudRate(s_saved_baud_rate);
+        }
+    }
+
+    // 目标波特率取已保存的值，避免检测时把模组切回出厂默认值
+    int baud_rate = s_saved_baud_rate > 0 ? s_saved_baud_rate : s_modem_config.baud_rate;
+    s_modem = AtModem::Detect(s_at_uart, baud_rate, MODEM_DETECT_STEP_TIMEOUT_MS);
+    if (!s_modem) {
+        if (++s_failed_attempts == 1) {
+            ESP_LOGE(TAG, "ML307模组检测失败，将在后台继续重试");
+            prv_post_app_event(EVENT_4G_NETWORK_ERROR);
+        }
+        prv_enter_state(MODEM_STATE_DETECTING, pdMS_TO_TICKS(MODEM_RETRY_BACKOFF_MS));
+        return;
+    }
+
+    s_modem->OnNetworkStateChanged([](bool ready) {
+        ESP_LOGI(TAG, "网络状态变化: %s", ready ? "已连接" : "已断开");
+        // 首次就绪由状态机上报，这里只负责运行期间的断线/恢复
+        if (s_modem_state == MODEM_STATE_READY) {
+            s_network_ready = ready;
+            prv_post_app_event(ready ? EVENT_4G_NETWORK_READY : EVENT_4G_NETWORK_LOST);
+        }
+    });
+
+    // 流控要在提速之前打开，协商校验时就在流控保护下进行
+    s_at_uart->EnableFlowControl();
+    prv_negotiate_baud_rate();
+
+    s_failed_attempts = 0;
+    if (!s_boot_traced) {
+        boot_trace_mark("modem_detected");
+    }
+    ESP_LOGI(TAG, "模组检测成功，开始注网...");
+    prv_enter_state(MODEM_STATE_REGISTERING, 0);
+}
+
+static void prv_step_register(void)
+{
+    NetworkStatus status = s_modem->WaitForNetworkReady(MODEM_REGISTER_STEP_TIMEOUT_MS);
+    if (status == NetworkStatus::Ready) {
+        ESP_LOGI(TAG, "网络已就绪! (耗时 %lu ms)", (unsigned long)pdTICKS_TO_MS(xTaskGetTickCount() - s_state_entered_tick));
+        // 版本在检测时已读到，IMEI/ICCID 有 NVS 缓存时不再查询模组
+        ESP_LOGI(TAG, "模组版本: %s", s_modem->GetModuleRevision().c_str());
+        ESP_LOGI(TAG, "IMEI: %s", s_modem->GetImei().c_str());
+        ESP_LOGI(TAG, "ICCID: %s", s_modem->GetIccid().c_str());
+        ESP_LOGI(TAG, "运营商: %s", s_modem->GetCarrierName().c_str());
+        ESP_LOGI(TAG, "信号强度: %d", s_modem->GetCsq());
+
+        s_failed_attempts = 0;
+        s_network_ready = true;
+        prv_enter_state(MODEM_STATE_READY, portMAX_DELAY);
+        prv_post_app_event(EVENT_4G_NETWORK_READY);
+
+        // 首次注网成功视为启动完成，补充记录后再输出一次启动耗时汇总
+        if (!s_boot_traced) {
+            s_boot_traced = true;
+            boot_trace_mark("modem_ready");
+            boot_trace_dump();
+        }
+        // 启动完成后再确认缓存的 ICCID，关机期间换过 SIM 卡时更新缓存
+        s_modem->VerifyCachedIdentity();
+        return;
+    }
+
+    if (status == NetworkStatus::ErrorTimeout &&
+        (xTaskGetTickCount() - s_state_entered_tick) < pdMS_TO_TICKS(MODEM_REGISTER_TIMEOUT_MS)) {
+        // 单步超时但总时长未到，继续等待注网
+        s_next_step_delay = 0;
+        return;
+    }
+
+    ESP_LOGE(TAG, "网络连接失败，状态码: %d，稍后重试", (int)status);
+    if (++s_failed_attempts == 1) {
+        prv_post_app_event(EVENT_4G_NETWORK_ERROR);
+    }
+    prv_enter_state(MODEM_STATE_REGISTERING, pdMS_TO_TICKS(MODEM_RETRY_BACKOFF_MS));
+}
+
 static void feature_4g_handler_task(void *pvParameters)
 {
-    ESP_LOGI(TAG, "4G事件处理任务已启动，进入主循环。");
+    ESP_LOGI(TAG, "4G事件处理任务已启动，开始后台初始化模组。");
     
     Feature4GEvent_t received_event;
     
-    // 任务现在直接进入主循环，等待事件
     while(1) {
-        if (xQueueReceive(s_feature_4g_queue, &received_event, portMAX_DELAY) == pdPASS) {
-            
-            // 确保s_modem是有效的
-            if (!s_modem) {
-                ESP_LOGE(TAG, "严重错误: Modem对象为空，无法处理事件！");
-                continue;
-            }
-
-            switch (received_event.event_type) {
-                case EVENT_4G_WEBSOCKET_CONNECT:
-                    // 使用静态的modem对象
-                    prv_handle_websocket_connect(*s_modem, received_event.data.ws_connect.url);
+        // 1. 推进模组启动状态机 (就绪后不再有步骤)
+        if (s_next_step_delay == 0) {
+            switch (s_modem_state) {
+                case MODEM_STATE_DETECTING:
+                    prv_step_detect();
                     break;
-                
-                default:
-                    ESP_LOGW(TAG, "收到未知的4G事件类型: %d", received_event.event_type);
+                case MODEM_STATE_REGISTERING:
+                    prv_step_register();
+                    break;
+                case MODEM_STATE_READY:
+                    s_next_step_delay = portMAX_DELAY;
                     break;
             }
         }
+
+        // 2. 等待事件，超时时间即下一步状态机的退避时间
+        TickType_t wait_ticks = s_next_step_delay;
+        if (xQueueReceive(s_feature_4g_queue, &received_event, wait_ticks) != pdPASS) {
+            s_next_step_delay = 0;
+            continue;
+        }
+        if (s_next_step_delay != portMAX_DELAY) {
+            // 被事件提前唤醒，下一轮直接推进状态机，不再等待剩余的退避时间
+            s_next_step_delay = 0;
+        }
+
+        // 确保modem已就绪
+        if (s_modem_state != MODEM_STATE_READY || !s_modem) {
+            ESP_LOGW(TAG, "4G模组尚未就绪，丢弃事件: %d", received_event.event_type);
+            event_payload_release(received_event.payload);
+            continue;
+        }
+
+        switch (received_event.event_type) {
+            case EVENT_4G_WEBSOCKET_CONNECT:
+                if (received_event.payload == NULL) {
+                    ESP_LOGW(TAG, "WebSocket连接事件缺少URL");
+                    break;
+                }
+                // 使用静态的modem对象
+                prv_handle_websocket_connect(*s_modem, (const char*)event_payload_data(received_event.payload));
+                break;
+            
+            default:
+                ESP_LOGW(TAG, "收到未知的4G事件类型: %d", received_event.event_type);
+                break;
+        }
+        // 队列持有的负载引用在事件处理完后释放
+        event_payload_release(received_event.payload);
     }
 }
 
@@ -93,7 +304,7 @@ static void feature_4g_handler_task(void *pvParameters)
 // --- 公共API函数实现 (C风格接口) ---
 
 /**
- * @brief [新增] 初始化函数
+ * @brief 初始化函数 (非阻塞)
  */
 extern "C" BaseType_t feature_4g_init(void)
 {
@@ -111,54 +322,15 @@ extern "C" BaseType_t feature_4g_init(void)
         return pdFAIL;
     }
 
-    // 2. 获取BSP硬件配置
-    bsp_ml307_config_t modem_config;
-    bsp_ml307_get_config(&modem_config);
-
-    
+    // 2. 获取BSP硬件配置，模组检测和注网留给4G任务在后台完成
+    bsp_ml307_get_config(&s_modem_config);
     ESP_LOGI(TAG, "使用BSP配置: RX=%d, TX=%d, PWRKEY=%d, BAUD=%d",
-             modem_config.uart_rx_pin, modem_config.uart_tx_pin,
-             modem_config.pwrkey_pin, modem_config.baud_rate);
-
-    // 3. 自动检测并初始化模组
-    s_modem = AtModem::Detect(modem_config.uart_rx_pin, 
-                              modem_config.uart_tx_pin, 
-                              modem_config.pwrkey_pin, 
-                              modem_config.baud_rate);
-    
-    if (!s_modem) {
-        ESP_LOGE(TAG, "ML307模组检测失败!");
-        vQueueDelete(s_feature_4g_queue);
-        s_feature_4g_queue = NULL;
-        return pdFAIL;
-    }
-
-    // 4. 设置网络状态回调
-    s_modem->OnNetworkStateChanged([](bool ready) {
-        ESP_LOGI(TAG, "网络状态变化: %s", ready ? "已连接" : "已断开");
-    });
-    
-    // 5. 阻塞等待网络就绪
-    ESP_LOGI(TAG, "等待网络就绪 (最长60秒)...");
-    NetworkStatus status = s_modem->WaitForNetworkReady(60000);
-    if (status != NetworkStatus::Ready) {
-        ESP_LOGE(TAG, "网络连接失败，状态码: %d", (int)status);
-        s_modem.reset(); // 释放modem对象
-        vQueueDelete(s_feature_4g_queue);
-        s_feature_4g_queue = NULL;
-        return pdFAIL;
-    }
-    
-    // 6. 打印模组信息
-    ESP_LOGI(TAG, "网络已就绪!");
-    ESP_LOGI(TAG, "模组版本: %s", s_modem->GetModuleRevision().c_str());
-    ESP_LOGI(TAG, "IMEI: %s", s_modem->GetImei().c_str());
-    ESP_LOGI(TAG, "ICCID: %s", s_modem->GetIccid().c_str());
-    ESP_LOGI(TAG, "运营商: %s", s_modem->GetCarrierName().c_str());
-    ESP_LOGI(TAG, "信号强度: %d", s_modem->GetCsq());
+             s_modem_config.uart_rx_pin, s_modem_config.uart_tx_pin,
+             s_modem_config.pwrkey_pin, s_modem_config.baud_rate);
 
+    prv_enter_state(MODEM_STATE_DETECTING, 0);
     s_is_initialized = true;
-    ESP_LOGI(TAG, "4G模块初始化成功，已准备好启动任务。");
+    ESP_LOGI(TAG, "4G模块初始化完成，模组将在4G任务中后台启动。");
 
     return pdPASS;
 }
@@ -197,6 +369,11 @@ extern "C" BaseType_t feature_4g_task_start(void)
     return status;
 }
 
+extern "C" bool feature_4g_is_network_ready(void)
+{
+    return s_modem_state == MODEM_STATE_READY && s_network_ready;
+}
+
 /**
  * @brief [改造] 事件发送函数 (增加检查)
  */
@@ -211,7 +388,9 @@ extern "C" BaseType_t feature_4g_send_event(const Feature4GEvent_t* event)
         ESP_LOGW(TAG, "警告：正在向一个尚未启动的任务发送事件！请先调用 feature_4g_task_start()。");
     }
 
+    event_payload_ref(event->payload);
     if (xQueueSend(s_feature_4g_queue, event, 0) != pdPASS) {
+        event_payload_release(event->payload);
         ESP_LOGW(TAG, "发送到4G队列失败，可能队列已满。");
         return pdFAIL;
     }
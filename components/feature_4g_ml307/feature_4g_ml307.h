@@ -5,6 +5,8 @@
 #include "freertos/queue.h"
 #include <stddef.h> // For size_t
 #include <stdint.h> // For uint8_t
+#include <stdbool.h>
+#include "event_payload.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,19 +21,19 @@ typedef enum {
     // --- 新增的WebSocket专属事件 ---
     /**
      * @brief 请求连接到WebSocket服务器.
-     * 需要在 data.ws_connect.url 中提供服务器地址.
+     * payload 为以'\0'结尾的服务器地址 (见 event_payload_from_str).
      */
     EVENT_4G_WEBSOCKET_CONNECT,
 
     /**
      * @brief 发送文本消息.
-     * 需要在 data.ws_send_text.text 中提供字符串.
+     * payload 为以'\0'结尾的字符串.
      */
     EVENT_4G_WEBSOCKET_SEND_TEXT,
 
     /**
      * @brief 发送二进制数据 (例如音频流).
-     * 需要在 data.ws_send_binary 中提供数据指针和长度.
+     * payload 为数据本身，长度为 event_payload_len().
      */
     EVENT_4G_WEBSOCKET_SEND_BINARY,
 
@@ -43,44 +45,24 @@ typedef enum {
 } Feature4GEventType_t;
 
 // 定义事件消息结构体
-// 使用union为不同事件传递不同数据
+// 事件数据通过引用计数负载传递，队列中只拷贝两个字，负载的生命周期由引用计数管理
 typedef struct {
     Feature4GEventType_t event_type;
-    union {
-        // WebSocket连接事件的数据
-        struct {
-            char url[128];
-        } ws_connect;
-        
-        // WebSocket发送文本事件的数据
-        struct {
-            char text[256]; // 根据您的最大文本长度调整
-        } ws_send_text;
-
-        // WebSocket发送二进制事件的数据 (适用于音频流)
-        // 注意：为避免栈拷贝大量数据，这里使用指针。
-        // 调用者必须保证在4G任务处理完该事件前，该指针指向的内存是有效的！
-        struct {
-            const uint8_t* buffer;
-            size_t length;
-        } ws_send_binary;
-
-        // 未来可以为其他事件添加数据结构
-    } data;
+    event_payload_t*     payload;   // 可选，不需要数据的事件为NULL
 } Feature4GEvent_t;
 
 /**
  * @brief 初始化4G模块。
  * @details
- * 这是一个阻塞函数，应该在系统启动早期调用。
- * 它会完成以下工作：
+ * 这是一个非阻塞函数，只做以下工作：
  * 1. 创建内部消息队列。
  * 2. 从BSP获取硬件配置。
- * 3. 检测并初始化ML307模组。
- * 4. 阻塞等待，直到模组注网成功。
- * 只有当此函数返回 pdPASS 时，才能保证4G模块已准备就绪。
+ * 模组的检测、注网由 feature_4g_task_start() 创建的任务在后台完成，
+ * 结果通过 event_manager 上报 EVENT_4G_NETWORK_READY / EVENT_4G_NETWORK_ERROR，
+ * 运行期间断网/恢复上报 EVENT_4G_NETWORK_LOST / EVENT_4G_NETWORK_READY。
+ * 调用前需要先执行 event_bus_init()。
  *
- * @return pdPASS 表示初始化和网络连接成功，pdFAIL 表示失败。
+ * @return pdPASS 表示初始化成功，pdFAIL 表示失败。
  */
 BaseType_t feature_4g_init(void);
 
@@ -88,16 +70,25 @@ BaseType_t feature_4g_init(void);
  * @brief 启动4G模块的核心事件处理任务。
  * @details
  * 必须在 feature_4g_init() 成功之后调用。
- * 此函数会创建一个后台任务，该任务会持续等待并处理通过 feature_4g_send_event() 发送的事件。
+ * 此函数会创建一个后台任务，该任务先检测模组并等待注网，之后持续处理通过 feature_4g_send_event() 发送的事件。
+ * 模组就绪前收到的事件会被丢弃。
  *
  * @return pdPASS 表示任务创建成功，pdFAIL 表示失败。
  */
 BaseType_t feature_4g_task_start(void);
 
+/**
+ * @brief 查询4G网络当前是否就绪。
+ *
+ * @return true 模组已注网且网络可用。
+ */
+bool feature_4g_is_network_ready(void);
+
 /**
  * @brief 发送一个事件到4G模块的任务队列。
  * @details
  * 这是一个非阻塞函数，可以安全地在任何任务（包括中断服务程序，如果使用FromISR版本）中调用。
+ * 入队成功时队列会持有负载的一个引用，调用者无论发送成功与否都需要释放自己的引用。
  *
  * @param event 指向要发送的事件结构体的指针。
  * @return pdPASS 表示事件成功入队，pdFAIL 表示队列已满或未初始化。
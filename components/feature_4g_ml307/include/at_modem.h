@@ -12,15 +12,19 @@
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include <freertos/event_groups.h>
-#include <driver/gpio.h>
-#include <driver/uart.h>
 #include "at_uart.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include <driver/gpio.h>
+#endif
 #include "network_interface.h"
 
 #define AT_EVENT_PIN_ERROR      BIT2
 #define AT_EVENT_NETWORK_ERROR  BIT3
 #define AT_EVENT_NETWORK_READY  BIT4
 
+// 模组身份信息 (IMEI、ICCID) 的 NVS 缓存，与模组固件版本一起保存，版本不变时启动不再查询
+#define AT_MODEM_NVS_NAMESPACE  "modem_id"
+
 enum class NetworkStatus {
     ErrorInsertPin = -1,
     ErrorRegistrationDenied = -2,
@@ -49,7 +53,11 @@ struct CeregState {
 class AtModem : public NetworkInterface {
 public:
     // 静态检测方法
+#if !CONFIG_IDF_TARGET_LINUX
     static std::unique_ptr<AtModem> Detect(gpio_num_t tx_pin, gpio_num_t rx_pin, gpio_num_t dtr_pin = GPIO_NUM_NC, int baud_rate = 115200);
+#endif
+    // 在已初始化的 AtUart 上检测，timeout_ms < 0 时一直等待模组应答，超时返回 nullptr 且 uart 可再次用于重试
+    static std::unique_ptr<AtModem> Detect(std::shared_ptr<AtUart> uart, int baud_rate, int timeout_ms);
     
     // 构造函数和析构函数
     AtModem(std::shared_ptr<AtUart> at_uart);
@@ -64,12 +72,17 @@ public:
     virtual void SetFlightMode(bool enable);
 
     // 模组信息获取
+    // IMEI、ICCID 优先使用 NVS 缓存；运营商在注网状态变化后才重新查询；订阅了上报的模组直接返回上报的信号强度
     std::string GetImei();
     std::string GetIccid();
     std::string GetModuleRevision();
     CeregState GetRegistrationState();
     std::string GetCarrierName();
     int GetCsq();
+    // 重新向模组读取 ICCID，与缓存不同 (换卡) 时更新缓存
+    std::string RefreshIccid();
+    // ICCID 取自缓存且本次上电尚未确认时读取一次，发现关机期间更换的 SIM 卡。应在启动完成后调用
+    void VerifyCachedIdentity();
 
     // 状态查询
     bool pin_ready() const { return pin_ready_; }
@@ -83,15 +96,24 @@ protected:
     std::string carrier_name_;
     std::string module_revision_;
     int csq_ = -1;
+    bool csq_reporting_ = false;    // 模组主动上报信号强度，GetCsq 不再轮询
+    bool carrier_stale_ = false;    // 注网状态变化过，运营商需要重新查询
+    bool sim_changed_ = false;      // SIM 卡状态变化过，ICCID 需要重新查询
+    bool iccid_unverified_ = false; // ICCID 取自缓存，本次上电尚未向模组确认
     bool pin_ready_ = true;
     bool network_ready_ = false;
 
-    gpio_num_t dtr_pin_;
     EventGroupHandle_t event_group_handle_ = nullptr;
 
     CeregState cereg_state_;
 
-    virtual void HandleUrc(const std::string& command, const std::vector<AtArgumentValue>& arguments);
+    virtual void HandleUrc(std::string_view command, const AtArguments& arguments);
+    // 子类追加主动上报的订阅命令，WaitForNetworkReady 中下发，成功后由 URC 刷新状态
+    virtual void AppendReportConfig(std::vector<AtConfigItem>& config) {}
+
+    // 按当前固件版本 (module_revision_) 校验并载入身份缓存
+    bool LoadIdentity();
+    void SaveIdentity();
 
     std::function<void(bool network_state)> on_network_state_changed_;
 };
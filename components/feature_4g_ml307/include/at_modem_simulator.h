@@ -0,0 +1,184 @@
+#ifndef _AT_MODEM_SIMULATOR_H_
+#define _AT_MODEM_SIMULATOR_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include "at_transport.h"
+
+// 模拟器参数
+struct AtModemSimulatorConfig {
+    // AT+CGMR 的应答，AtModem::Detect 据此选择驱动，以 "EC801E" 开头即按 EC801E 使用
+    std::string revision = "ML307R-DC_V1.0.0";
+    std::string imei = "866000000000003";
+    std::string iccid = "89860000000000000001";
+    std::string carrier = "CHINA MOBILE";
+    int csq = 24;
+
+    uint32_t response_delay_ms = 0;     // 模组处理 AT 命令的时间
+    uint32_t uart_baud_rate = 0;        // 按此波特率 (10 位/字节) 限制模组发往主机的字节，0 不限
+    uint32_t network_latency_ms = 0;    // 网络单程时延，建连按一个往返计
+    uint32_t network_bandwidth_bps = 0; // 上下行各自的网络带宽 (bit/s)，0 不限
+};
+
+// 主机 (linux 目标) 上的模组模拟器，作为 AtTransport 接到 AtUart 上，不需要硬件。
+// 实现驱动实际用到的 AT 命令子集，模组内的 TCP/UDP/MQTT/HTTP 连接映射为本机真实的 socket:
+//   通用: AT, ATE0, CGMR, CGSN, ICCID, CPIN, CEREG, CSQ, COPS, CFUN, IPR, IFC
+//   ML307: MIPCALL, MIPCFG, MIPSTATE, MIPOPEN, MIPSEND, MIPCLOSE, MQTT*, MHTTP*
+//   EC801E: QINDCFG, QICFG, QISTATE, QIOPEN, QISEND, QICLOSE, QMT*
+// 不支持 SSL，打开 SSL 的连接会报错。配置类命令只记录驱动依赖的部分，其余直接回 OK
+class AtModemSimulator : public AtTransport {
+public:
+    explicit AtModemSimulator(const AtModemSimulatorConfig& config = AtModemSimulatorConfig());
+    ~AtModemSimulator();
+
+    bool Open(int baud_rate, size_t rx_buffer_size, size_t tx_buffer_size, AtTransportEventCallback callback) override;
+    size_t Available() override;
+    int Read(char* buffer, size_t length) override;
+    int Write(const char* data, size_t length) override;
+    void SetBaudRate(int baud_rate) override {}
+
+    // 模拟 UART 硬件 FIFO 溢出: 之后发往主机的 length 字节被丢弃，并在这之后的数据之前通知 FifoOverflow
+    void DropRxBytes(size_t length);
+    // 修改之后命令的处理时间，用来让命令在 AtUart 一侧超时而应答迟到
+    void SetResponseDelay(uint32_t delay_ms);
+    // 发出一行 URC，如模组重启后的 "RDY"。只有 URC，模拟器内的连接和状态不变
+    void InjectUrc(const std::string& line);
+    // 已执行的某条命令 (不含 "AT+" 前缀) 的次数，用来检查驱动是否跳过了缓存的配置
+    int command_count(const std::string& name);
+
+    // 经模拟网络收发的载荷字节数
+    size_t uplink_bytes() const { return uplink_bytes_; }
+    size_t downlink_bytes() const { return downlink_bytes_; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    enum class LinkType { Mip, Qi, Mqtt, Qmt, Http };
+
+    // 模组内的一个连接，对应本机的一个 socket
+    struct Link {
+        LinkType type = LinkType::Mip;
+        int id = 0;
+        uint32_t serial = 0;        // 区分先后占用同一 id 的连接，延迟执行的动作据此确认连接仍在
+        int fd = -1;
+        bool udp = false;
+        bool connecting = false;
+        bool connected = false;
+        bool ssl = false;
+        std::string host;
+        int port = 0;
+        std::string tx_pending;     // socket 暂时写不下的数据
+        std::string rx;             // 尚未解析的流 (MQTT 报文、HTTP 应答)
+        std::function<void(Link& link, bool success)> on_connect;
+        std::function<void(Link& link, std::string data)> on_data;
+        std::function<void(Link& link)> on_close;
+
+        // MIP / QI
+        bool raw = false;           // MIPCFG "encoding" 为原始数据，否则按十六进制上报
+
+        // MQTT / QMT
+        bool clean_session = true;
+        int keep_alive = 120;
+        std::string client_id, username, password;
+        uint16_t next_packet_id = 1;
+        Clock::time_point last_tx;
+
+        // HTTP
+        bool send_hex = false;      // MHTTPCFG "encoding" 的发送方向
+        bool chunked = false;
+        bool requested = false;
+        bool body_complete = true;
+        std::string method, path, headers, body;
+        bool header_received = false;
+        long content_length = -1;
+        size_t received = 0;
+    };
+
+    AtModemSimulatorConfig config_;
+    AtTransportEventCallback callback_;
+    std::mutex mutex_;
+    std::thread thread_;
+    int wake_pipe_[2] = {-1, -1};
+    bool stopping_ = false;
+    bool notify_ = false;
+
+    // 发往 AtUart 的数据
+    std::string rx_pending_;
+    size_t rx_offset_ = 0;
+    size_t rx_drop_ = 0;            // DropRxBytes 尚未丢弃的字节数
+    bool overflow_ = false;         // 有字节被丢弃，尚未通知
+    // 来自 AtUart 的数据
+    std::string input_;
+    size_t data_expected_ = 0;      // '>' 之后等待的数据长度
+    bool skip_lf_ = false;          // 上一行以 \r 结束，丢弃紧随的 \n
+    std::function<int(const std::string& data, std::string& reply)> data_handler_;
+
+    // 定时动作，同一时刻按加入顺序执行
+    std::multimap<Clock::time_point, std::function<void()>> timers_;
+    Clock::time_point uart_free_;
+    Clock::time_point uplink_free_;
+    Clock::time_point downlink_free_;
+    size_t uplink_bytes_ = 0;
+    size_t downlink_bytes_ = 0;
+
+    int cereg_mode_ = 0;
+    uint32_t next_serial_ = 1;
+    std::map<int, Link> sockets_;   // MIP 与 QI 共用连接号
+    std::map<int, Link> mqtt_;
+    std::map<int, Link> http_;
+    std::map<int, bool> mip_raw_;   // MIPCFG 在 MIPOPEN 之前设置，按连接号暂存
+    std::map<std::string, int> command_counts_;
+
+    void Run();
+    void Wake();
+    void RunTimers();
+    void KeepAlive();
+    Link* FindLink(int fd);
+    Link* FindLinkBySerial(uint32_t serial);
+    void HandleLinkEvent(Link& link, short revents);
+
+    // 命令处理
+    bool ProcessInput();
+    void ExecuteLine(const std::string& line);
+    int Execute(const std::string& command, std::string& reply);
+    int ExecuteBasic(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply);
+    int ExecuteMip(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply);
+    int ExecuteQi(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply);
+    int ExecuteMqtt(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply);
+    int ExecuteQmt(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply);
+    int ExecuteHttp(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply);
+    int ExpectData(size_t length, std::function<int(const std::string& data, std::string& reply)> handler);
+    void FinishReply(std::string& reply, int result);
+
+    // 输出与时序
+    void Emit(std::string bytes, bool response = false);
+    void EmitUrc(const std::string& line);
+    void After(uint32_t delay_ms, std::function<void()> action);
+    void Downlink(size_t length, std::function<void()> action);
+    void Uplink(Link& link, std::string data);
+
+    // 连接
+    bool OpenLink(Link& link);
+    void CloseLink(Link& link);
+    void Transmit(Link& link, const std::string& data);
+    void FlushLink(Link& link);
+    void OpenSocket(Link& link);
+    void ReleaseSocket(Link& link);
+    void OpenMqtt(Link& link);
+    void MqttConnect(Link& link);
+    void HandleMqttPacket(Link& link, uint8_t type, const std::string& body);
+    void MqttUrcConnect(Link& link, int code);
+    void MqttUrcClosed(Link& link);
+    void MqttPublish(Link& link, const std::string& topic, int qos, const std::string& payload);
+    void StartHttpRequest(Link& link);
+    void HandleHttpData(Link& link, const std::string& data);
+    void EmitHttpContent(Link& link, const std::string& data);
+};
+
+#endif // _AT_MODEM_SIMULATOR_H_
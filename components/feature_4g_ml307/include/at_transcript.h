@@ -0,0 +1,106 @@
+#ifndef _AT_TRANSCRIPT_H_
+#define _AT_TRANSCRIPT_H_
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include "at_transport.h"
+
+// 收发记录的二进制格式:
+//   文件头 "ATR" + 1 字节版本号
+//   每条记录: varint 距上一条记录的微秒数, varint (长度 << 1 | 方向), 原始字节
+// 方向 0 为发往模组 (TX)，1 为模组发来 (RX)。按 UART 读写的分块记录，不拆行，
+// 回放时能还原原始的分片和时序
+#define AT_TRANSCRIPT_MAGIC     "ATR"
+#define AT_TRANSCRIPT_VERSION   (1)
+
+enum class AtTranscriptDirection : uint8_t { Tx = 0, Rx = 1 };
+
+struct AtTranscriptRecord {
+    AtTranscriptDirection direction = AtTranscriptDirection::Tx;
+    uint32_t delta_us = 0;
+    std::string data;
+};
+
+// 记录器: 挂到 AtUart::SetTranscript() 后记录每次读写，可在多个任务中调用
+class AtTranscriptWriter {
+public:
+    // 不接管 file，关闭前需先 Flush()
+    explicit AtTranscriptWriter(FILE* file);
+
+    void Record(AtTranscriptDirection direction, const char* data, size_t length);
+    void Flush();
+    size_t bytes_written() const { return bytes_written_; }
+
+private:
+    FILE* file_;
+    std::mutex mutex_;
+    std::chrono::steady_clock::time_point last_;
+    size_t bytes_written_ = 0;
+};
+
+class AtTranscriptReader {
+public:
+    // 校验文件头，失败返回 false
+    bool Open(FILE* file);
+    // 读取下一条记录，文件结束或数据截断时返回 false
+    bool Next(AtTranscriptRecord& record);
+
+private:
+    FILE* file_ = nullptr;
+};
+
+// 回放传输: 代替 UART 驱动，把记录中的 RX 数据按原始时序 (可加速) 交给 AtUart。
+// 每条 TX 记录都要等 AtUart 真的写出同样多的字节才继续，应答不会早于对应的命令到达；
+// 写出的内容与记录不一致时只计数，不中断回放
+class AtReplayTransport : public AtTransport {
+public:
+    // speed: 1 为原始时序，大于 1 按倍数加速，0 表示不等待
+    // tx_timeout_ms: 等待 AtUart 发出命令的上限，超时后跳过该条 TX 继续回放
+    explicit AtReplayTransport(std::vector<AtTranscriptRecord> records, double speed = 1.0, uint32_t tx_timeout_ms = 5000);
+    ~AtReplayTransport();
+
+    // 读取整个记录文件，失败返回空指针
+    static std::unique_ptr<AtReplayTransport> Load(FILE* file, double speed = 1.0);
+
+    bool Open(int baud_rate, size_t rx_buffer_size, size_t tx_buffer_size, AtTransportEventCallback callback) override;
+    size_t Available() override;
+    int Read(char* buffer, size_t length) override;
+    int Write(const char* data, size_t length) override;
+    void SetBaudRate(int baud_rate) override {}
+
+    // 等待回放结束，超时返回 false
+    bool WaitFinished(uint32_t timeout_ms);
+    bool IsFinished() const { return finished_; }
+    size_t tx_mismatch_count() const { return tx_mismatch_count_; }
+    size_t tx_timeout_count() const { return tx_timeout_count_; }
+
+private:
+    std::vector<AtTranscriptRecord> records_;
+    std::string expected_tx_;       // 所有 TX 记录依次拼接，用于比对实际写出的内容
+    double speed_;
+    uint32_t tx_timeout_ms_;
+    AtTransportEventCallback callback_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string rx_pending_;
+    size_t rx_offset_ = 0;
+    size_t tx_written_ = 0;
+    size_t tx_mismatch_count_ = 0;
+    size_t tx_timeout_count_ = 0;
+    bool stopping_ = false;
+    std::atomic<bool> finished_{false};
+    std::thread thread_;
+
+    void Play();
+};
+
+#endif // _AT_TRANSCRIPT_H_
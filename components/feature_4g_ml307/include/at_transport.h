@@ -0,0 +1,41 @@
+#ifndef _AT_TRANSPORT_H_
+#define _AT_TRANSPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// 传输层事件，由传输实现从自己的上下文 (驱动事件任务、回放线程等) 通知 AtUart
+enum class AtTransportEvent {
+    DataAvailable,
+    BufferFull,     // 驱动环形缓冲区满: 驱动暂停从 FIFO 搬数据，读走后继续，不丢数据
+    FifoOverflow,   // 硬件 FIFO 溢出，已丢数据
+    Break,
+};
+
+typedef std::function<void(AtTransportEvent event)> AtTransportEventCallback;
+
+// AtUart 与模组之间的字节流。
+// 设备上是 UART 驱动 (UartTransport)，主机上可以换成回放 (AtReplayTransport)，
+// AtUart 的解析和命令流水线不依赖具体实现。
+class AtTransport {
+public:
+    virtual ~AtTransport() = default;
+
+    // 打开传输，之后收到数据时调用 callback
+    virtual bool Open(int baud_rate, size_t rx_buffer_size, size_t tx_buffer_size, AtTransportEventCallback callback) = 0;
+    // 已收到、尚未读取的字节数
+    virtual size_t Available() = 0;
+    // 最多读取 length 字节，不阻塞，返回实际读取的字节数，出错返回负数
+    virtual int Read(char* buffer, size_t length) = 0;
+    // 返回写入的字节数，出错返回负数
+    virtual int Write(const char* data, size_t length) = 0;
+    virtual void SetBaudRate(int baud_rate) = 0;
+    // 等待已写入的数据全部发出，切换波特率前使用
+    virtual void WaitTxDone(uint32_t timeout_ms) {}
+    // 是否接了 RTS/CTS，以及模组同意后打开本地 CTS 检测
+    virtual bool HasFlowControl() const { return false; }
+    virtual void EnableFlowControl() {}
+};
+
+#endif // _AT_TRANSPORT_H_
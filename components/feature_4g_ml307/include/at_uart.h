@@ -2,123 +2,352 @@
 #define _AT_UART_H_
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
 #include <mutex>
 #include <list>
+#include <map>
 #include <cstdlib>
+#include <charconv>
 #include <memory>
+#include <deque>
+#include <atomic>
+#include <condition_variable>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include <freertos/event_groups.h>
+#include <sdkconfig.h>
+#if !CONFIG_IDF_TARGET_LINUX
 #include <driver/gpio.h>
-#include <driver/uart.h>
+#endif
+#include "at_transport.h"
+#include "at_transcript.h"
 
 // UART事件定义
 #define AT_EVENT_DATA_AVAILABLE BIT1
-#define AT_EVENT_COMMAND_DONE   BIT2
-#define AT_EVENT_COMMAND_ERROR  BIT3
+#define AT_EVENT_COMMAND_ISSUED BIT2    // 有新命令发出，接收任务据此重新计算超时
 #define AT_EVENT_BUFFER_FULL    BIT4
 #define AT_EVENT_FIFO_OVF       BIT5
 #define AT_EVENT_BREAK          BIT6
 #define AT_EVENT_UNKNOWN        BIT7
 
 // 默认配置
-#define UART_NUM                UART_NUM_1
+#define AT_UART_RX_BUFFER_SIZE  (8 * 1024)  // 接收缓冲区容量，需容纳最长的一行 (如 MIPURC 十六进制载荷)
+#define AT_UART_DRIVER_RX_BUFFER_SIZE   (8 * 1024)  // UART 驱动接收环形缓冲区默认容量
+#define AT_UART_DRIVER_TX_BUFFER_SIZE   (0)         // 0 表示发送时阻塞直到写入硬件 FIFO
 
-// AT命令参数值结构
+// AT命令参数值: 直接引用接收缓冲区中的文本，数值在访问时才解析。
+// 只在 URC 回调执行期间有效，需要保留时请拷贝为 std::string。
 struct AtArgumentValue {
     enum class Type { String, Int, Double };
-    Type type;
-    std::string string_value;
-    int int_value;
-    double double_value;
+    Type type = Type::String;
+    std::string_view string_value;  // 字符串参数已去掉两侧引号
+
+    int int_value() const {
+        int value = 0;
+        std::from_chars(string_value.data(), string_value.data() + string_value.size(), value);
+        return value;
+    }
+
+    double double_value() const {
+        double value = 0;
+        std::from_chars(string_value.data(), string_value.data() + string_value.size(), value);
+        return value;
+    }
     
     std::string ToString() const {
         switch (type) {
             case Type::String:
-                return "\"" + string_value + "\"";
+                return "\"" + std::string(string_value) + "\"";
             case Type::Int:
-                return std::to_string(int_value);
             case Type::Double:
-                return std::to_string(double_value);
+                return std::string(string_value);
             default:
                 return "";
         }
     }
 };
 
-// 数据接收回调函数类型
-typedef std::function<void(const std::string& command, const std::vector<AtArgumentValue>& arguments)> UrcCallback;
+// URC 参数列表: 固定内联容量，不做堆分配，超出容量的参数被丢弃
+#define AT_ARGUMENTS_MAX        (16)
+
+class AtArguments {
+public:
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    const AtArgumentValue& operator[](size_t index) const { return values_[index]; }
+    const AtArgumentValue* begin() const { return values_; }
+    const AtArgumentValue* end() const { return values_ + count_; }
+
+private:
+    friend class AtUart;
+    AtArgumentValue values_[AT_ARGUMENTS_MAX];
+    size_t count_ = 0;
+};
+
+// AT 命令流水线
+#define AT_PIPELINE_DEPTH       (4)     // 已发出、尚未收到最终结果的命令数上限，1 即严格一问一答
+// 命令超时后迟到的最终结果会错配给后面的命令: 超时后暂停流水线，丢弃预计迟到的结果数，
+// 再发一条 "AT" 作为哨兵，收到它的结果才恢复
+#define AT_RESYNC_TIMEOUT_MS    (500)
+#define AT_RESYNC_ATTEMPTS      (3)     // 哨兵连续超时这么多次即放弃，认为模组无响应，恢复正常发出
+
+enum class AtResult { Pending, Ok, Error, Timeout };
+
+struct AtCommandResult {
+    AtResult result = AtResult::Pending;
+    int cme_error_code = 0;
+    std::string response;   // 最后一行非 URC 的应答文本
+};
+
+// 命令完成回调，在接收任务中执行，不能在其中发起同步命令
+typedef std::function<void(const AtCommandResult& result)> AtCommandCallback;
+
+class AtUart;
+
+// 已提交命令的句柄: 可以轮询或等待结果
+class AtCommand {
+public:
+    bool IsDone() const { return done_; }
+    // 等待命令完成，返回是否成功 (OK)。超时只是停止等待，命令仍由接收任务按自身超时结束
+    bool Wait(size_t timeout_ms);
+    // 完成后有效
+    const AtCommandResult& result() const { return result_; }
+
+private:
+    friend class AtUart;
+    AtUart* owner_ = nullptr;
+    std::string wire_;              // 实际发送的字节，含 \r\n
+    bool expects_prompt_ = false;   // 带数据的命令: 等 '>' 后由调用者写入数据，期间独占流水线
+    bool prompted_ = false;
+    bool sentinel_ = false;         // 超时后重新同步用的 "AT"
+    TickType_t timeout_ticks_ = 0;
+    TickType_t deadline_ = 0;
+    AtCommandCallback callback_;
+    AtCommandResult result_;
+    std::atomic<bool> done_{false};
+};
+typedef std::shared_ptr<AtCommand> AtCommandHandle;
+
+// 批量命令
+#define AT_BATCH_LINE_MAX       (256)   // 用 ';' 串联时一行的最大长度 (不含 \r\n)
+
+// 可缓存的配置项: key 标识模组上的一项设置，以连接为前缀 (如 "mip0/encoding")，
+// 便于按连接整体失效。command 为完整命令，与上次成功下发的相同时跳过
+struct AtConfigItem {
+    std::string key;
+    std::string command;
+};
+
+// 数据接收回调函数类型，command 和 arguments 都只在回调期间有效
+typedef std::function<void(std::string_view command, const AtArguments& arguments)> UrcCallback;
+
+// URC 按命令名 (及可选的连接号) 哈希分发
+#define AT_URC_BUCKETS          (32)    // 必须是2的幂
+#define AT_URC_ANY_LINK         (-1)
+
+// 订阅键: 命令名，以及连接号所在的参数下标 (-1 表示不按连接过滤)。
+// 同一个命令的连接号下标必须一致，例如 MIPURC 固定为 1。
+struct UrcKey {
+    std::string_view command;
+    int link_index = -1;
+};
+
+struct UrcHandler {
+    uint32_t hash;
+    int link_id;
+    std::string command;
+    UrcCallback callback;
+};
+
+// 注册句柄，用于注销
+struct UrcRegistration {
+    std::list<UrcHandler>* bucket;
+    std::list<UrcHandler>::iterator iterator;
+};
 
 class AtUart {
 public:
     // 构造函数
-    AtUart(gpio_num_t tx_pin, gpio_num_t rx_pin, gpio_num_t dtr_pin = GPIO_NUM_NC);
+#if !CONFIG_IDF_TARGET_LINUX
+    // 使用 UART 驱动，rts_pin/cts_pin 都接线时才能启用硬件流控
+    AtUart(gpio_num_t tx_pin, gpio_num_t rx_pin, gpio_num_t dtr_pin = GPIO_NUM_NC,
+           gpio_num_t rts_pin = GPIO_NUM_NC, gpio_num_t cts_pin = GPIO_NUM_NC);
+#endif
+    // 使用指定的传输，如主机上的 AtReplayTransport
+    explicit AtUart(std::unique_ptr<AtTransport> transport);
     ~AtUart();
 
     // 初始化和配置
-    void Initialize();
+    void Initialize(size_t rx_buffer_size = AT_UART_DRIVER_RX_BUFFER_SIZE, size_t tx_buffer_size = AT_UART_DRIVER_TX_BUFFER_SIZE);
+    // 通知模组启用 RTS/CTS (AT+IFC=2,2) 后打开本地 CTS 检测，未接流控引脚时返回 false
+    bool EnableFlowControl();
+    bool IsFlowControlEnabled() const { return flow_control_enabled_; }
     
     // 波特率管理
-    bool SetBaudRate(int new_baud_rate);
+    // detect_timeout_ms < 0 时会一直探测直到模组应答
+    bool SetBaudRate(int new_baud_rate, int detect_timeout_ms = -1);
     int GetBaudRate() const { return baud_rate_; }
+    // 只在指定波特率上探测，成功则采用该波特率，失败时保持原波特率
+    bool ProbeBaudRate(int baud_rate, int attempts = 3);
+    // 从当前波特率逐级向上协商，每一级用往返校验确认稳定，不稳定则回退。
+    // 返回最终使用的波特率
+    int NegotiateBaudRate(int max_baud_rate);
     
     // 数据发送
+    // 同步接口: 等待该命令的最终结果，其他任务的命令可以同时在流水线中
     bool SendCommand(const std::string& command, size_t timeout_ms = 1000, bool add_crlf = true);
     bool SendCommandWithData(const std::string& command, size_t timeout_ms = 1000, bool add_crlf = true, const char* data = nullptr, size_t data_length = 0);
+    // 异步接口: 排队后立即返回，最多 AT_PIPELINE_DEPTH 条命令连续发出而不等前一条的 OK，
+    // 最终结果按发出顺序对应。完成时调用 callback (可为空)
+    AtCommandHandle SendCommandAsync(const std::string& command, size_t timeout_ms = 1000, AtCommandCallback callback = nullptr, bool add_crlf = true);
+    // 批量发送: 模组支持串联时合并为 "AT+A;+B" 一行，否则经流水线连续发出，只等一个往返。
+    // 全部成功返回 true，失败时 GetResponse()/GetCmeErrorCode() 为第一条失败命令的结果。
+    // 串联时一条失败模组即放弃该行余下的命令；流水线方式下其余命令照常执行
+    bool SendCommands(const std::vector<std::string>& commands, size_t timeout_ms = 1000);
+    // 模组支持 V.250 的 ';' 串联扩展命令时打开
+    void SetCommandChaining(bool enable) { command_chaining_ = enable; }
+    // 下发配置，跳过缓存中已成功下发过的项。失败的批次从缓存中移除，下次全部重发
+    bool ApplyConfig(const std::vector<AtConfigItem>& items, size_t timeout_ms = 1000);
+    // 使 key 以 prefix 开头的缓存项失效，空前缀清空全部。模组重启后或连接出错时调用
+    void InvalidateConfig(std::string_view prefix = {});
     const std::string& GetResponse() const { return response_; }
     int GetCmeErrorCode() const { return cme_error_code_; }
     
     // 回调管理
+    // 通配注册: 收到任何 URC 都会调用
     std::list<UrcCallback>::iterator RegisterUrcCallback(UrcCallback callback);
     void UnregisterUrcCallback(std::list<UrcCallback>::iterator iterator);
+    // 按键注册: 只在命令名匹配、且 (键带连接号下标时) 该参数等于 link_id 时调用
+    std::vector<UrcRegistration> RegisterUrcHandlers(std::initializer_list<UrcKey> keys, int link_id, const UrcCallback& callback);
+    void UnregisterUrcHandlers(std::vector<UrcRegistration>& registrations);
+    // 长度定界的二进制 URC: "+<command>: ...,<length>,<length 字节原始数据>\r\n"
+    // link_index/length_index 为连接号和长度所在的参数下标，只对打开的 link_id 按长度切帧，
+    // 原始数据作为最后一个参数交给回调，其中可以包含 \r\n
+    void SetBinaryUrc(std::string_view command, int link_index, int length_index, int link_id, bool enable);
     
     // 控制接口
     void SetDtrPin(bool high);
     bool IsInitialized() const { return initialized_; }
+    // 超长行导致接收缓冲区溢出而被丢弃的次数
+    size_t GetRxOverflowCount() const { return rx_overflow_count_; }
+    // 硬件 FIFO 溢出的次数。溢出会丢数据: 丢弃当前半行并在下一个行尾重新同步，
+    // 同时以不带参数的 URC "FIFO_OVERFLOW" 通知各连接，收流式数据的连接应视为数据已损坏
+    size_t GetFifoOverflowCount() const { return fifo_overflow_count_; }
+    // 驱动环形缓冲区满的次数，驱动会暂停搬运而不丢数据，只用于观察接收任务是否跟得上
+    size_t GetBufferFullCount() const { return buffer_full_count_; }
+    // 把之后的每次读写连同时间戳记录到 transcript，传空指针停止记录
+    void SetTranscript(std::shared_ptr<AtTranscriptWriter> transcript);
 
-    std::string EncodeHex(const std::string& data);
-    std::string DecodeHex(const std::string& data);
+    // 十六进制编解码
+    // 写入调用者提供的缓冲区，返回写入的字节数: 编码需要 length * 2，解码需要 length / 2。
+    // 解码允许 out == data 原地进行。解码只接受 [0-9A-Fa-f]，不做校验: 非法字符得到的字节值不确定
+    // (旧实现按 0 处理)，奇数长度时末尾多出的一个字符被忽略。模组上报的十六进制数据总是合法的
+    static size_t EncodeHex(const char* data, size_t length, char* out);
+    static size_t DecodeHex(const char* data, size_t length, char* out);
+    std::string EncodeHex(std::string_view data);
+    std::string DecodeHex(std::string_view data);
     void EncodeHexAppend(std::string& dest, const char* data, size_t length);
     void DecodeHexAppend(std::string& dest, const char* data, size_t length);
 
 private:
     // 配置参数
-    gpio_num_t tx_pin_;
-    gpio_num_t rx_pin_;
-    gpio_num_t dtr_pin_;
-    uart_port_t uart_num_;
+    std::unique_ptr<AtTransport> transport_;
+    int dtr_pin_ = -1;
     int baud_rate_;
     bool initialized_;
+    bool flow_control_enabled_ = false;
     int cme_error_code_ = 0;
     std::string response_;
-    bool wait_for_response_ = false;
-    std::mutex command_mutex_;
     std::mutex mutex_;
+
+    // 命令流水线，由 command_mutex_ 保护
+    std::mutex command_mutex_;
+    std::condition_variable command_cv_;    // 命令完成或收到 '>' 时通知等待者
+    std::deque<AtCommandHandle> pending_commands_;     // 等待发出
+    std::deque<AtCommandHandle> inflight_commands_;    // 已发出，按发出顺序等待最终结果
+    std::atomic<bool> prompt_expected_{false};
+    bool command_chaining_ = false;
+    bool resyncing_ = false;        // 有命令超时，哨兵收到结果前不再发出其他命令
+    size_t resync_discard_ = 0;     // 超时命令可能迟到的最终结果，收到时直接丢弃
+    int resync_attempts_ = 0;
+
+    // 已下发的配置 key -> command
+    std::map<std::string, std::string, std::less<>> config_cache_;
+    std::mutex config_mutex_;
+    
+    // 收发记录，可在运行中挂上或摘下
+    std::shared_ptr<AtTranscriptWriter> transcript_;
+    std::mutex transcript_mutex_;
     
     // FreeRTOS 对象
-    TaskHandle_t event_task_handle_ = nullptr;
     TaskHandle_t receive_task_handle_ = nullptr;
-    QueueHandle_t event_queue_handle_;
     EventGroupHandle_t event_group_handle_;
     
-    std::string rx_buffer_;
+    // 接收缓冲区: 固定容量的线性缓冲，[rx_head_, rx_tail_) 为尚未解析的数据。
+    // 行按下标切分，解析时以 string_view 直接引用缓冲区内容，读入新数据前才把残余的半行挪到开头。
+    std::unique_ptr<char[]> rx_buffer_;
+    size_t rx_head_ = 0;
+    size_t rx_tail_ = 0;
+    size_t rx_scan_ = 0;            // 此位置之前已确认没有行尾，长行分片到达时不必重复扫描
+    bool rx_discarding_ = false;    // 超长行已被丢弃，跳过数据直到下一个行尾
+    size_t rx_skip_ = 0;            // 放不下的二进制帧剩余待跳过的字节数
+    size_t rx_overflow_count_ = 0;
+    size_t fifo_overflow_count_ = 0;
+    size_t buffer_full_count_ = 0;
+
+    // URC 参数，引用接收缓冲区，每行复用
+    AtArguments urc_arguments_;
     
     // 回调函数
     std::list<UrcCallback> urc_callbacks_;
+    std::list<UrcHandler> urc_buckets_[AT_URC_BUCKETS];
+    // 带连接号过滤的命令及其连接号参数下标，条目数只与命令种类有关
+    struct UrcLinkIndex {
+        uint32_t hash;
+        std::string command;
+        int index;
+    };
+    std::vector<UrcLinkIndex> urc_link_indexes_;
+    // 按长度切帧的二进制 URC，每个打开的连接一项
+    struct BinaryUrc {
+        std::string prefix;     // "+MIPURC: "
+        int link_index;
+        int length_index;
+        int link_id;
+    };
+    std::vector<BinaryUrc> binary_urcs_;
     
     // 内部方法
-    void EventTask();
+    void OnTransportEvent(AtTransportEvent event);
     void ReceiveTask();
     bool ParseResponse();
-    bool DetectBaudRate();
-    // 处理 AT 命令
-    void HandleCommand(const char* command);
+    int ParseBinaryUrc(std::string_view pending);
+    void ParseLine(std::string_view line);
+    void ParseArguments(std::string_view values);
+    void CompactRxBuffer();
+    void ResyncRxBuffer();
+    bool DetectBaudRate(int timeout_ms = -1);
+    bool SwitchBaudRate(int new_baud_rate);
+    bool VerifyBaudRate(const std::string& reference);
+    // 命令流水线
+    AtCommandHandle QueueCommand(const std::string& command, size_t timeout_ms, bool add_crlf, bool expects_prompt, AtCommandCallback callback);
+    void IssueCommands();
+    void CompleteCommand(AtResult result, int cme_error_code);
+    void FinishCommand(const AtCommandHandle& command);
+    void ExpireCommands();
+    void ResetCommandSync();
+    TickType_t NextCommandTimeout();
+    bool WaitCommand(AtCommand& command, size_t timeout_ms, bool until_prompt);
     // 处理 URC
-    void HandleUrc(const std::string& command, const std::vector<AtArgumentValue>& arguments);
+    void HandleUrc(std::string_view command, const AtArguments& arguments);
+    void DispatchUrc(uint32_t hash, int link_id, std::string_view command, const AtArguments& arguments);
     bool SendData(const char* data, size_t length);
+    std::shared_ptr<AtTranscriptWriter> GetTranscript();
+
+    friend class AtCommand;
 };
 
 #endif // _AT_UART_H_
@@ -0,0 +1,48 @@
+#ifndef _UART_TRANSPORT_H_
+#define _UART_TRANSPORT_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#include "at_transport.h"
+
+// 默认配置
+#define UART_NUM                        UART_NUM_1
+#define AT_UART_RX_FULL_THRESHOLD       (64)        // 硬件 FIFO (128 字节) 达到此字节数即进中断，留出一半余量应对中断延迟
+#define AT_UART_RX_TIMEOUT_SYMBOLS      (4)         // 线路空闲多少个字符时间后把不足阈值的数据交给驱动
+#define AT_UART_RTS_THRESHOLD           (100)       // 启用流控时 FIFO 超过此字节数即拉高 RTS 让模组暂停
+
+// ESP-IDF UART 驱动上的传输实现
+class UartTransport : public AtTransport {
+public:
+    // rts_pin/cts_pin 都接线时才能启用硬件流控
+    UartTransport(gpio_num_t tx_pin, gpio_num_t rx_pin, gpio_num_t rts_pin = GPIO_NUM_NC, gpio_num_t cts_pin = GPIO_NUM_NC,
+                  uart_port_t uart_num = UART_NUM);
+    ~UartTransport();
+
+    bool Open(int baud_rate, size_t rx_buffer_size, size_t tx_buffer_size, AtTransportEventCallback callback) override;
+    size_t Available() override;
+    int Read(char* buffer, size_t length) override;
+    int Write(const char* data, size_t length) override;
+    void SetBaudRate(int baud_rate) override;
+    void WaitTxDone(uint32_t timeout_ms) override;
+    bool HasFlowControl() const override { return rts_pin_ != GPIO_NUM_NC && cts_pin_ != GPIO_NUM_NC; }
+    void EnableFlowControl() override;
+
+private:
+    gpio_num_t tx_pin_;
+    gpio_num_t rx_pin_;
+    gpio_num_t rts_pin_;
+    gpio_num_t cts_pin_;
+    uart_port_t uart_num_;
+    bool opened_ = false;
+    AtTransportEventCallback callback_;
+    TaskHandle_t event_task_handle_ = nullptr;
+    QueueHandle_t event_queue_handle_ = nullptr;
+
+    void EventTask();
+};
+
+#endif // _UART_TRANSPORT_H_
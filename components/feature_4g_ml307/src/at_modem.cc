@@ -3,19 +3,74 @@
 #include "ec801e/ec801e_at_modem.h"
 #include <esp_log.h>
 #include <esp_err.h>
+#include <nvs.h>
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <cctype>
 
 static const char* TAG = "AtModem";
 
+// 15 位数字，最后一位为 Luhn 校验位
+static bool IsValidImei(const std::string& imei) {
+    if (imei.size() != 15) {
+        return false;
+    }
+    int sum = 0;
+    for (size_t i = 0; i < imei.size(); i++) {
+        if (imei[i] < '0' || imei[i] > '9') {
+            return false;
+        }
+        int digit = imei[i] - '0';
+        if (i % 2 == 1) {
+            digit *= 2;
+            if (digit > 9) {
+                digit -= 9;
+            }
+        }
+        sum += digit;
+    }
+    return sum % 10 == 0;
+}
+
+// 19~20 位，以 89 (电信行业) 开头。部分运营商的号段含字母，不做 Luhn 校验
+static bool IsValidIccid(const std::string& iccid) {
+    if (iccid.size() < 19 || iccid.size() > 20 || iccid.compare(0, 2, "89") != 0) {
+        return false;
+    }
+    for (char c : iccid) {
+        if (!isalnum((unsigned char)c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string ReadNvsString(nvs_handle_t handle, const char* key) {
+    size_t length = 0;
+    if (nvs_get_str(handle, key, nullptr, &length) != ESP_OK || length == 0) {
+        return "";
+    }
+    std::string value(length, '\0');
+    if (nvs_get_str(handle, key, value.data(), &length) != ESP_OK) {
+        return "";
+    }
+    value.resize(length - 1);
+    return value;
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
 std::unique_ptr<AtModem> AtModem::Detect(gpio_num_t tx_pin, gpio_num_t rx_pin, gpio_num_t dtr_pin, int baud_rate) {
     // 创建AtUart进行检测
     auto uart = std::make_shared<AtUart>(tx_pin, rx_pin, dtr_pin);
     uart->Initialize();
-    
+    return Detect(uart, baud_rate, -1);
+}
+#endif
+
+std::unique_ptr<AtModem> AtModem::Detect(std::shared_ptr<AtUart> uart, int baud_rate, int timeout_ms) {
     // 设置波特率
-    if (!uart->SetBaudRate(baud_rate)) {
+    if (!uart->SetBaudRate(baud_rate, timeout_ms)) {
         return nullptr;
     }
     
@@ -29,21 +84,27 @@ std::unique_ptr<AtModem> AtModem::Detect(gpio_num_t tx_pin, gpio_num_t rx_pin, g
     ESP_LOGI(TAG, "Detected modem: %s", response.c_str());
     
     // 检查响应中的模组型号
+    std::unique_ptr<AtModem> modem;
     if (response.find("EC801E") == 0) {
-        return std::make_unique<Ec801EAtModem>(uart);
+        modem = std::make_unique<Ec801EAtModem>(uart);
     } else if (response.find("NT26K") == 0) {
-        return std::make_unique<Ec801EAtModem>(uart);
+        modem = std::make_unique<Ec801EAtModem>(uart);
     } else if (response.find("ML307") == 0) {
-        return std::make_unique<Ml307AtModem>(uart);
+        modem = std::make_unique<Ml307AtModem>(uart);
     } else {
         ESP_LOGE(TAG, "Unrecognized modem type: %s, use ML307 AtModem as default", response.c_str());
-        return std::make_unique<Ml307AtModem>(uart);
+        modem = std::make_unique<Ml307AtModem>(uart);
     }
+
+    // 检测时已经拿到固件版本，顺便用它校验身份缓存
+    modem->module_revision_ = response;
+    modem->LoadIdentity();
+    return modem;
 }
 
 AtModem::AtModem(std::shared_ptr<AtUart> at_uart) : at_uart_(at_uart) {
     event_group_handle_ = xEventGroupCreate();
-    at_uart_->RegisterUrcCallback([this](const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+    at_uart_->RegisterUrcCallback([this](std::string_view command, const AtArguments& arguments) {
         HandleUrc(command, arguments);
     });
 }
@@ -90,6 +151,7 @@ NetworkStatus AtModem::WaitForNetworkReady(int timeout_ms) {
         }
         if (at_uart_->GetCmeErrorCode() == 10) {
             pin_ready_ = false;
+            sim_changed_ = true;
             return NetworkStatus::ErrorInsertPin;
         }
         vTaskDelay(pdMS_TO_TICKS(1000));
@@ -99,6 +161,12 @@ NetworkStatus AtModem::WaitForNetworkReady(int timeout_ms) {
     if (!at_uart_->SendCommand("AT+CEREG=2")) {
         return NetworkStatus::Error;
     }
+    // 订阅信号强度等主动上报，已下发过的由 AtUart 的配置缓存跳过
+    std::vector<AtConfigItem> report_config;
+    AppendReportConfig(report_config);
+    if (!report_config.empty()) {
+        csq_reporting_ = at_uart_->ApplyConfig(report_config);
+    }
     if (!at_uart_->SendCommand("AT+CEREG?")) {
         return NetworkStatus::Error;
     }
@@ -126,15 +194,93 @@ std::string AtModem::GetImei() {
     if (!imei_.empty()) {
         return imei_;
     }
-    at_uart_->SendCommand("AT+CGSN=1");
+    if (at_uart_->SendCommand("AT+CGSN=1") && IsValidImei(imei_)) {
+        SaveIdentity();
+    }
     return imei_;
 }
 
 std::string AtModem::GetIccid() {
-    at_uart_->SendCommand("AT+ICCID");
+    if (!iccid_.empty() && !sim_changed_) {
+        return iccid_;
+    }
+    return RefreshIccid();
+}
+
+std::string AtModem::RefreshIccid() {
+    std::string cached = iccid_;
+    sim_changed_ = false;
+    if (!at_uart_->SendCommand("AT+ICCID")) {
+        return iccid_;
+    }
+    iccid_unverified_ = false;
+    if (iccid_ != cached && IsValidIccid(iccid_)) {
+        if (!cached.empty()) {
+            ESP_LOGI(TAG, "SIM card changed, ICCID: %s", iccid_.c_str());
+        }
+        SaveIdentity();
+    }
     return iccid_;
 }
 
+void AtModem::VerifyCachedIdentity() {
+    if (iccid_unverified_) {
+        RefreshIccid();
+    }
+}
+
+bool AtModem::LoadIdentity() {
+    nvs_handle_t handle;
+    if (nvs_open(AT_MODEM_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    std::string revision = ReadNvsString(handle, "revision");
+    std::string imei = ReadNvsString(handle, "imei");
+    std::string iccid = ReadNvsString(handle, "iccid");
+    nvs_close(handle);
+
+    // 固件版本不同说明模组换过或升级过，整份缓存作废
+    if (module_revision_.empty() || revision != module_revision_ || !IsValidImei(imei)) {
+        ESP_LOGI(TAG, "Identity cache invalid, will query modem");
+        return false;
+    }
+    imei_ = imei;
+    if (IsValidIccid(iccid)) {
+        iccid_ = iccid;
+        iccid_unverified_ = true;
+    }
+    ESP_LOGI(TAG, "Identity loaded from cache, IMEI: %s, ICCID: %s", imei_.c_str(), iccid_.c_str());
+    return true;
+}
+
+void AtModem::SaveIdentity() {
+    if (module_revision_.empty() || !IsValidImei(imei_)) {
+        return;
+    }
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(AT_MODEM_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_str(handle, "revision", module_revision_.c_str());
+        if (err == ESP_OK) {
+            err = nvs_set_str(handle, "imei", imei_.c_str());
+        }
+        if (err == ESP_OK) {
+            if (IsValidIccid(iccid_)) {
+                err = nvs_set_str(handle, "iccid", iccid_.c_str());
+            } else {
+                nvs_erase_key(handle, "iccid");
+            }
+        }
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save identity cache: %s", esp_err_to_name(err));
+    }
+}
+
 std::string AtModem::GetModuleRevision() {
     if (!module_revision_.empty()) {
         return module_revision_;
@@ -146,11 +292,18 @@ std::string AtModem::GetModuleRevision() {
 }
 
 std::string AtModem::GetCarrierName() {
-    at_uart_->SendCommand("AT+COPS?");
+    if (carrier_name_.empty() || carrier_stale_) {
+        carrier_stale_ = false;
+        at_uart_->SendCommand("AT+COPS?");
+    }
     return carrier_name_;
 }
 
 int AtModem::GetCsq() {
+    // 已订阅上报时使用最近一次上报的值，尚未收到过上报才查询
+    if (csq_reporting_ && csq_ >= 0) {
+        return csq_;
+    }
     at_uart_->SendCommand("AT+CSQ", 10);
     return csq_;
 }
@@ -160,7 +313,7 @@ CeregState AtModem::GetRegistrationState() {
     return cereg_state_;
 }
 
-void AtModem::HandleUrc(const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+void AtModem::HandleUrc(std::string_view command, const AtArguments& arguments) {
     if (command == "CGSN" && arguments.size() >= 1) {
         imei_ = arguments[0].string_value;
     } else if (command == "ICCID" && arguments.size() >= 1) {
@@ -168,19 +321,19 @@ void AtModem::HandleUrc(const std::string& command, const std::vector<AtArgument
     } else if (command == "COPS" && arguments.size() >= 4) {
         carrier_name_ = arguments[2].string_value;
     } else if (command == "CSQ" && arguments.size() >= 1) {
-        csq_ = arguments[0].int_value;
+        csq_ = arguments[0].int_value();
     } else if (command == "CEREG" && arguments.size() >= 1) {
         cereg_state_ = CeregState{};
         if (arguments.size() == 1) {
             cereg_state_.stat = 0;
         } else if (arguments.size() >= 2) {
             int state_index = arguments[1].type == AtArgumentValue::Type::Int ? 1 : 0;
-            cereg_state_.stat = arguments[state_index].int_value;
+            cereg_state_.stat = arguments[state_index].int_value();
             if (arguments.size() >= state_index + 2) {
                 cereg_state_.tac = arguments[state_index + 1].string_value;
                 cereg_state_.ci = arguments[state_index + 2].string_value;
                 if (arguments.size() >= state_index + 4) {
-                    cereg_state_.AcT = arguments[state_index + 3].int_value;
+                    cereg_state_.AcT = arguments[state_index + 3].int_value();
                 }
             }
         }
@@ -188,6 +341,8 @@ void AtModem::HandleUrc(const std::string& command, const std::vector<AtArgument
         bool new_network_ready = cereg_state_.stat == 1 || cereg_state_.stat == 5;
         if (new_network_ready != network_ready_) {
             network_ready_ = new_network_ready;
+            // 重新注网可能落在别的运营商网络上
+            carrier_stale_ = true;
             if (on_network_state_changed_) {
                 on_network_state_changed_(new_network_ready);
             }
@@ -198,10 +353,11 @@ void AtModem::HandleUrc(const std::string& command, const std::vector<AtArgument
             xEventGroupSetBits(event_group_handle_, AT_EVENT_NETWORK_ERROR);
         }
     } else if (command == "CPIN" && arguments.size() >= 1) {
-        if (arguments[0].string_value == "READY") {
-            pin_ready_ = true;
-        } else {
-            pin_ready_ = false;
+        bool new_pin_ready = arguments[0].string_value == "READY";
+        if (new_pin_ready != pin_ready_) {
+            // SIM 卡拔插过，下次 GetIccid 重新读取
+            sim_changed_ = true;
         }
+        pin_ready_ = new_pin_ready;
     }
 }
@@ -0,0 +1,1407 @@
+#include "at_modem_simulator.h"
+#include "at_uart.h"
+#include <esp_log.h>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#define TAG "AtModemSimulator"
+
+#define SIM_RESULT_OK           (0)
+#define SIM_RESULT_ERROR        (-1)
+#define SIM_RESULT_PROMPT       (-2)    // 已回 '>'，等数据到齐再给最终结果
+#define SIM_CME_NOT_ALLOWED     (3)
+#define SIM_CME_UNKNOWN         (100)
+
+#define SIM_SOCKET_CHUNK        (1460)  // 每条接收 URC 最多携带的数据
+#define SIM_URC_CHUNK           (1024)  // MQTT/HTTP 十六进制 URC 每条最多携带的原始字节
+#define SIM_HTTP_MAX_INSTANCES  (4)
+
+#define MQTT_CONNECT            (0x10)
+#define MQTT_CONNACK            (0x20)
+#define MQTT_PUBLISH            (0x30)
+#define MQTT_PUBACK             (0x40)
+#define MQTT_SUBSCRIBE          (0x82)
+#define MQTT_SUBACK             (0x90)
+#define MQTT_UNSUBSCRIBE        (0xA2)
+#define MQTT_PINGREQ            (0xC0)
+#define MQTT_DISCONNECT         (0xE0)
+
+
+// 按不在引号内的逗号切分参数，去掉两侧引号
+static std::vector<std::string> SplitArguments(std::string_view text) {
+    std::vector<std::string> args;
+    std::string current;
+    bool quoted = false;
+    for (char c : text) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (c == ',' && !quoted) {
+            args.push_back(std::move(current));
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!text.empty()) {
+        args.push_back(std::move(current));
+    }
+    return args;
+}
+
+static int ToInt(const std::vector<std::string>& args, size_t index, int default_value = 0) {
+    if (index >= args.size() || args[index].empty()) {
+        return default_value;
+    }
+    return atoi(args[index].c_str());
+}
+
+static void AppendLine(std::string& out, const std::string& line) {
+    out += "\r\n";
+    out += line;
+    out += "\r\n";
+}
+
+static std::string EncodeHex(const std::string& data) {
+    std::string out(data.size() * 2, '\0');
+    AtUart::EncodeHex(data.data(), data.size(), out.data());
+    return out;
+}
+
+static std::string DecodeHex(const std::string& data) {
+    std::string out(data.size() / 2, '\0');
+    AtUart::DecodeHex(data.data(), data.size(), out.data());
+    return out;
+}
+
+static std::string MqttString(std::string_view value) {
+    std::string out;
+    out += (char)(value.size() >> 8);
+    out += (char)(value.size() & 0xFF);
+    out += value;
+    return out;
+}
+
+static std::string MqttPacket(uint8_t type, const std::string& body) {
+    std::string packet(1, (char)type);
+    size_t length = body.size();
+    do {
+        uint8_t byte = length % 128;
+        length /= 128;
+        if (length > 0) {
+            byte |= 0x80;
+        }
+        packet += (char)byte;
+    } while (length > 0);
+    return packet + body;
+}
+
+// 从流中取出一个完整的 MQTT 报文，数据不够时返回 false
+static bool TakeMqttPacket(std::string& stream, uint8_t& type, std::string& body) {
+    size_t length = 0;
+    size_t pos = 1;
+    for (int shift = 0; ; shift += 7, pos++) {
+        if (pos >= stream.size() || shift > 21) {
+            return false;
+        }
+        uint8_t byte = stream[pos];
+        length |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+    pos++;
+    if (stream.size() < pos + length) {
+        return false;
+    }
+    type = stream[0];
+    body = stream.substr(pos, length);
+    stream.erase(0, pos + length);
+    return true;
+}
+
+AtModemSimulator::AtModemSimulator(const AtModemSimulatorConfig& config) : config_(config) {
+    auto now = Clock::now();
+    uart_free_ = uplink_free_ = downlink_free_ = now;
+    if (pipe(wake_pipe_) == 0) {
+        fcntl(wake_pipe_[0], F_SETFL, O_NONBLOCK);
+        fcntl(wake_pipe_[1], F_SETFL, O_NONBLOCK);
+    }
+}
+
+AtModemSimulator::~AtModemSimulator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    Wake();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (auto* links : {&sockets_, &mqtt_, &http_}) {
+        for (auto& [id, link] : *links) {
+            CloseLink(link);
+        }
+    }
+    close(wake_pipe_[0]);
+    close(wake_pipe_[1]);
+}
+
+bool AtModemSimulator::Open(int baud_rate, size_t rx_buffer_size, size_t tx_buffer_size, AtTransportEventCallback callback) {
+    if (thread_.joinable()) {
+        return true;
+    }
+    if (wake_pipe_[0] < 0) {
+        ESP_LOGE(TAG, "Failed to create wake pipe");
+        return false;
+    }
+    callback_ = std::move(callback);
+    thread_ = std::thread([this]() { Run(); });
+    return true;
+}
+
+size_t AtModemSimulator::Available() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rx_pending_.size() - rx_offset_;
+}
+
+int AtModemSimulator::Read(char* buffer, size_t length) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    length = std::min(length, rx_pending_.size() - rx_offset_);
+    memcpy(buffer, rx_pending_.data() + rx_offset_, length);
+    rx_offset_ += length;
+    if (rx_offset_ == rx_pending_.size()) {
+        rx_pending_.clear();
+        rx_offset_ = 0;
+    }
+    return length;
+}
+
+void AtModemSimulator::DropRxBytes(size_t length) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rx_drop_ = length;
+}
+
+void AtModemSimulator::SetResponseDelay(uint32_t delay_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_.response_delay_ms = delay_ms;
+}
+
+void AtModemSimulator::InjectUrc(const std::string& line) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        EmitUrc(line);
+    }
+    Wake();
+}
+
+int AtModemSimulator::command_count(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = command_counts_.find(name);
+    return it == command_counts_.end() ? 0 : it->second;
+}
+
+int AtModemSimulator::Write(const char* data, size_t length) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        input_.append(data, length);
+        while (ProcessInput()) {}
+    }
+    Wake();
+    return length;
+}
+
+void AtModemSimulator::Wake() {
+    char byte = 0;
+    (void)write(wake_pipe_[1], &byte, 1);
+}
+
+// 工作线程: 等待 socket 事件和最近的定时动作
+void AtModemSimulator::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<pollfd> fds;
+    while (!stopping_) {
+        fds.clear();
+        fds.push_back({wake_pipe_[0], POLLIN, 0});
+        for (auto* links : {&sockets_, &mqtt_, &http_}) {
+            for (auto& [id, link] : *links) {
+                if (link.fd >= 0) {
+                    short events = POLLIN;
+                    if (link.connecting || !link.tx_pending.empty()) {
+                        events |= POLLOUT;
+                    }
+                    fds.push_back({link.fd, events, 0});
+                }
+            }
+        }
+
+        int timeout_ms = 100;
+        if (!timers_.empty()) {
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(timers_.begin()->first - Clock::now()).count();
+            timeout_ms = (int)std::clamp<int64_t>(wait, 0, timeout_ms);
+        }
+
+        lock.unlock();
+        poll(fds.data(), fds.size(), timeout_ms);
+        lock.lock();
+
+        if (fds[0].revents & POLLIN) {
+            char buffer[64];
+            while (read(wake_pipe_[0], buffer, sizeof(buffer)) > 0) {}
+        }
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            // 之前的回调可能已关闭该连接，按 fd 重新查找
+            Link* link = FindLink(fds[i].fd);
+            if (link != nullptr) {
+                HandleLinkEvent(*link, fds[i].revents);
+            }
+        }
+        RunTimers();
+        KeepAlive();
+
+        if (notify_) {
+            notify_ = false;
+            bool overflow = overflow_;
+            overflow_ = false;
+            lock.unlock();
+            if (callback_) {
+                if (overflow) {
+                    callback_(AtTransportEvent::FifoOverflow);
+                }
+                callback_(AtTransportEvent::DataAvailable);
+            }
+            lock.lock();
+        }
+    }
+}
+
+void AtModemSimulator::RunTimers() {
+    auto now = Clock::now();
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+        auto action = std::move(timers_.begin()->second);
+        timers_.erase(timers_.begin());
+        action();
+    }
+}
+
+void AtModemSimulator::KeepAlive() {
+    auto now = Clock::now();
+    for (auto& [id, link] : mqtt_) {
+        if (link.connected && link.keep_alive > 0 && now - link.last_tx >= std::chrono::seconds(link.keep_alive) / 2) {
+            Uplink(link, MqttPacket(MQTT_PINGREQ, ""));
+        }
+    }
+}
+
+AtModemSimulator::Link* AtModemSimulator::FindLink(int fd) {
+    for (auto* links : {&sockets_, &mqtt_, &http_}) {
+        for (auto& [id, link] : *links) {
+            if (link.fd == fd) {
+                return &link;
+            }
+        }
+    }
+    return nullptr;
+}
+
+AtModemSimulator::Link* AtModemSimulator::FindLinkBySerial(uint32_t serial) {
+    for (auto* links : {&sockets_, &mqtt_, &http_}) {
+        for (auto& [id, link] : *links) {
+            if (link.serial == serial) {
+                return &link;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void AtModemSimulator::HandleLinkEvent(Link& link, short revents) {
+    if (link.connecting) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(link.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        link.connecting = false;
+        bool success = error == 0;
+        if (!success) {
+            CloseLink(link);
+        }
+        // 建连按一个往返计
+        uint32_t serial = link.serial;
+        After(config_.network_latency_ms * 2, [this, serial, success]() {
+            Link* link = FindLinkBySerial(serial);
+            if (link != nullptr) {
+                link->connected = success;
+                link->on_connect(*link, success);
+            }
+        });
+        return;
+    }
+    if (revents & POLLOUT) {
+        FlushLink(link);
+    }
+    if (revents & (POLLIN | POLLHUP | POLLERR)) {
+        char buffer[4096];
+        ssize_t received = recv(link.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            std::string data(buffer, received);
+            uint32_t serial = link.serial;
+            Downlink(received, [this, serial, data = std::move(data)]() {
+                Link* link = FindLinkBySerial(serial);
+                if (link != nullptr) {
+                    link->on_data(*link, data);
+                }
+            });
+        } else if (!link.udp && (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))) {
+            // 对端关闭也要排在之前收到的数据之后上报
+            CloseLink(link);
+            uint32_t serial = link.serial;
+            Downlink(0, [this, serial]() {
+                Link* link = FindLinkBySerial(serial);
+                if (link != nullptr) {
+                    link->connected = false;
+                    link->on_close(*link);
+                }
+            });
+        }
+    }
+}
+
+/* 命令解析 */
+
+bool AtModemSimulator::ProcessInput() {
+    // 命令以 \r\n 结尾，\n 可能单独到达，不能算进 '>' 之后的数据
+    if (skip_lf_ && !input_.empty()) {
+        if (input_[0] == '\n') {
+            input_.erase(0, 1);
+        }
+        skip_lf_ = false;
+    }
+    if (data_expected_ > 0) {
+        if (input_.size() < data_expected_) {
+            return false;
+        }
+        std::string data = input_.substr(0, data_expected_);
+        input_.erase(0, data_expected_);
+        data_expected_ = 0;
+        auto handler = std::move(data_handler_);
+        data_handler_ = nullptr;
+        std::string reply;
+        FinishReply(reply, handler(data, reply));
+        return true;
+    }
+
+    auto end = input_.find('\r');
+    if (end == std::string::npos) {
+        return false;
+    }
+    std::string line = input_.substr(0, end);
+    input_.erase(0, end + 1);
+    skip_lf_ = true;
+    if (!line.empty()) {
+        ExecuteLine(line);
+    }
+    return true;
+}
+
+// 一行可以用 ';' 串联多条命令: AT+A=1;+B=2，任一条失败即整行失败
+void AtModemSimulator::ExecuteLine(const std::string& line) {
+    if (line.size() < 2 || strncasecmp(line.c_str(), "AT", 2) != 0) {
+        ESP_LOGW(TAG, "Ignored input: %s", line.c_str());
+        return;
+    }
+
+    std::string reply;
+    int result = SIM_RESULT_OK;
+    size_t start = 2;
+    bool quoted = false;
+    for (size_t i = start; i <= line.size() && result == SIM_RESULT_OK; i++) {
+        if (i < line.size() && line[i] == '"') {
+            quoted = !quoted;
+        }
+        if (i == line.size() || (line[i] == ';' && !quoted)) {
+            result = Execute(line.substr(start, i - start), reply);
+            start = i + 1;
+        }
+    }
+    FinishReply(reply, result);
+}
+
+void AtModemSimulator::FinishReply(std::string& reply, int result) {
+    if (result == SIM_RESULT_PROMPT) {
+        reply += "\r\n> ";
+    } else if (result == SIM_RESULT_OK) {
+        AppendLine(reply, "OK");
+    } else if (result == SIM_RESULT_ERROR) {
+        AppendLine(reply, "ERROR");
+    } else {
+        AppendLine(reply, "+CME ERROR: " + std::to_string(result));
+    }
+    Emit(std::move(reply), true);
+}
+
+int AtModemSimulator::ExpectData(size_t length, std::function<int(const std::string& data, std::string& reply)> handler) {
+    if (length == 0) {
+        return SIM_RESULT_ERROR;
+    }
+    data_expected_ = length;
+    data_handler_ = std::move(handler);
+    return SIM_RESULT_PROMPT;
+}
+
+int AtModemSimulator::Execute(const std::string& command, std::string& reply) {
+    // "+NAME=args" / "+NAME?" / "+NAME" / "E0" / ""
+    std::string name;
+    char op = 0;
+    std::vector<std::string> args;
+    if (!command.empty() && command[0] == '+') {
+        auto pos = command.find_first_of("=?", 1);
+        name = command.substr(1, pos == std::string::npos ? std::string::npos : pos - 1);
+        if (pos != std::string::npos) {
+            op = command[pos];
+            if (op == '=' && pos + 1 < command.size() && command[pos + 1] == '?') {
+                op = 't';
+            } else if (op == '=') {
+                args = SplitArguments(std::string_view(command).substr(pos + 1));
+            }
+        }
+    } else {
+        name = command;
+    }
+    command_counts_[name]++;
+
+    int result;
+    if (name.compare(0, 3, "MIP") == 0) {
+        result = ExecuteMip(name, op, args, reply);
+    } else if (name.compare(0, 2, "QI") == 0 && name != "QINDCFG") {
+        result = ExecuteQi(name, op, args, reply);
+    } else if (name.compare(0, 4, "MQTT") == 0) {
+        result = ExecuteMqtt(name, op, args, reply);
+    } else if (name.compare(0, 3, "QMT") == 0) {
+        result = ExecuteQmt(name, op, args, reply);
+    } else if (name.compare(0, 5, "MHTTP") == 0) {
+        result = ExecuteHttp(name, op, args, reply);
+    } else {
+        result = ExecuteBasic(name, op, args, reply);
+    }
+    if (result == SIM_CME_UNKNOWN) {
+        ESP_LOGW(TAG, "Unsupported command: AT%s", command.c_str());
+    }
+    return result;
+}
+
+int AtModemSimulator::ExecuteBasic(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply) {
+    if (name.empty() || name == "E0" || name == "E1") {
+        return SIM_RESULT_OK;
+    } else if (name == "CGMR") {
+        AppendLine(reply, config_.revision);
+    } else if (name == "CGSN") {
+        AppendLine(reply, op == '=' ? "+CGSN: \"" + config_.imei + "\"" : config_.imei);
+    } else if (name == "ICCID" || name == "QCCID" || name == "CCID") {
+        AppendLine(reply, "+" + name + ": " + config_.iccid);
+    } else if (name == "CPIN" && op == '?') {
+        AppendLine(reply, "+CPIN: READY");
+    } else if (name == "CEREG") {
+        if (op == '=') {
+            cereg_mode_ = ToInt(args, 0);
+        } else if (op == '?') {
+            AppendLine(reply, "+CEREG: " + std::to_string(cereg_mode_) + (cereg_mode_ >= 2 ? ",1,\"1A2B\",\"0C3D4E5F\",7" : ",1"));
+        }
+    } else if (name == "CSQ") {
+        AppendLine(reply, "+CSQ: " + std::to_string(config_.csq) + ",99");
+    } else if (name == "COPS" && op == '?') {
+        AppendLine(reply, "+COPS: 0,0,\"" + config_.carrier + "\",7");
+    } else if (name == "QINDCFG") {
+        // 打开 csq 上报后立即上报一次当前值
+        if (op == '=' && args.size() >= 2 && args[0] == "csq" && ToInt(args, 1) == 1) {
+            After(0, [this]() {
+                EmitUrc("+QIND: \"csq\"," + std::to_string(config_.csq) + ",99");
+            });
+        }
+    } else if (name == "CFUN" || name == "IPR" || name == "IFC" || name == "CGDCONT" ||
+               name == "MLPMCFG" || name == "MREBOOT" || name == "QURCCFG" || name == "QSCLK" || name == "QSCLKEX" ||
+               name == "QSSLCFG") {
+        // 只影响真实模组的供电/串口/安全配置，模拟器接受即可
+    } else {
+        return SIM_CME_UNKNOWN;
+    }
+    return SIM_RESULT_OK;
+}
+
+/* 输出与时序 */
+
+// 模组发往主机的字节，按串口波特率排队
+void AtModemSimulator::Emit(std::string bytes, bool response) {
+    auto release = Clock::now();
+    if (response) {
+        release += std::chrono::milliseconds(config_.response_delay_ms);
+    }
+    release = std::max(release, uart_free_);
+    if (config_.uart_baud_rate > 0) {
+        uart_free_ = release + std::chrono::microseconds((uint64_t)bytes.size() * 10 * 1000000 / config_.uart_baud_rate);
+    } else {
+        uart_free_ = release;
+    }
+    timers_.emplace(release, [this, bytes = std::move(bytes)]() {
+        size_t drop = std::min(rx_drop_, bytes.size());
+        if (drop > 0) {
+            rx_drop_ -= drop;
+            overflow_ = true;
+        }
+        rx_pending_.append(bytes, drop, std::string::npos);
+        notify_ = true;
+    });
+}
+
+void AtModemSimulator::EmitUrc(const std::string& line) {
+    std::string bytes;
+    AppendLine(bytes, line);
+    Emit(std::move(bytes));
+}
+
+void AtModemSimulator::After(uint32_t delay_ms, std::function<void()> action) {
+    timers_.emplace(Clock::now() + std::chrono::milliseconds(delay_ms), std::move(action));
+}
+
+// 网络下行: 时延 + 带宽，按到达顺序排队
+void AtModemSimulator::Downlink(size_t length, std::function<void()> action) {
+    auto release = std::max(Clock::now() + std::chrono::milliseconds(config_.network_latency_ms), downlink_free_);
+    if (config_.network_bandwidth_bps > 0) {
+        release += std::chrono::microseconds((uint64_t)length * 8 * 1000000 / config_.network_bandwidth_bps);
+    }
+    downlink_free_ = release;
+    downlink_bytes_ += length;
+    timers_.emplace(release, std::move(action));
+}
+
+// 网络上行，到期后才真正写入 socket
+void AtModemSimulator::Uplink(Link& link, std::string data) {
+    link.last_tx = Clock::now();
+    auto release = std::max(Clock::now() + std::chrono::milliseconds(config_.network_latency_ms), uplink_free_);
+    if (config_.network_bandwidth_bps > 0) {
+        release += std::chrono::microseconds((uint64_t)data.size() * 8 * 1000000 / config_.network_bandwidth_bps);
+    }
+    uplink_free_ = release;
+    uplink_bytes_ += data.size();
+    uint32_t serial = link.serial;
+    timers_.emplace(release, [this, serial, data = std::move(data)]() {
+        Link* link = FindLinkBySerial(serial);
+        if (link != nullptr && link->fd >= 0) {
+            Transmit(*link, data);
+        }
+    });
+}
+
+/* 连接 */
+
+bool AtModemSimulator::OpenLink(Link& link) {
+    link.serial = next_serial_++;
+    link.connected = false;
+    link.tx_pending.clear();
+    link.rx.clear();
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = link.udp ? SOCK_DGRAM : SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(link.host.c_str(), std::to_string(link.port).c_str(), &hints, &result) != 0 || result == nullptr) {
+        ESP_LOGW(TAG, "Failed to resolve %s", link.host.c_str());
+        return false;
+    }
+    link.fd = socket(result->ai_family, result->ai_socktype, 0);
+    if (link.fd < 0) {
+        freeaddrinfo(result);
+        return false;
+    }
+    fcntl(link.fd, F_SETFL, O_NONBLOCK);
+    int ret = connect(link.fd, result->ai_addr, result->ai_addrlen);
+    freeaddrinfo(result);
+    if (ret != 0 && errno != EINPROGRESS) {
+        CloseLink(link);
+        return false;
+    }
+    // UDP 或立即连上的 TCP 也走一次轮询，结果总在命令的 OK 之后上报
+    link.connecting = true;
+    Wake();
+    return true;
+}
+
+void AtModemSimulator::CloseLink(Link& link) {
+    if (link.fd >= 0) {
+        close(link.fd);
+        link.fd = -1;
+    }
+    link.connecting = false;
+    link.tx_pending.clear();
+}
+
+void AtModemSimulator::Transmit(Link& link, const std::string& data) {
+    link.tx_pending += data;
+    FlushLink(link);
+    if (!link.tx_pending.empty()) {
+        Wake();
+    }
+}
+
+void AtModemSimulator::FlushLink(Link& link) {
+    while (!link.tx_pending.empty()) {
+        ssize_t sent = send(link.fd, link.tx_pending.data(), link.tx_pending.size(), MSG_NOSIGNAL);
+        if (sent <= 0) {
+            break;
+        }
+        link.tx_pending.erase(0, sent);
+    }
+}
+
+/* ML307 / EC801E socket */
+
+void AtModemSimulator::OpenSocket(Link& link) {
+    bool quectel = link.type == LinkType::Qi;
+    std::string prefix = quectel ? "+QIOPEN: " : "+MIPOPEN: ";
+    int id = link.id;
+
+    link.on_connect = [this, prefix, quectel](Link& link, bool success) {
+        EmitUrc(prefix + std::to_string(link.id) + "," + (success ? "0" : (quectel ? "566" : "1")));
+        if (!success) {
+            ReleaseSocket(link);
+        }
+    };
+    link.on_data = [this](Link& link, std::string data) {
+        for (size_t offset = 0; offset < data.size(); offset += SIM_SOCKET_CHUNK) {
+            std::string chunk = data.substr(offset, SIM_SOCKET_CHUNK);
+            std::string length = std::to_string(chunk.size());
+            if (link.type == LinkType::Qi) {
+                EmitUrc("+QIURC: \"recv\"," + std::to_string(link.id) + "," + length + "," + EncodeHex(chunk));
+            } else if (link.raw) {
+                // 原始数据按长度切帧，其中可以有 \r\n
+                EmitUrc("+MIPURC: \"" + std::string(link.udp ? "rudp" : "rtcp") + "\"," + std::to_string(link.id) + "," + length + "," + chunk);
+            } else {
+                EmitUrc("+MIPURC: \"" + std::string(link.udp ? "rudp" : "rtcp") + "\"," + std::to_string(link.id) + "," + length + "," + EncodeHex(chunk));
+            }
+        }
+    };
+    link.on_close = [this](Link& link) {
+        if (link.type == LinkType::Qi) {
+            // EC801E 保留连接，等主机 QICLOSE
+            EmitUrc("+QIURC: \"closed\"," + std::to_string(link.id));
+        } else {
+            EmitUrc("+MIPURC: \"disconn\"," + std::to_string(link.id) + ",1");
+            ReleaseSocket(link);
+        }
+    };
+
+    if (!OpenLink(link)) {
+        uint32_t serial = link.serial;
+        After(0, [this, prefix, id, serial, quectel]() {
+            EmitUrc(prefix + std::to_string(id) + "," + (quectel ? "565" : "1"));
+            auto it = sockets_.find(id);
+            if (it != sockets_.end() && it->second.serial == serial) {
+                sockets_.erase(it);
+            }
+        });
+    }
+}
+
+// 连接失败或被对端关闭后释放连接号。调用方可能正处于该连接的回调中，延后再删
+void AtModemSimulator::ReleaseSocket(Link& link) {
+    int id = link.id;
+    uint32_t serial = link.serial;
+    After(0, [this, id, serial]() {
+        auto it = sockets_.find(id);
+        if (it != sockets_.end() && it->second.serial == serial) {
+            sockets_.erase(it);
+        }
+    });
+}
+
+int AtModemSimulator::ExecuteMip(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply) {
+    int id = ToInt(args, name == "MIPCFG" ? 1 : 0, -1);
+
+    if (name == "MIPCALL") {
+        if (op == '?') {
+            AppendLine(reply, "+MIPCALL: 1,1,\"10.0.0.2\"");
+        }
+        return SIM_RESULT_OK;
+    } else if (name == "MIPCFG") {
+        if (args.size() >= 3 && args[0] == "encoding") {
+            mip_raw_[id] = ToInt(args, 3) == 0;
+        } else if (args.size() >= 3 && args[0] == "ssl" && ToInt(args, 2) != 0) {
+            ESP_LOGW(TAG, "SSL is not supported");
+            return SIM_CME_NOT_ALLOWED;
+        }
+        return SIM_RESULT_OK;
+    } else if (name == "MIPSTATE") {
+        auto it = sockets_.find(id);
+        if (it == sockets_.end() || it->second.type != LinkType::Mip) {
+            AppendLine(reply, "+MIPSTATE: " + std::to_string(id) + ",\"\",\"\",0,\"INITIAL\"");
+        } else {
+            auto& link = it->second;
+            AppendLine(reply, "+MIPSTATE: " + std::to_string(id) + ",\"" + (link.udp ? "UDP" : "TCP") + "\",\"" + link.host + "\"," +
+                std::to_string(link.port) + ",\"" + (link.connected ? "CONNECTED" : "CONNECTING") + "\"");
+        }
+        return SIM_RESULT_OK;
+    } else if (name == "MIPOPEN" && args.size() >= 4) {
+        if (sockets_.count(id)) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        auto& link = sockets_[id];
+        link.type = LinkType::Mip;
+        link.id = id;
+        link.udp = args[1] == "UDP";
+        link.host = args[2];
+        link.port = ToInt(args, 3);
+        link.raw = mip_raw_[id];
+        OpenSocket(link);
+        return SIM_RESULT_OK;
+    } else if (name == "MIPSEND" && args.size() >= 2) {
+        auto it = sockets_.find(id);
+        if (it == sockets_.end() || !it->second.connected) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        return ExpectData(ToInt(args, 1), [this, id](const std::string& data, std::string& reply) {
+            auto it = sockets_.find(id);
+            if (it == sockets_.end()) {
+                return SIM_CME_NOT_ALLOWED;
+            }
+            Uplink(it->second, data);
+            After(0, [this, id, length = data.size()]() {
+                EmitUrc("+MIPSEND: " + std::to_string(id) + "," + std::to_string(length));
+            });
+            return SIM_RESULT_OK;
+        });
+    } else if (name == "MIPCLOSE") {
+        auto it = sockets_.find(id);
+        if (it == sockets_.end()) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        CloseLink(it->second);
+        sockets_.erase(it);
+        After(0, [this, id]() { EmitUrc("+MIPCLOSE: " + std::to_string(id)); });
+        return SIM_RESULT_OK;
+    }
+    return SIM_CME_UNKNOWN;
+}
+
+int AtModemSimulator::ExecuteQi(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply) {
+    if (name == "QICFG") {
+        return SIM_RESULT_OK;
+    } else if (name == "QISTATE") {
+        // AT+QISTATE=1,<connectID>
+        int id = ToInt(args, 1, -1);
+        auto it = sockets_.find(id);
+        if (it != sockets_.end() && it->second.type == LinkType::Qi) {
+            auto& link = it->second;
+            int state = link.connected ? 2 : (link.fd >= 0 ? 1 : 4);
+            AppendLine(reply, "+QISTATE: " + std::to_string(id) + ",\"" + (link.udp ? "UDP" : "TCP") + "\",\"" + link.host + "\"," +
+                std::to_string(link.port) + ",0," + std::to_string(state) + ",1,0,0,\"uart1\"");
+        }
+        return SIM_RESULT_OK;
+    } else if (name == "QIOPEN" && args.size() >= 5) {
+        // AT+QIOPEN=<contextID>,<connectID>,"TCP","host",port,0,<access_mode>
+        int id = ToInt(args, 1);
+        if (sockets_.count(id)) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        auto& link = sockets_[id];
+        link.type = LinkType::Qi;
+        link.id = id;
+        link.udp = args[2] == "UDP";
+        link.host = args[3];
+        link.port = ToInt(args, 4);
+        OpenSocket(link);
+        return SIM_RESULT_OK;
+    } else if (name == "QISEND" && args.size() >= 2) {
+        int id = ToInt(args, 0);
+        auto it = sockets_.find(id);
+        if (it == sockets_.end() || !it->second.connected) {
+            return SIM_RESULT_ERROR;
+        }
+        return ExpectData(ToInt(args, 1), [this, id](const std::string& data, std::string& reply) {
+            auto it = sockets_.find(id);
+            if (it == sockets_.end()) {
+                return SIM_RESULT_ERROR;
+            }
+            Uplink(it->second, data);
+            After(0, [this, id, length = data.size()]() {
+                EmitUrc("+QISEND: " + std::to_string(id) + ",0," + std::to_string(length));
+            });
+            return SIM_RESULT_OK;
+        });
+    } else if (name == "QICLOSE") {
+        int id = ToInt(args, 0);
+        auto it = sockets_.find(id);
+        if (it != sockets_.end()) {
+            CloseLink(it->second);
+            sockets_.erase(it);
+        }
+        return SIM_RESULT_OK;
+    }
+    return SIM_CME_UNKNOWN;
+}
+
+/* MQTT: ML307 的 MQTT* 和 EC801E 的 QMT* 共用同一个最小 MQTT 3.1.1 客户端 */
+
+void AtModemSimulator::MqttConnect(Link& link) {
+    std::string body = MqttString("MQTT");
+    uint8_t flags = link.clean_session ? 0x02 : 0x00;
+    if (!link.username.empty()) {
+        flags |= 0x80;
+    }
+    if (!link.password.empty()) {
+        flags |= 0x40;
+    }
+    body += (char)4;
+    body += (char)flags;
+    body += (char)(link.keep_alive >> 8);
+    body += (char)(link.keep_alive & 0xFF);
+    body += MqttString(link.client_id);
+    if (!link.username.empty()) {
+        body += MqttString(link.username);
+    }
+    if (!link.password.empty()) {
+        body += MqttString(link.password);
+    }
+    Uplink(link, MqttPacket(MQTT_CONNECT, body));
+}
+
+void AtModemSimulator::OpenMqtt(Link& link) {
+    int id = link.id;
+    link.on_connect = [this](Link& link, bool success) {
+        if (!success) {
+            MqttUrcConnect(link, -1);
+        } else if (link.type == LinkType::Qmt) {
+            // EC801E 的 QMTOPEN 只建 TCP，等 QMTCONN 给出客户端参数后才发 CONNECT
+            link.connected = false;
+            EmitUrc("+QMTOPEN: " + std::to_string(link.id) + ",0");
+        } else {
+            MqttConnect(link);
+        }
+    };
+    link.on_data = [this](Link& link, std::string data) {
+        link.rx += data;
+        uint8_t type;
+        std::string body;
+        uint32_t serial = link.serial;
+        while (TakeMqttPacket(link.rx, type, body)) {
+            HandleMqttPacket(link, type, body);
+            // 处理过程中连接可能被关闭
+            if (FindLinkBySerial(serial) == nullptr || link.fd < 0) {
+                break;
+            }
+        }
+    };
+    link.on_close = [this](Link& link) {
+        MqttUrcClosed(link);
+    };
+    if (!OpenLink(link)) {
+        After(0, [this, id]() {
+            auto it = mqtt_.find(id);
+            if (it != mqtt_.end()) {
+                MqttUrcConnect(it->second, -2);
+            }
+        });
+    }
+}
+
+// code: CONNACK 返回码，-1 连接失败，-2 域名解析失败
+void AtModemSimulator::MqttUrcConnect(Link& link, int code) {
+    std::string id = std::to_string(link.id);
+    link.connected = code == 0;
+    if (code != 0) {
+        CloseLink(link);
+    }
+    if (link.type == LinkType::Qmt) {
+        if (code < 0) {
+            EmitUrc("+QMTOPEN: " + id + "," + (code == -2 ? "4" : "5"));
+        } else {
+            EmitUrc("+QMTCONN: " + id + ",0," + std::to_string(code));
+        }
+    } else {
+        // ML307: 0 已连接，3 被拒绝，6 网络错误
+        EmitUrc("+MQTTURC: \"conn\"," + id + "," + (code == 0 ? "0" : (code > 0 ? "3" : "6")));
+    }
+}
+
+void AtModemSimulator::MqttUrcClosed(Link& link) {
+    std::string id = std::to_string(link.id);
+    CloseLink(link);
+    link.connected = false;
+    if (link.type == LinkType::Qmt) {
+        EmitUrc("+QMTSTAT: " + id + ",1");
+    } else {
+        EmitUrc("+MQTTURC: \"conn\"," + id + ",4");
+    }
+}
+
+void AtModemSimulator::HandleMqttPacket(Link& link, uint8_t type, const std::string& body) {
+    std::string id = std::to_string(link.id);
+    switch (type & 0xF0) {
+    case MQTT_CONNACK:
+        // EC801E 在 QMTOPEN 时只建 TCP，CONNACK 对应 QMTCONN 的结果
+        MqttUrcConnect(link, body.size() >= 2 ? (uint8_t)body[1] : 255);
+        break;
+    case MQTT_PUBLISH: {
+        int qos = (type >> 1) & 0x03;
+        if (body.size() < 2) {
+            break;
+        }
+        size_t topic_length = ((uint8_t)body[0] << 8) | (uint8_t)body[1];
+        size_t offset = 2 + topic_length;
+        std::string topic = body.substr(2, topic_length);
+        uint16_t packet_id = 0;
+        if (qos > 0 && body.size() >= offset + 2) {
+            packet_id = ((uint8_t)body[offset] << 8) | (uint8_t)body[offset + 1];
+            offset += 2;
+            std::string ack;
+            ack += (char)(packet_id >> 8);
+            ack += (char)(packet_id & 0xFF);
+            Uplink(link, MqttPacket(MQTT_PUBACK, ack));
+        }
+        std::string payload = offset < body.size() ? body.substr(offset) : std::string();
+        if (link.type == LinkType::Qmt) {
+            EmitUrc("+QMTRECV: " + id + "," + std::to_string(packet_id) + ",\"" + topic + "\"," + EncodeHex(payload));
+        } else {
+            // 长消息分包，每包带总长度和本包长度
+            std::string total = std::to_string(payload.size());
+            size_t offset = 0;
+            do {
+                std::string chunk = payload.substr(offset, SIM_URC_CHUNK);
+                EmitUrc("+MQTTURC: \"publish\"," + id + "," + std::to_string(packet_id) + ",\"" + topic + "\"," + total + "," +
+                    std::to_string(chunk.size()) + "," + EncodeHex(chunk));
+                offset += chunk.size();
+            } while (offset < payload.size());
+        }
+        break;
+    }
+    case MQTT_SUBACK:
+        if (body.size() >= 3) {
+            std::string packet_id = std::to_string(((uint8_t)body[0] << 8) | (uint8_t)body[1]);
+            std::string code = std::to_string((uint8_t)body[2]);
+            if (link.type == LinkType::Qmt) {
+                EmitUrc("+QMTSUB: " + id + "," + packet_id + ",0," + code);
+            } else {
+                EmitUrc("+MQTTURC: \"suback\"," + id + "," + packet_id + "," + code);
+            }
+        }
+        break;
+    default:
+        // PUBACK、UNSUBACK、PINGRESP 不需要上报
+        break;
+    }
+}
+
+void AtModemSimulator::MqttPublish(Link& link, const std::string& topic, int qos, const std::string& payload) {
+    std::string body = MqttString(topic);
+    if (qos > 0) {
+        uint16_t packet_id = link.next_packet_id++;
+        body += (char)(packet_id >> 8);
+        body += (char)(packet_id & 0xFF);
+    }
+    body += payload;
+    Uplink(link, MqttPacket(MQTT_PUBLISH | (qos << 1), body));
+}
+
+static std::string MqttSubscribe(uint16_t packet_id, const std::string& topic, int qos, bool subscribe) {
+    std::string body;
+    body += (char)(packet_id >> 8);
+    body += (char)(packet_id & 0xFF);
+    body += MqttString(topic);
+    if (subscribe) {
+        body += (char)qos;
+    }
+    return MqttPacket(subscribe ? MQTT_SUBSCRIBE : MQTT_UNSUBSCRIBE, body);
+}
+
+int AtModemSimulator::ExecuteMqtt(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply) {
+    int id = ToInt(args, name == "MQTTCFG" ? 1 : 0, -1);
+    if (name == "MQTTSTATE") {
+        auto it = mqtt_.find(id);
+        AppendLine(reply, std::string("+MQTTSTATE: ") + (it != mqtt_.end() && it->second.connected ? "2" : "3"));
+        return SIM_RESULT_OK;
+    }
+
+    auto& link = mqtt_[id];
+    link.type = LinkType::Mqtt;
+    link.id = id;
+    if (name == "MQTTCFG" && args.size() >= 3) {
+        if (args[0] == "ssl" && ToInt(args, 2) != 0) {
+            ESP_LOGW(TAG, "SSL is not supported");
+            return SIM_CME_NOT_ALLOWED;
+        } else if (args[0] == "clean") {
+            link.clean_session = ToInt(args, 2) != 0;
+        } else if (args[0] == "keepalive") {
+            link.keep_alive = ToInt(args, 2);
+        }
+        return SIM_RESULT_OK;
+    } else if (name == "MQTTCONN" && args.size() >= 4) {
+        // AT+MQTTCONN=<id>,"host",port,"client_id","username","password"
+        if (link.fd >= 0) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        link.host = args[1];
+        link.port = ToInt(args, 2);
+        link.client_id = args[3];
+        link.username = args.size() > 4 ? args[4] : "";
+        link.password = args.size() > 5 ? args[5] : "";
+        OpenMqtt(link);
+        return SIM_RESULT_OK;
+    } else if (name == "MQTTSUB" && args.size() >= 3) {
+        if (!link.connected) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        Uplink(link, MqttSubscribe(link.next_packet_id++, args[1], ToInt(args, 2), true));
+        return SIM_RESULT_OK;
+    } else if (name == "MQTTUNSUB" && args.size() >= 2) {
+        if (!link.connected) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        Uplink(link, MqttSubscribe(link.next_packet_id++, args[1], 0, false));
+        return SIM_RESULT_OK;
+    } else if (name == "MQTTPUB" && args.size() >= 6) {
+        // AT+MQTTPUB=<id>,"topic",qos,retain,dup,<length>
+        if (!link.connected) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        std::string topic = args[1];
+        int qos = ToInt(args, 2);
+        return ExpectData(ToInt(args, 5), [this, id, topic, qos](const std::string& data, std::string& reply) {
+            auto it = mqtt_.find(id);
+            if (it == mqtt_.end() || !it->second.connected) {
+                return SIM_CME_NOT_ALLOWED;
+            }
+            MqttPublish(it->second, topic, qos, data);
+            return SIM_RESULT_OK;
+        });
+    } else if (name == "MQTTDISC") {
+        if (link.connected) {
+            Uplink(link, MqttPacket(MQTT_DISCONNECT, ""));
+        }
+        // DISCONNECT 发出后再关闭 socket
+        uint32_t serial = link.serial;
+        link.connected = false;
+        After(config_.network_latency_ms, [this, id, serial]() {
+            auto it = mqtt_.find(id);
+            if (it != mqtt_.end() && it->second.serial == serial) {
+                CloseLink(it->second);
+                EmitUrc("+MQTTURC: \"conn\"," + std::to_string(id) + ",2");
+            }
+        });
+        return SIM_RESULT_OK;
+    }
+    return SIM_CME_UNKNOWN;
+}
+
+int AtModemSimulator::ExecuteQmt(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply) {
+    int id = ToInt(args, name == "QMTCFG" ? 1 : 0, -1);
+    auto& link = mqtt_[id];
+    link.type = LinkType::Qmt;
+    link.id = id;
+
+    if (name == "QMTCFG" && args.size() >= 3) {
+        if (args[0] == "ssl" && ToInt(args, 2) != 0) {
+            ESP_LOGW(TAG, "SSL is not supported");
+            return SIM_CME_NOT_ALLOWED;
+        } else if (args[0] == "session") {
+            link.clean_session = ToInt(args, 2) != 0;
+        } else if (args[0] == "keepalive") {
+            link.keep_alive = ToInt(args, 2);
+        }
+        return SIM_RESULT_OK;
+    } else if (name == "QMTOPEN" && args.size() >= 3) {
+        // AT+QMTOPEN=<id>,"host",port，只建立 TCP 连接
+        if (link.fd >= 0) {
+            After(0, [this, id]() { EmitUrc("+QMTOPEN: " + std::to_string(id) + ",2"); });
+            return SIM_RESULT_OK;
+        }
+        link.host = args[1];
+        link.port = ToInt(args, 2);
+        OpenMqtt(link);
+        return SIM_RESULT_OK;
+    } else if (name == "QMTCONN" && args.size() >= 2) {
+        // AT+QMTCONN=<id>,"client_id","username","password"
+        if (link.fd < 0 || link.connecting) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        link.client_id = args[1];
+        link.username = args.size() > 2 ? args[2] : "";
+        link.password = args.size() > 3 ? args[3] : "";
+        After(0, [this, id]() {
+            auto it = mqtt_.find(id);
+            if (it != mqtt_.end() && it->second.fd >= 0) {
+                MqttConnect(it->second);
+            }
+        });
+        return SIM_RESULT_OK;
+    } else if (name == "QMTSUB" && args.size() >= 4) {
+        // AT+QMTSUB=<id>,<msgid>,"topic",qos
+        if (!link.connected) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        Uplink(link, MqttSubscribe(ToInt(args, 1, 1), args[2], ToInt(args, 3), true));
+        return SIM_RESULT_OK;
+    } else if (name == "QMTUNS" && args.size() >= 3) {
+        if (!link.connected) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        Uplink(link, MqttSubscribe(ToInt(args, 1, 1), args[2], 0, false));
+        return SIM_RESULT_OK;
+    } else if (name == "QMTPUBEX" && args.size() >= 6) {
+        // AT+QMTPUBEX=<id>,<msgid>,qos,retain,"topic",<length>
+        if (!link.connected) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        int message_id = ToInt(args, 1);
+        int qos = ToInt(args, 2);
+        std::string topic = args[4];
+        return ExpectData(ToInt(args, 5), [this, id, message_id, topic, qos](const std::string& data, std::string& reply) {
+            auto it = mqtt_.find(id);
+            if (it == mqtt_.end() || !it->second.connected) {
+                return SIM_CME_NOT_ALLOWED;
+            }
+            MqttPublish(it->second, topic, qos, data);
+            After(0, [this, id, message_id]() {
+                EmitUrc("+QMTPUBEX: " + std::to_string(id) + "," + std::to_string(message_id) + ",0");
+            });
+            return SIM_RESULT_OK;
+        });
+    } else if (name == "QMTDISC") {
+        if (link.connected) {
+            Uplink(link, MqttPacket(MQTT_DISCONNECT, ""));
+        }
+        uint32_t serial = link.serial;
+        link.connected = false;
+        After(config_.network_latency_ms, [this, id, serial]() {
+            auto it = mqtt_.find(id);
+            if (it != mqtt_.end() && it->second.serial == serial) {
+                CloseLink(it->second);
+                EmitUrc("+QMTDISC: " + std::to_string(id) + ",0");
+            }
+        });
+        return SIM_RESULT_OK;
+    }
+    return SIM_CME_UNKNOWN;
+}
+
+/* ML307 HTTP: 请求以 HTTP/1.0 发出，服务器不会用 chunked 应答，按长度或连接关闭判断结束 */
+
+int AtModemSimulator::ExecuteHttp(const std::string& name, char op, const std::vector<std::string>& args, std::string& reply) {
+    if (name == "MHTTPCREATE" && args.size() >= 1) {
+        // AT+MHTTPCREATE="http://host[:port]"
+        int id = 0;
+        while (id < SIM_HTTP_MAX_INSTANCES && http_.count(id)) {
+            id++;
+        }
+        if (id == SIM_HTTP_MAX_INSTANCES) {
+            return SIM_CME_NOT_ALLOWED;
+        }
+        const std::string& url = args[0];
+        auto scheme_end = url.find("://");
+        if (scheme_end == std::string::npos) {
+            return SIM_RESULT_ERROR;
+        }
+        auto& link = http_[id];
+        link.type = LinkType::Http;
+        link.id = id;
+        link.ssl = url.compare(0, scheme_end, "https") == 0;
+        std::string host = url.substr(scheme_end + 3);
+        host = host.substr(0, host.find('/'));
+        auto colon = host.find(':');
+        link.port = colon != std::string::npos ? atoi(host.c_str() + colon + 1) : (link.ssl ? 443 : 80);
+        link.host = host.substr(0, colon);
+        AppendLine(reply, "+MHTTPCREATE: " + std::to_string(id));
+        return SIM_RESULT_OK;
+    }
+
+    int id = ToInt(args, name == "MHTTPCFG" ? 1 : 0, -1);
+    if (name == "MHTTPDEL") {
+        auto it = http_.find(id);
+        if (it != http_.end()) {
+            CloseLink(it->second);
+            http_.erase(it);
+        }
+        return SIM_RESULT_OK;
+    }
+    auto it = http_.find(id);
+    if (it == http_.end()) {
+        return SIM_CME_NOT_ALLOWED;
+    }
+    auto& link = it->second;
+
+    if (name == "MHTTPCFG" && args.size() >= 3) {
+        if (args[0] == "encoding") {
+            link.send_hex = ToInt(args, 2) != 0;
+        } else if (args[0] == "chunked") {
+            link.chunked = ToInt(args, 2) != 0;
+        }
+        return SIM_RESULT_OK;
+    } else if (name == "MHTTPHEADER" && args.size() >= 4) {
+        // AT+MHTTPHEADER=<id>,<more>,<length>,"Key: Value"，值里的逗号被拆开了，重新拼回
+        std::string line = args[3];
+        for (size_t i = 4; i < args.size(); i++) {
+            line += "," + args[i];
+        }
+        link.headers += line + "\r\n";
+        return SIM_RESULT_OK;
+    } else if (name == "MHTTPCONTENT" && args.size() >= 3) {
+        // AT+MHTTPCONTENT=<id>,<more>,<length>[,<data>]，不带 data 时走 '>' 提示符
+        bool more = ToInt(args, 1) != 0;
+        auto append = [this, id, more](const std::string& data) {
+            auto it = http_.find(id);
+            if (it == http_.end()) {
+                return;
+            }
+            it->second.body += data;
+            it->second.body_complete = !more;
+            if (!more && it->second.requested) {
+                // 请求结果排在本条命令的 OK 之后
+                After(0, [this, id]() {
+                    auto it = http_.find(id);
+                    if (it != http_.end()) {
+                        StartHttpRequest(it->second);
+                    }
+                });
+            }
+        };
+        if (args.size() >= 4) {
+            append(link.send_hex ? DecodeHex(args[3]) : args[3]);
+            return SIM_RESULT_OK;
+        }
+        link.body_complete = false;
+        return ExpectData(ToInt(args, 2), [append](const std::string& data, std::string& reply) {
+            append(data);
+            return SIM_RESULT_OK;
+        });
+    } else if (name == "MHTTPREQUEST" && args.size() >= 4) {
+        // AT+MHTTPREQUEST=<id>,<method>,0,<path>
+        static const char* methods[] = {"UNKNOWN", "GET", "POST", "PUT", "DELETE", "HEAD"};
+        int method = ToInt(args, 1, 1);
+        link.method = method > 0 && method < 6 ? methods[method] : "GET";
+        link.path = link.send_hex ? DecodeHex(args[3]) : args[3];
+        link.requested = true;
+        if (link.chunked) {
+            // 分块上传: 通知主机开始写内容，最后一块 (more=0) 到齐后再发请求
+            link.body_complete = false;
+            After(0, [this, id]() { EmitUrc("+MHTTPURC: \"ind\"," + std::to_string(id) + ",1"); });
+        } else {
+            After(0, [this, id]() {
+                auto it = http_.find(id);
+                if (it != http_.end()) {
+                    StartHttpRequest(it->second);
+                }
+            });
+        }
+        return SIM_RESULT_OK;
+    }
+    return SIM_CME_UNKNOWN;
+}
+
+void AtModemSimulator::StartHttpRequest(Link& link) {
+    std::string id = std::to_string(link.id);
+    if (link.ssl) {
+        ESP_LOGW(TAG, "SSL is not supported");
+        EmitUrc("+MHTTPURC: \"err\"," + id + ",4");
+        return;
+    }
+    link.header_received = false;
+    link.content_length = -1;
+    link.received = 0;
+
+    link.on_connect = [this](Link& link, bool success) {
+        if (!success) {
+            EmitUrc("+MHTTPURC: \"err\"," + std::to_string(link.id) + ",2");
+            return;
+        }
+        std::string request = link.method + " " + link.path + " HTTP/1.0\r\n";
+        request += "Host: " + link.host + (link.port != 80 ? ":" + std::to_string(link.port) : "") + "\r\n";
+        request += link.headers;
+        if (!link.body.empty() || link.method == "POST" || link.method == "PUT") {
+            request += "Content-Length: " + std::to_string(link.body.size()) + "\r\n";
+        }
+        request += "\r\n";
+        request += link.body;
+        link.body.clear();
+        Uplink(link, std::move(request));
+    };
+    link.on_data = [this](Link& link, std::string data) {
+        HandleHttpData(link, data);
+    };
+    link.on_close = [this](Link& link) {
+        std::string id = std::to_string(link.id);
+        if (!link.header_received) {
+            EmitUrc("+MHTTPURC: \"err\"," + id + ",5");
+        } else if (link.content_length < 0) {
+            // 没有 Content-Length: 以连接关闭为结束，此时总长度才确定
+            std::string body = std::move(link.rx);
+            link.content_length = body.size();
+            EmitHttpContent(link, body);
+        } else if ((long)link.received < link.content_length) {
+            EmitUrc("+MHTTPURC: \"err\"," + id + ",5");
+        }
+    };
+    if (!OpenLink(link)) {
+        EmitUrc("+MHTTPURC: \"err\"," + id + ",1");
+    }
+}
+
+void AtModemSimulator::HandleHttpData(Link& link, const std::string& data) {
+    link.rx += data;
+    if (!link.header_received) {
+        auto end = link.rx.find("\r\n\r\n");
+        if (end == std::string::npos) {
+            return;
+        }
+        auto status_end = link.rx.find("\r\n");
+        std::string status_line = link.rx.substr(0, status_end);
+        auto space = status_line.find(' ');
+        int status = space != std::string::npos ? atoi(status_line.c_str() + space + 1) : 0;
+        std::string headers = link.rx.substr(status_end + 2, end + 2 - (status_end + 2));
+        link.rx.erase(0, end + 4);
+        link.header_received = true;
+
+        // 按行查找 Content-Length，不区分大小写
+        size_t pos = 0;
+        while (pos < headers.size()) {
+            auto line_end = headers.find("\r\n", pos);
+            std::string line = headers.substr(pos, line_end - pos);
+            if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) {
+                link.content_length = atol(line.c_str() + 15);
+            }
+            pos = line_end == std::string::npos ? headers.size() : line_end + 2;
+        }
+        EmitUrc("+MHTTPURC: \"header\"," + std::to_string(link.id) + "," + std::to_string(status) + "," +
+            std::to_string(headers.size()) + "," + EncodeHex(headers));
+        if (link.content_length == 0) {
+            EmitHttpContent(link, "");
+            CloseLink(link);
+            return;
+        }
+    }
+    if (link.content_length < 0 || link.rx.empty()) {
+        return;
+    }
+    std::string body = std::move(link.rx);
+    link.rx.clear();
+    EmitHttpContent(link, body);
+    if ((long)link.received >= link.content_length) {
+        CloseLink(link);
+    }
+}
+
+// +MHTTPURC: "content",<id>,<content_len>,<sum_len>,<cur_len>,<data>
+void AtModemSimulator::EmitHttpContent(Link& link, const std::string& data) {
+    std::string prefix = "+MHTTPURC: \"content\"," + std::to_string(link.id) + "," + std::to_string(link.content_length) + ",";
+    size_t offset = 0;
+    do {
+        std::string chunk = data.substr(offset, SIM_URC_CHUNK);
+        offset += chunk.size();
+        link.received += chunk.size();
+        EmitUrc(prefix + std::to_string(link.received) + "," + std::to_string(chunk.size()) + "," + EncodeHex(chunk));
+    } while (offset < data.size());
+}
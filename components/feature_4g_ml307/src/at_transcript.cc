@@ -0,0 +1,196 @@
+#include "at_transcript.h"
+#include <esp_log.h>
+#include <cstring>
+#include <algorithm>
+
+#define TAG "AtTranscript"
+
+
+static size_t PutVarint(uint8_t* out, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+static bool GetVarint(FILE* file, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int c = fgetc(file);
+        if (c == EOF) {
+            return false;
+        }
+        value |= (uint32_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+AtTranscriptWriter::AtTranscriptWriter(FILE* file) : file_(file), last_(std::chrono::steady_clock::now()) {
+    const uint8_t header[] = {AT_TRANSCRIPT_MAGIC[0], AT_TRANSCRIPT_MAGIC[1], AT_TRANSCRIPT_MAGIC[2], AT_TRANSCRIPT_VERSION};
+    bytes_written_ = fwrite(header, 1, sizeof(header), file_);
+}
+
+void AtTranscriptWriter::Record(AtTranscriptDirection direction, const char* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - last_).count();
+    last_ = now;
+
+    uint8_t head[10];
+    size_t head_length = PutVarint(head, (uint32_t)std::min<int64_t>(delta, UINT32_MAX));
+    head_length += PutVarint(head + head_length, (uint32_t)(length << 1) | (uint32_t)direction);
+    bytes_written_ += fwrite(head, 1, head_length, file_);
+    bytes_written_ += fwrite(data, 1, length, file_);
+}
+
+void AtTranscriptWriter::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fflush(file_);
+}
+
+bool AtTranscriptReader::Open(FILE* file) {
+    uint8_t header[4];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, AT_TRANSCRIPT_MAGIC, 3) != 0 || header[3] != AT_TRANSCRIPT_VERSION) {
+        ESP_LOGE(TAG, "Invalid transcript header");
+        return false;
+    }
+    file_ = file;
+    return true;
+}
+
+bool AtTranscriptReader::Next(AtTranscriptRecord& record) {
+    uint32_t delta_us, head;
+    if (file_ == nullptr || !GetVarint(file_, delta_us) || !GetVarint(file_, head)) {
+        return false;
+    }
+    record.delta_us = delta_us;
+    record.direction = (head & 1) ? AtTranscriptDirection::Rx : AtTranscriptDirection::Tx;
+    record.data.resize(head >> 1);
+    if (fread(record.data.data(), 1, record.data.size(), file_) != record.data.size()) {
+        ESP_LOGW(TAG, "Transcript truncated");
+        return false;
+    }
+    return true;
+}
+
+AtReplayTransport::AtReplayTransport(std::vector<AtTranscriptRecord> records, double speed, uint32_t tx_timeout_ms)
+    : records_(std::move(records)), speed_(speed), tx_timeout_ms_(tx_timeout_ms) {
+    for (auto& record : records_) {
+        if (record.direction == AtTranscriptDirection::Tx) {
+            expected_tx_ += record.data;
+        }
+    }
+}
+
+AtReplayTransport::~AtReplayTransport() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::unique_ptr<AtReplayTransport> AtReplayTransport::Load(FILE* file, double speed) {
+    AtTranscriptReader reader;
+    if (!reader.Open(file)) {
+        return nullptr;
+    }
+    std::vector<AtTranscriptRecord> records;
+    AtTranscriptRecord record;
+    while (reader.Next(record)) {
+        records.push_back(std::move(record));
+    }
+    ESP_LOGI(TAG, "Loaded %u records", (unsigned)records.size());
+    return std::make_unique<AtReplayTransport>(std::move(records), speed);
+}
+
+bool AtReplayTransport::Open(int baud_rate, size_t rx_buffer_size, size_t tx_buffer_size, AtTransportEventCallback callback) {
+    if (thread_.joinable()) {
+        return true;
+    }
+    callback_ = std::move(callback);
+    thread_ = std::thread([this]() { Play(); });
+    return true;
+}
+
+void AtReplayTransport::Play() {
+    size_t tx_expected = 0;
+    for (auto& record : records_) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_) {
+            break;
+        }
+        if (record.direction == AtTranscriptDirection::Tx) {
+            // TX 之前的间隔是主机侧的处理时间，回放时由 AtUart 自己决定，只等它写出
+            tx_expected += record.data.size();
+            if (!cv_.wait_for(lock, std::chrono::milliseconds(tx_timeout_ms_), [&]() { return stopping_ || tx_written_ >= tx_expected; })) {
+                tx_timeout_count_++;
+                ESP_LOGW(TAG, "Timeout waiting for TX: %.*s", (int)record.data.size(), record.data.data());
+            }
+            continue;
+        }
+
+        if (speed_ > 0 && record.delta_us > 0) {
+            auto delay = std::chrono::microseconds((int64_t)(record.delta_us / speed_));
+            if (cv_.wait_for(lock, delay, [&]() { return stopping_; })) {
+                break;
+            }
+        }
+        rx_pending_.append(record.data);
+        lock.unlock();
+        callback_(AtTransportEvent::DataAvailable);
+    }
+    finished_ = true;
+    cv_.notify_all();
+}
+
+bool AtReplayTransport::WaitFinished(uint32_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&]() { return finished_.load(); });
+}
+
+size_t AtReplayTransport::Available() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rx_pending_.size() - rx_offset_;
+}
+
+int AtReplayTransport::Read(char* buffer, size_t length) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    length = std::min(length, rx_pending_.size() - rx_offset_);
+    memcpy(buffer, rx_pending_.data() + rx_offset_, length);
+    rx_offset_ += length;
+    if (rx_offset_ == rx_pending_.size()) {
+        rx_pending_.clear();
+        rx_offset_ = 0;
+    }
+    return length;
+}
+
+int AtReplayTransport::Write(const char* data, size_t length) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (tx_written_ < expected_tx_.size()) {
+            size_t compare = std::min(length, expected_tx_.size() - tx_written_);
+            if (memcmp(expected_tx_.data() + tx_written_, data, compare) != 0) {
+                tx_mismatch_count_++;
+                ESP_LOGW(TAG, "TX differs from transcript: %.*s", (int)length, data);
+            }
+        }
+        tx_written_ += length;
+    }
+    cv_.notify_all();
+    return length;
+}
@@ -1,34 +1,44 @@
 #include "at_uart.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "uart_transport.h"
+#endif
 #include <esp_log.h>
 #include <esp_err.h>
 #include <algorithm>
 #include <cstring>
+#include <cstdint>
 #include <cstdlib>
-#include <sstream>
+#include <charconv>
+#include <chrono>
 
 #define TAG "AtUart"
 
 
 // AtUart 构造函数实现
-AtUart::AtUart(gpio_num_t tx_pin, gpio_num_t rx_pin, gpio_num_t dtr_pin)
-    : tx_pin_(tx_pin), rx_pin_(rx_pin), dtr_pin_(dtr_pin), uart_num_(UART_NUM),
-      baud_rate_(115200), initialized_(false),
-      event_task_handle_(nullptr), event_queue_handle_(nullptr), event_group_handle_(nullptr) {
+#if !CONFIG_IDF_TARGET_LINUX
+AtUart::AtUart(gpio_num_t tx_pin, gpio_num_t rx_pin, gpio_num_t dtr_pin, gpio_num_t rts_pin, gpio_num_t cts_pin)
+    : AtUart(std::make_unique<UartTransport>(tx_pin, rx_pin, rts_pin, cts_pin)) {
+    dtr_pin_ = dtr_pin;
+}
+#endif
+
+AtUart::AtUart(std::unique_ptr<AtTransport> transport)
+    : transport_(std::move(transport)), baud_rate_(115200), initialized_(false),
+      event_group_handle_(nullptr), rx_buffer_(new char[AT_UART_RX_BUFFER_SIZE]) {
 }
 
 AtUart::~AtUart() {
-    if (event_task_handle_) {
-        vTaskDelete(event_task_handle_);
+    if (receive_task_handle_) {
+        vTaskDelete(receive_task_handle_);
     }
+    // 先停掉传输，它的事件回调还引用着事件组
+    transport_.reset();
     if (event_group_handle_) {
         vEventGroupDelete(event_group_handle_);
     }
-    if (initialized_) {
-        uart_driver_delete(uart_num_);
-    }
 }
 
-void AtUart::Initialize() {
+void AtUart::Initialize(size_t rx_buffer_size, size_t tx_buffer_size) {
     if (initialized_) {
         return;
     }
@@ -39,17 +49,12 @@ void AtUart::Initialize() {
         return;
     }
 
-    uart_config_t uart_config = {};
-    uart_config.baud_rate = baud_rate_;
-    uart_config.data_bits = UART_DATA_8_BITS;
-    uart_config.parity = UART_PARITY_DISABLE;
-    uart_config.stop_bits = UART_STOP_BITS_1;
-    uart_config.source_clk = UART_SCLK_DEFAULT;
-    
-    ESP_ERROR_CHECK(uart_driver_install(uart_num_, 8192, 0, 100, &event_queue_handle_, ESP_INTR_FLAG_IRAM));
-    ESP_ERROR_CHECK(uart_param_config(uart_num_, &uart_config));
-    ESP_ERROR_CHECK(uart_set_pin(uart_num_, tx_pin_, rx_pin_, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+    if (!transport_->Open(baud_rate_, rx_buffer_size, tx_buffer_size, [this](AtTransportEvent event) { OnTransportEvent(event); })) {
+        ESP_LOGE(TAG, "打开传输失败");
+        return;
+    }
     
+#if !CONFIG_IDF_TARGET_LINUX
     if (dtr_pin_ != GPIO_NUM_NC) {
         gpio_config_t config = {};
         config.pin_bit_mask = (1ULL << dtr_pin_);
@@ -58,14 +63,9 @@ void AtUart::Initialize() {
         config.pull_down_en = GPIO_PULLDOWN_DISABLE;
         config.intr_type = GPIO_INTR_DISABLE;
         gpio_config(&config);
-        gpio_set_level(dtr_pin_, 0);
+        gpio_set_level((gpio_num_t)dtr_pin_, 0);
     }
-
-    xTaskCreatePinnedToCore([](void* arg) {
-        auto ml307_at_modem = (AtUart*)arg;
-        ml307_at_modem->EventTask();
-        vTaskDelete(NULL);
-    }, "modem_event", 2048, this, configMAX_PRIORITIES - 1, &event_task_handle_, 0);
+#endif
 
     xTaskCreatePinnedToCore([](void* arg) {
         auto ml307_at_modem = (AtUart*)arg;
@@ -75,209 +75,482 @@ void AtUart::Initialize() {
     initialized_ = true;
 }
 
-void AtUart::EventTask() {
-    uart_event_t event;
-    while (true) {
-        if (xQueueReceive(event_queue_handle_, &event, portMAX_DELAY) == pdTRUE) {
-            switch (event.type)
-            {
-            case UART_DATA:
-                xEventGroupSetBits(event_group_handle_, AT_EVENT_DATA_AVAILABLE);
-                break;
-            case UART_BREAK:
-                xEventGroupSetBits(event_group_handle_, AT_EVENT_BREAK);
-                break;
-            case UART_BUFFER_FULL:
-                xEventGroupSetBits(event_group_handle_, AT_EVENT_BUFFER_FULL);
-                break;
-            case UART_FIFO_OVF:
-                xEventGroupSetBits(event_group_handle_, AT_EVENT_FIFO_OVF);
-                break;
-            default:
-                ESP_LOGE(TAG, "unknown event type: %d", event.type);
-                break;
-            }
-        }
+void AtUart::OnTransportEvent(AtTransportEvent event) {
+    switch (event)
+    {
+    case AtTransportEvent::DataAvailable:
+        xEventGroupSetBits(event_group_handle_, AT_EVENT_DATA_AVAILABLE);
+        break;
+    case AtTransportEvent::Break:
+        xEventGroupSetBits(event_group_handle_, AT_EVENT_BREAK);
+        break;
+    case AtTransportEvent::BufferFull:
+        xEventGroupSetBits(event_group_handle_, AT_EVENT_BUFFER_FULL);
+        break;
+    case AtTransportEvent::FifoOverflow:
+        xEventGroupSetBits(event_group_handle_, AT_EVENT_FIFO_OVF);
+        break;
     }
 }
 
 void AtUart::ReceiveTask() {
     while (true) {
-        auto bits = xEventGroupWaitBits(event_group_handle_, AT_EVENT_DATA_AVAILABLE | AT_EVENT_FIFO_OVF | AT_EVENT_BUFFER_FULL | AT_EVENT_BREAK, pdTRUE, pdFALSE, portMAX_DELAY);
+        // 有命令在途时最多睡到最早的超时点
+        auto bits = xEventGroupWaitBits(event_group_handle_, AT_EVENT_DATA_AVAILABLE | AT_EVENT_FIFO_OVF | AT_EVENT_BUFFER_FULL | AT_EVENT_BREAK | AT_EVENT_COMMAND_ISSUED,
+            pdTRUE, pdFALSE, NextCommandTimeout());
+        // 溢出丢了一段数据，丢的可能是任意连接的: 解析器重新同步，并通知各连接数据已不完整。
+        // 事件位不保留先后，在读取新数据前处理，缺口之后的字节不会先交给连接
+        if (bits & AT_EVENT_FIFO_OVF) {
+            fifo_overflow_count_++;
+            ESP_LOGW(TAG, "FIFO overflow (%u)", fifo_overflow_count_);
+            ResyncRxBuffer();
+            HandleUrc("FIFO_OVERFLOW", AtArguments());
+        }
         if (bits & AT_EVENT_DATA_AVAILABLE) {
-            size_t available;
-            uart_get_buffered_data_len(uart_num_, &available);
-            if (available > 0) {
-                // Extend rx_buffer_ and read into buffer
-                rx_buffer_.resize(rx_buffer_.size() + available);
-                char* rx_buffer_ptr = &rx_buffer_[rx_buffer_.size() - available];
-                uart_read_bytes(uart_num_, rx_buffer_ptr, available, portMAX_DELAY);
+            size_t available = transport_->Available();
+            while (available > 0) {
+                CompactRxBuffer();
+                if (rx_tail_ == AT_UART_RX_BUFFER_SIZE) {
+                    // 一整行都放不下: 丢弃已收到的部分，跳到下一个行尾重新同步
+                    rx_overflow_count_++;
+                    ESP_LOGE(TAG, "Line exceeds %d bytes, dropped", AT_UART_RX_BUFFER_SIZE);
+                    rx_head_ = rx_tail_ = rx_scan_ = 0;
+                    rx_discarding_ = true;
+                }
+                size_t length = std::min(available, (size_t)AT_UART_RX_BUFFER_SIZE - rx_tail_);
+                int read = transport_->Read(rx_buffer_.get() + rx_tail_, length);
+                if (read <= 0) {
+                    break;
+                }
+                if (auto transcript = GetTranscript()) {
+                    transcript->Record(AtTranscriptDirection::Rx, rx_buffer_.get() + rx_tail_, read);
+                }
+                rx_tail_ += read;
+                available -= std::min(available, (size_t)read);
                 while (ParseResponse()) {}
             }
         }
-        if (bits & AT_EVENT_FIFO_OVF) {
-            ESP_LOGE(TAG, "FIFO overflow");
-            HandleUrc("FIFO_OVERFLOW", {});
-        }
         if (bits & AT_EVENT_BREAK) {
             ESP_LOGE(TAG, "Break");
         }
+        // 驱动环形缓冲区满时数据留在 FIFO 里等待读取，没有丢失，不需要重新同步
         if (bits & AT_EVENT_BUFFER_FULL) {
-            ESP_LOGE(TAG, "Buffer full");
+            buffer_full_count_++;
+            ESP_LOGW(TAG, "Buffer full (%u)", buffer_full_count_);
         }
+        ExpireCommands();
+    }
+}
+
+void AtUart::CompactRxBuffer() {
+    if (rx_head_ == 0) {
+        return;
+    }
+    // 只搬移残余的半行，每个字节最多被搬移一次
+    size_t remaining = rx_tail_ - rx_head_;
+    if (remaining > 0) {
+        memmove(rx_buffer_.get(), rx_buffer_.get() + rx_head_, remaining);
     }
+    rx_scan_ = rx_scan_ > rx_head_ ? rx_scan_ - rx_head_ : 0;
+    rx_head_ = 0;
+    rx_tail_ = remaining;
+}
+
+// 丢失数据的位置未知: 丢掉尚未解析的半行 (或二进制帧)，跳到下一个行尾再继续解析
+void AtUart::ResyncRxBuffer() {
+    rx_head_ = rx_tail_ = rx_scan_ = 0;
+    rx_skip_ = 0;
+    rx_discarding_ = true;
+}
+
+// FNV-1a
+static uint32_t HashUrcCommand(std::string_view command) {
+    uint32_t hash = 2166136261u;
+    for (char c : command) {
+        hash = (hash ^ (uint8_t)c) * 16777619u;
+    }
+    return hash;
+}
+
+// 同一命令的不同连接号落在不同的桶里，分发代价与打开的连接数无关
+static size_t UrcBucket(uint32_t hash, int link_id) {
+    return (hash ^ ((uint32_t)(link_id + 1) * 0x9E3779B1u)) & (AT_URC_BUCKETS - 1);
 }
 
-static bool is_number(const std::string& s) {
+static bool is_number(std::string_view s) {
     return !s.empty() && std::all_of(s.begin(), s.end(), ::isdigit) && s.length() < 10;
 }
 
 bool AtUart::ParseResponse() {
-    if (wait_for_response_ && rx_buffer_[0] == '>') {
-        rx_buffer_.erase(0, 1);
-        xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_DONE);
+    if (rx_head_ >= rx_tail_) {
+        return false;
+    }
+    std::string_view pending(rx_buffer_.get() + rx_head_, rx_tail_ - rx_head_);
+
+    if (rx_skip_ > 0) {
+        size_t skip = std::min(rx_skip_, pending.size());
+        rx_head_ += skip;
+        rx_scan_ = rx_head_;
+        rx_skip_ -= skip;
+        return rx_head_ < rx_tail_;
+    }
+
+    if (rx_discarding_) {
+        auto end_pos = pending.find("\r\n");
+        if (end_pos == std::string_view::npos) {
+            // 保留最后一个字节，\r 和 \n 可能分两次到达
+            rx_head_ = rx_tail_ - 1;
+            return false;
+        }
+        rx_head_ += end_pos + 2;
+        rx_scan_ = rx_head_;
+        rx_discarding_ = false;
         return true;
     }
 
-    auto end_pos = rx_buffer_.find("\r\n");
-    if (end_pos == std::string::npos) {
-        // FIXME: for +MHTTPURC: "ind", missing newline
-        if (rx_buffer_.size() >= 16 && memcmp(rx_buffer_.c_str(), "+MHTTPURC: \"ind\"", 16) == 0) {
-            // Find the end of this line and add \r\n if missing
-            auto next_plus = rx_buffer_.find("+", 1);
-            if (next_plus != std::string::npos) {
-                // Insert \r\n before the next + command
-                rx_buffer_.insert(next_plus, "\r\n");
-            } else {
-                // Append \r\n at the end
-                rx_buffer_.append("\r\n");
+    if (prompt_expected_ && pending[0] == '>') {
+        rx_head_ += 1;
+        rx_scan_ = std::max(rx_scan_, rx_head_);
+        {
+            // 带数据的命令独占流水线，此时一定在队首
+            std::lock_guard<std::mutex> lock(command_mutex_);
+            prompt_expected_ = false;
+            if (!inflight_commands_.empty()) {
+                inflight_commands_.front()->prompted_ = true;
             }
-            end_pos = rx_buffer_.find("\r\n");
+        }
+        command_cv_.notify_all();
+        return true;
+    }
+
+    if (pending[0] == '+') {
+        int result = ParseBinaryUrc(pending);
+        if (result != 0) {
+            return result > 0;
+        }
+    }
+
+    size_t scan_from = rx_scan_ > rx_head_ ? rx_scan_ - rx_head_ : 0;
+    size_t end_pos = pending.find("\r\n", scan_from);
+    size_t consumed = end_pos + 2;
+    if (end_pos == std::string_view::npos) {
+        // FIXME: for +MHTTPURC: "ind", missing newline
+        if (pending.size() >= 16 && pending.compare(0, 16, "+MHTTPURC: \"ind\"") == 0) {
+            // 这一行在下一个 + 命令之前结束，没有 + 则到当前数据末尾
+            auto next_plus = pending.find('+', 1);
+            end_pos = (next_plus != std::string_view::npos) ? next_plus : pending.size();
+            consumed = end_pos;
         } else {
+            rx_scan_ = rx_tail_ - 1;
             return false;
         }
     }
 
+    std::string_view line = pending.substr(0, end_pos);
+    rx_head_ += consumed;
+    rx_scan_ = rx_head_;
+
     // Ignore empty lines
-    if (end_pos == 0) {
-        rx_buffer_.erase(0, 2);
-        return true;
+    if (!line.empty()) {
+        ParseLine(line);
+    }
+    return true;
+}
+
+// 返回 -1 表示帧还不完整，0 表示不是二进制 URC (按行解析)，1 表示已处理
+int AtUart::ParseBinaryUrc(std::string_view pending) {
+    size_t prefix_length = 0;
+    int link_index = 0;
+    int length_index = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : binary_urcs_) {
+            if (pending.size() >= entry.prefix.size() && pending.compare(0, entry.prefix.size(), entry.prefix) == 0) {
+                prefix_length = entry.prefix.size();
+                link_index = entry.link_index;
+                length_index = entry.length_index;
+                break;
+            }
+        }
+    }
+    if (prefix_length == 0) {
+        return 0;
+    }
+
+    // 长度参数后面的逗号之后就是原始数据，在此之前出现行尾说明是普通的 URC (如 "disconn")
+    size_t header_end = std::string_view::npos;
+    int commas = 0;
+    for (size_t i = prefix_length; i < pending.size(); i++) {
+        if (pending[i] == '\r' || pending[i] == '\n') {
+            return 0;
+        }
+        if (pending[i] == ',' && commas++ == length_index) {
+            header_end = i;
+            break;
+        }
+    }
+    if (header_end == std::string_view::npos) {
+        return -1;
+    }
+
+    ParseArguments(pending.substr(prefix_length, header_end - prefix_length));
+    if (urc_arguments_.size() <= (size_t)std::max(link_index, length_index)) {
+        return 0;
+    }
+    int link_id = urc_arguments_[link_index].int_value();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto entry = std::find_if(binary_urcs_.begin(), binary_urcs_.end(), [&](const BinaryUrc& e) {
+            return e.link_id == link_id && e.prefix.size() == prefix_length && pending.compare(0, prefix_length, e.prefix) == 0;
+        });
+        if (entry == binary_urcs_.end()) {
+            return 0;
+        }
+    }
+
+    size_t length = std::max(urc_arguments_[length_index].int_value(), 0);
+    size_t frame_length = header_end + 1 + length;
+    if (frame_length + 2 > AT_UART_RX_BUFFER_SIZE) {
+        // 整帧放不下: 丢弃并按长度跳过，不去原始数据里找行尾
+        rx_overflow_count_++;
+        ESP_LOGE(TAG, "Binary URC of %u bytes exceeds buffer, dropped", length);
+        size_t skip = std::min(frame_length + 2, pending.size());
+        rx_head_ += skip;
+        rx_scan_ = rx_head_;
+        rx_skip_ = frame_length + 2 - skip;
+        return 1;
     }
+    if (pending.size() < frame_length) {
+        return -1;
+    }
+
+    if (urc_arguments_.count_ < AT_ARGUMENTS_MAX) {
+        AtArgumentValue& payload = urc_arguments_.values_[urc_arguments_.count_++];
+        payload.type = AtArgumentValue::Type::String;
+        payload.string_value = pending.substr(header_end + 1, length);
+    }
+    rx_head_ += frame_length;
+    // 结尾的 \r\n 若尚未到达，之后会被当作空行忽略
+    if (pending.size() >= frame_length + 2 && pending.compare(frame_length, 2, "\r\n") == 0) {
+        rx_head_ += 2;
+    }
+    rx_scan_ = rx_head_;
+
+    ESP_LOGD(TAG, "<< %.*s (%u bytes binary)", (int)header_end, pending.data(), length);
+    HandleUrc(pending.substr(1, prefix_length - 3), urc_arguments_);
+    return 1;
+}
 
-    ESP_LOGD(TAG, "<< %.64s (%u bytes)", rx_buffer_.substr(0, end_pos).c_str(), end_pos);
-    // print last 64 bytes before end_pos if available
-    // if (end_pos > 64) {
-    //     ESP_LOGI(TAG, "<< LAST: %.64s", rx_buffer_.c_str() + end_pos - 64);
-    // }
+void AtUart::ParseLine(std::string_view line) {
+    ESP_LOGD(TAG, "<< %.*s (%u bytes)", (int)std::min(line.size(), (size_t)64), line.data(), line.size());
 
     // Parse "+CME ERROR: 123,456,789"
-    if (rx_buffer_[0] == '+') {
-        std::string command, values;
-        auto pos = rx_buffer_.find(": ");
-        if (pos == std::string::npos || pos > end_pos) {
-            command = rx_buffer_.substr(1, end_pos - 1);
+    if (line[0] == '+') {
+        std::string_view command, values;
+        auto pos = line.find(": ");
+        if (pos == std::string_view::npos) {
+            command = line.substr(1);
         } else {
-            command = rx_buffer_.substr(1, pos - 1);
-            values = rx_buffer_.substr(pos + 2, end_pos - pos - 2);
-        }
-        rx_buffer_.erase(0, end_pos + 2);
-
-        // Parse "string", int, int, ... into AtArgumentValue
-        std::vector<AtArgumentValue> arguments;
-        std::istringstream iss(values);
-        std::string item;
-        while (std::getline(iss, item, ',')) {
-            AtArgumentValue argument;
-            if (item.front() == '"') {
-                argument.type = AtArgumentValue::Type::String;
-                argument.string_value = item.substr(1, item.size() - 2);
-            } else if (item.find(".") != std::string::npos) {
-                argument.type = AtArgumentValue::Type::Double;
-                argument.double_value = std::stod(item);
-            } else if (is_number(item)) {
-                argument.type = AtArgumentValue::Type::Int;
-                argument.int_value = std::stoi(item);
-                argument.string_value = std::move(item);
-            } else {
-                argument.type = AtArgumentValue::Type::String;
-                argument.string_value = std::move(item);
-            }
-            arguments.push_back(argument);
+            command = line.substr(1, pos - 1);
+            values = line.substr(pos + 2);
         }
-
-        HandleUrc(command, arguments);
-        return true;
-    } else if (rx_buffer_.size() >= 4 && rx_buffer_[0] == 'O' && rx_buffer_[1] == 'K' && rx_buffer_[2] == '\r' && rx_buffer_[3] == '\n') {
-        rx_buffer_.erase(0, 4);
-        xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_DONE);
-        return true;
-    } else if (rx_buffer_.size() >= 7 && rx_buffer_[0] == 'E' && rx_buffer_[1] == 'R' && rx_buffer_[2] == 'R' && rx_buffer_[3] == 'O' && rx_buffer_[4] == 'R' && rx_buffer_[5] == '\r' && rx_buffer_[6] == '\n') {
-        rx_buffer_.erase(0, 7);
-        xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_ERROR);
-        return true;
+        ParseArguments(values);
+        HandleUrc(command, urc_arguments_);
+    } else if (line == "RDY") {
+        // 开机 URC 不带 '+' 前缀 (如 EC801E)，不能当作应答文本
+        ParseArguments({});
+        HandleUrc(line, urc_arguments_);
+    } else if (line == "OK") {
+        CompleteCommand(AtResult::Ok, 0);
+    } else if (line == "ERROR") {
+        CompleteCommand(AtResult::Error, 0);
     } else {
-        std::lock_guard<std::mutex> lock(mutex_);
-        response_ = rx_buffer_.substr(0, end_pos);
-        rx_buffer_.erase(0, end_pos + 2);
-        return true;
+        // 最终结果按发出顺序返回，中间的应答文本属于最早的在途命令；
+        // 还有迟到的结果未到时，文本属于已超时的命令
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        if (resync_discard_ == 0 && !inflight_commands_.empty()) {
+            inflight_commands_.front()->result_.response.assign(line);
+        }
     }
-    return false;
 }
 
-void AtUart::HandleCommand(const char* command) {
-    // 这个函数现在主要用于向后兼容，大部分处理逻辑已经移到 ParseLine 中
-    if (wait_for_response_) {
-        response_.append(command);
-        response_.append("\r\n");
+// Parse "string", int, int, ... into AtArgumentValue
+// 只切分和判断类型，数值由 AtArgumentValue 在访问时解析
+void AtUart::ParseArguments(std::string_view values) {
+    size_t count = 0;
+    size_t start = 0;
+    while (start < values.size()) {
+        auto comma = values.find(',', start);
+        std::string_view item = values.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start);
+
+        if (count == AT_ARGUMENTS_MAX) {
+            ESP_LOGW(TAG, "Too many arguments, keeping first %d", AT_ARGUMENTS_MAX);
+            break;
+        }
+        AtArgumentValue& argument = urc_arguments_.values_[count++];
+        if (!item.empty() && item.front() == '"') {
+            argument.type = AtArgumentValue::Type::String;
+            argument.string_value = item.size() >= 2 ? item.substr(1, item.size() - 2) : std::string_view();
+        } else if (item.find('.') != std::string_view::npos) {
+            argument.type = AtArgumentValue::Type::Double;
+            argument.string_value = item;
+        } else if (is_number(item)) {
+            argument.type = AtArgumentValue::Type::Int;
+            argument.string_value = item;
+        } else {
+            argument.type = AtArgumentValue::Type::String;
+            argument.string_value = item;
+        }
+
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        start = comma + 1;
     }
+    urc_arguments_.count_ = count;
 }
 
-void AtUart::HandleUrc(const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+void AtUart::HandleUrc(std::string_view command, const AtArguments& arguments) {
     if (command == "CME ERROR") {
-        cme_error_code_ = arguments[0].int_value;
-        xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_ERROR);
+        CompleteCommand(AtResult::Error, arguments.empty() ? 0 : arguments[0].int_value());
         return;
     }
 
     std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t hash = HashUrcCommand(command);
+    DispatchUrc(hash, AT_URC_ANY_LINK, command, arguments);
+    for (auto& entry : urc_link_indexes_) {
+        if (entry.hash == hash && entry.command == command) {
+            if (arguments.size() > (size_t)entry.index) {
+                DispatchUrc(hash, arguments[entry.index].int_value(), command, arguments);
+            }
+            break;
+        }
+    }
     for (auto& callback : urc_callbacks_) {
         callback(command, arguments);
     }
 }
 
-bool AtUart::DetectBaudRate() {
-    int baud_rates[] = {115200, 921600, 460800, 230400, 57600, 38400, 19200, 9600};
+void AtUart::DispatchUrc(uint32_t hash, int link_id, std::string_view command, const AtArguments& arguments) {
+    for (auto& handler : urc_buckets_[UrcBucket(hash, link_id)]) {
+        if (handler.hash == hash && handler.link_id == link_id && handler.command == command) {
+            handler.callback(command, arguments);
+        }
+    }
+}
+
+// 探测顺序: 出厂默认值和常用值在前
+static const int kDetectBaudRates[] = {115200, 921600, 460800, 230400, 1500000, 3000000, 57600, 38400, 19200, 9600};
+// 协商候选，从高到低，第一个校验通过的即为最高稳定波特率
+static const int kNegotiateBaudRates[] = {3000000, 2000000, 1500000, 921600, 460800, 230400};
+#define BAUD_VERIFY_ROUNDS      (5)
+
+bool AtUart::ProbeBaudRate(int baud_rate, int attempts) {
+    transport_->SetBaudRate(baud_rate);
+    // 其他波特率下超时的探测不会再有可辨认的应答，不必等它们
+    ResetCommandSync();
+    for (int i = 0; i < attempts; i++) {
+        if (SendCommand("AT", 20)) {
+            baud_rate_ = baud_rate;
+            return true;
+        }
+    }
+    transport_->SetBaudRate(baud_rate_);
+    return false;
+}
+
+bool AtUart::DetectBaudRate(int timeout_ms) {
+    TickType_t start = xTaskGetTickCount();
     while (true) {
+        // 上次使用的波特率 (如从 NVS 恢复的协商结果) 优先，命中时不必逐个探测
+        if (ProbeBaudRate(baud_rate_, 1)) {
+            return true;
+        }
         ESP_LOGI(TAG, "Detecting baud rate...");
-        for (size_t i = 0; i < sizeof(baud_rates) / sizeof(baud_rates[0]); i++) {
-            int rate = baud_rates[i];
-            uart_set_baudrate(uart_num_, rate);
-            if (SendCommand("AT", 20)) {
+        for (int rate : kDetectBaudRates) {
+            if (rate != baud_rate_ && ProbeBaudRate(rate, 1)) {
                 ESP_LOGI(TAG, "Detected baud rate: %d", rate);
-                baud_rate_ = rate;
                 return true;
             }
         }
+        if (timeout_ms >= 0 && (xTaskGetTickCount() - start) >= pdMS_TO_TICKS(timeout_ms)) {
+            break;
+        }
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
     return false;
 }
 
-bool AtUart::SetBaudRate(int new_baud_rate) {
-    if (!DetectBaudRate()) {
+// 模组以旧波特率回复 OK 后切换，本地随后跟上
+bool AtUart::SwitchBaudRate(int new_baud_rate) {
+    if (!SendCommand(std::string("AT+IPR=") + std::to_string(new_baud_rate))) {
+        ESP_LOGI(TAG, "Failed to set baud rate to %d", new_baud_rate);
+        return false;
+    }
+    transport_->WaitTxDone(20);
+    transport_->SetBaudRate(new_baud_rate);
+    baud_rate_ = new_baud_rate;
+    vTaskDelay(pdMS_TO_TICKS(10));
+    return true;
+}
+
+// 往返校验: 多次读取版本号，与切换前的应答逐字节比较，单个 AT 不足以暴露高速下的误码
+bool AtUart::VerifyBaudRate(const std::string& reference) {
+    for (int i = 0; i < BAUD_VERIFY_ROUNDS; i++) {
+        if (!SendCommand("AT+CGMR", 200)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (response_ != reference) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int AtUart::NegotiateBaudRate(int max_baud_rate) {
+    if (!SendCommand("AT+CGMR", 1000)) {
+        return baud_rate_;
+    }
+    std::string reference = GetResponse();
+    int stable_rate = baud_rate_;
+
+    for (int rate : kNegotiateBaudRates) {
+        if (rate > max_baud_rate || rate <= stable_rate) {
+            continue;
+        }
+        if (!SwitchBaudRate(rate)) {
+            continue;
+        }
+        if (VerifyBaudRate(reference)) {
+            ESP_LOGI(TAG, "Negotiated baud rate: %d", rate);
+            return rate;
+        }
+
+        // 回退: 先在新波特率上要求模组切回，不通时再全量探测找到模组后切回
+        ESP_LOGW(TAG, "Baud rate %d unstable, falling back to %d", rate, stable_rate);
+        if (!(SwitchBaudRate(stable_rate) && ProbeBaudRate(stable_rate))) {
+            if (!DetectBaudRate(1000) || (baud_rate_ != stable_rate && !SwitchBaudRate(stable_rate))) {
+                ESP_LOGE(TAG, "Lost modem while falling back from %d", rate);
+                return baud_rate_;
+            }
+        }
+    }
+    return stable_rate;
+}
+
+bool AtUart::SetBaudRate(int new_baud_rate, int detect_timeout_ms) {
+    if (!DetectBaudRate(detect_timeout_ms)) {
         ESP_LOGE(TAG, "Failed to detect baud rate");
         return false;
     }
     if (new_baud_rate == baud_rate_) {
         return true;
     }
-    // Set new baud rate
-    if (!SendCommand(std::string("AT+IPR=") + std::to_string(new_baud_rate))) {
-        ESP_LOGI(TAG, "Failed to set baud rate to %d", new_baud_rate);
+    if (!SwitchBaudRate(new_baud_rate)) {
         return false;
     }
-    uart_set_baudrate(uart_num_, new_baud_rate);
-    baud_rate_ = new_baud_rate;
     ESP_LOGI(TAG, "Set baud rate to %d", new_baud_rate);
     return true;
 }
@@ -288,60 +561,334 @@ bool AtUart::SendData(const char* data, size_t length) {
         return false;
     }
     
-    int ret = uart_write_bytes(uart_num_, data, length);
+    if (auto transcript = GetTranscript()) {
+        transcript->Record(AtTranscriptDirection::Tx, data, length);
+    }
+    int ret = transport_->Write(data, length);
     if (ret < 0) {
-        ESP_LOGE(TAG, "uart_write_bytes failed: %d", ret);
+        ESP_LOGE(TAG, "Write failed: %d", ret);
         return false;
     }
     return true;
 }
 
-bool AtUart::SendCommandWithData(const std::string& command, size_t timeout_ms, bool add_crlf, const char* data, size_t data_length) {
+AtCommandHandle AtUart::QueueCommand(const std::string& command, size_t timeout_ms, bool add_crlf, bool expects_prompt, AtCommandCallback callback) {
+    auto handle = std::make_shared<AtCommand>();
+    handle->owner_ = this;
+    handle->wire_.reserve(command.size() + 2);
+    handle->wire_ = command;
+    if (add_crlf) {
+        handle->wire_ += "\r\n";
+    }
+    handle->expects_prompt_ = expects_prompt;
+    handle->timeout_ticks_ = std::max<TickType_t>(pdMS_TO_TICKS(timeout_ms), 1);
+    handle->callback_ = std::move(callback);
+
+    if (!initialized_) {
+        ESP_LOGE(TAG, "UART未初始化");
+        handle->result_.result = AtResult::Error;
+        FinishCommand(handle);
+        return handle;
+    }
+
     std::lock_guard<std::mutex> lock(command_mutex_);
-    ESP_LOGD(TAG, ">> %.64s (%u bytes)", command.data(), command.length());
+    pending_commands_.push_back(handle);
+    IssueCommands();
+    return handle;
+}
 
-    xEventGroupClearBits(event_group_handle_, AT_EVENT_COMMAND_DONE | AT_EVENT_COMMAND_ERROR);
-    wait_for_response_ = true;
-    cme_error_code_ = 0;
-    response_.clear();
+// 需持有 command_mutex_。发出顺序即最终结果的对应顺序
+void AtUart::IssueCommands() {
+    if (resyncing_) {
+        // 一次只有哨兵在途。队首本身是 "AT" 时直接作为哨兵，如波特率探测，否则先插入一条。
+        // 没有待发命令时不主动发，迟到的结果照样按计数丢弃
+        if (!inflight_commands_.empty() || pending_commands_.empty()) {
+            return;
+        }
+        AtCommandHandle sentinel;
+        auto& next = pending_commands_.front();
+        if (next->wire_ == "AT\r\n") {
+            sentinel = std::move(next);
+            pending_commands_.pop_front();
+        } else {
+            sentinel = std::make_shared<AtCommand>();
+            sentinel->owner_ = this;
+            sentinel->wire_ = "AT\r\n";
+            sentinel->timeout_ticks_ = pdMS_TO_TICKS(AT_RESYNC_TIMEOUT_MS);
+        }
+        sentinel->sentinel_ = true;
+        SendData(sentinel->wire_.data(), sentinel->wire_.size());
+        sentinel->deadline_ = xTaskGetTickCount() + sentinel->timeout_ticks_;
+        inflight_commands_.push_back(std::move(sentinel));
+        xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_ISSUED);
+        return;
+    }
 
-    if (add_crlf) {
-        if (!SendData((command + "\r\n").data(), command.length() + 2)) {
-            return false;
+    bool issued = false;
+    while (!pending_commands_.empty() && inflight_commands_.size() < AT_PIPELINE_DEPTH) {
+        auto& next = pending_commands_.front();
+        // 带数据的命令独占流水线: 等前面的命令都结束才发出，它结束前也不再发出其他命令
+        if (!inflight_commands_.empty() && (next->expects_prompt_ || inflight_commands_.back()->expects_prompt_)) {
+            break;
         }
-    } else {
-        if (!SendData(command.data(), command.length())) {
-            return false;
+        ESP_LOGD(TAG, ">> %.64s (%u bytes)", next->wire_.c_str(), next->wire_.size());
+        // 先置位再发出，模组的 '>' 可能在 SendData 返回前就被接收任务读到
+        if (next->expects_prompt_) {
+            prompt_expected_ = true;
         }
+        // 写失败的命令同样按超时结束，保持结果顺序
+        SendData(next->wire_.data(), next->wire_.size());
+        next->deadline_ = xTaskGetTickCount() + next->timeout_ticks_;
+        inflight_commands_.push_back(std::move(next));
+        pending_commands_.pop_front();
+        issued = true;
     }
-    if (timeout_ms > 0) {
-        auto bits = xEventGroupWaitBits(event_group_handle_, AT_EVENT_COMMAND_DONE | AT_EVENT_COMMAND_ERROR, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
-        wait_for_response_ = false;
-        if (!(bits & AT_EVENT_COMMAND_DONE)) {
-            return false;
+    if (issued) {
+        xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_ISSUED);
+    }
+}
+
+void AtUart::CompleteCommand(AtResult result, int cme_error_code) {
+    AtCommandHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        if (resync_discard_ > 0) {
+            resync_discard_--;
+            ESP_LOGW(TAG, "Discarded late result of timed out command");
+            return;
         }
-    } else {
-        wait_for_response_ = false;
+        if (inflight_commands_.empty()) {
+            ESP_LOGW(TAG, "Final result without pending command");
+            return;
+        }
+        handle = std::move(inflight_commands_.front());
+        inflight_commands_.pop_front();
+        handle->result_.result = result;
+        handle->result_.cme_error_code = cme_error_code;
+        if (handle->expects_prompt_) {
+            prompt_expected_ = false;
+        }
+        if (handle->sentinel_) {
+            // 迟到的结果已全部丢弃，之后的结果与发出顺序重新对应
+            ESP_LOGI(TAG, "Command pipeline resynced");
+            resyncing_ = false;
+        }
+        IssueCommands();
     }
+    FinishCommand(handle);
+}
 
-    if (data && data_length > 0) {
-        wait_for_response_ = true;
-        if (!SendData(data, data_length)) {
-            return false;
+void AtUart::FinishCommand(const AtCommandHandle& handle) {
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        handle->done_ = true;
+    }
+    command_cv_.notify_all();
+    if (handle->callback_) {
+        handle->callback_(handle->result_);
+    }
+}
+
+// 结果按顺序返回，只需检查队首。队首超时后，它迟到的结果会被当成下一条命令的，
+// 所以在途的其余命令一并按超时结束，它们的结果连同队首的计入 resync_discard_，由哨兵重新同步
+void AtUart::ExpireCommands() {
+    std::deque<AtCommandHandle> expired;
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        if (inflight_commands_.empty() || (int32_t)(xTaskGetTickCount() - inflight_commands_.front()->deadline_) < 0) {
+            return;
         }
-        auto bits = xEventGroupWaitBits(event_group_handle_, AT_EVENT_COMMAND_DONE | AT_EVENT_COMMAND_ERROR, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
-        wait_for_response_ = false;
-        if (!(bits & AT_EVENT_COMMAND_DONE)) {
-            return false;
+        expired.swap(inflight_commands_);
+        prompt_expected_ = false;
+        if (expired.front()->sentinel_) {
+            // 哨兵之前的结果看来不会再来了，只剩哨兵一条在途
+            resync_discard_ = 0;
+            if (++resync_attempts_ >= AT_RESYNC_ATTEMPTS) {
+                ESP_LOGE(TAG, "Modem not responding, resuming command pipeline");
+                resyncing_ = false;
+            }
+        } else {
+            resync_discard_ += expired.size();
+            resync_attempts_ = 0;
+            resyncing_ = true;
         }
+        for (auto& handle : expired) {
+            handle->result_.result = AtResult::Timeout;
+        }
+        IssueCommands();
     }
-    return true;
+    for (auto& handle : expired) {
+        ESP_LOGW(TAG, "Command timeout: %.32s", handle->wire_.c_str());
+        FinishCommand(handle);
+    }
+}
+
+void AtUart::ResetCommandSync() {
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    resyncing_ = false;
+    resync_discard_ = 0;
+    resync_attempts_ = 0;
+}
+
+TickType_t AtUart::NextCommandTimeout() {
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    if (inflight_commands_.empty()) {
+        return portMAX_DELAY;
+    }
+    int32_t remaining = (int32_t)(inflight_commands_.front()->deadline_ - xTaskGetTickCount());
+    return remaining > 0 ? remaining : 0;
+}
+
+bool AtUart::WaitCommand(AtCommand& command, size_t timeout_ms, bool until_prompt) {
+    std::unique_lock<std::mutex> lock(command_mutex_);
+    auto ready = [&]() { return command.done_ || (until_prompt && command.prompted_); };
+    if (timeout_ms == SIZE_MAX) {
+        command_cv_.wait(lock, ready);
+    } else {
+        command_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+    }
+    return ready();
+}
+
+bool AtCommand::Wait(size_t timeout_ms) {
+    return owner_->WaitCommand(*this, timeout_ms, false) && result_.result == AtResult::Ok;
+}
+
+AtCommandHandle AtUart::SendCommandAsync(const std::string& command, size_t timeout_ms, AtCommandCallback callback, bool add_crlf) {
+    return QueueCommand(command, timeout_ms, add_crlf, false, std::move(callback));
+}
+
+// 同步接口建立在流水线之上: 只等待自己这条命令，不再阻塞其他任务的命令
+bool AtUart::SendCommandWithData(const std::string& command, size_t timeout_ms, bool add_crlf, const char* data, size_t data_length) {
+    if (receive_task_handle_ != nullptr && xTaskGetCurrentTaskHandle() == receive_task_handle_) {
+        // 结果由接收任务解析，在这里等待只会超时
+        ESP_LOGE(TAG, "Synchronous command in receive task: %.32s", command.c_str());
+        return false;
+    }
+
+    bool with_data = data != nullptr && data_length > 0;
+    auto handle = QueueCommand(command, timeout_ms, add_crlf, with_data, nullptr);
+    if (with_data) {
+        // 命令自身的超时保证这里一定会返回
+        WaitCommand(*handle, SIZE_MAX, true);
+        if (!handle->IsDone()) {
+            SendData(data, data_length);
+            {
+                // 数据阶段重新计时
+                std::lock_guard<std::mutex> lock(command_mutex_);
+                handle->deadline_ = xTaskGetTickCount() + handle->timeout_ticks_;
+            }
+            xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_ISSUED);
+        }
+    }
+    WaitCommand(*handle, SIZE_MAX, false);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    response_ = handle->result_.response;
+    cme_error_code_ = handle->result_.cme_error_code;
+    return handle->result_.result == AtResult::Ok;
 }
 
 bool AtUart::SendCommand(const std::string& command, size_t timeout_ms, bool add_crlf) {
     return SendCommandWithData(command, timeout_ms, add_crlf, nullptr, 0);
 }
 
+// 只有 "AT+" 开头的扩展命令可以用 ';' 串联
+static bool IsExtendedCommand(const std::string& command) {
+    return command.size() > 3 && command.compare(0, 3, "AT+") == 0;
+}
+
+bool AtUart::SendCommands(const std::vector<std::string>& commands, size_t timeout_ms) {
+    if (receive_task_handle_ != nullptr && xTaskGetCurrentTaskHandle() == receive_task_handle_) {
+        ESP_LOGE(TAG, "Synchronous command in receive task: batch of %u", commands.size());
+        return false;
+    }
+
+    // 先全部排队，流水线会连续发出，再依次等待
+    std::vector<AtCommandHandle> handles;
+    handles.reserve(commands.size());
+    std::string line;
+    for (auto& command : commands) {
+        if (command_chaining_ && IsExtendedCommand(command)) {
+            // 后面的命令去掉 "AT" 接到前一条之后: AT+A;+B
+            if (!line.empty() && line.size() + command.size() - 1 <= AT_BATCH_LINE_MAX) {
+                line += ';';
+                line.append(command, 2);
+                continue;
+            }
+            if (!line.empty()) {
+                handles.push_back(SendCommandAsync(line, timeout_ms));
+            }
+            line = command;
+            continue;
+        }
+        if (!line.empty()) {
+            handles.push_back(SendCommandAsync(line, timeout_ms));
+            line.clear();
+        }
+        handles.push_back(SendCommandAsync(command, timeout_ms));
+    }
+    if (!line.empty()) {
+        handles.push_back(SendCommandAsync(line, timeout_ms));
+    }
+
+    const AtCommandResult* failure = nullptr;
+    for (auto& handle : handles) {
+        WaitCommand(*handle, SIZE_MAX, false);
+        if (failure == nullptr && handle->result_.result != AtResult::Ok) {
+            failure = &handle->result_;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& result = failure != nullptr ? *failure : handles.back()->result_;
+    response_ = result.response;
+    cme_error_code_ = result.cme_error_code;
+    return failure == nullptr;
+}
+
+bool AtUart::ApplyConfig(const std::vector<AtConfigItem>& items, size_t timeout_ms) {
+    std::vector<const AtConfigItem*> pending;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        for (auto& item : items) {
+            auto it = config_cache_.find(item.key);
+            if (it == config_cache_.end() || it->second != item.command) {
+                pending.push_back(&item);
+            }
+        }
+    }
+    if (pending.empty()) {
+        return true;
+    }
+
+    std::vector<std::string> commands;
+    commands.reserve(pending.size());
+    for (auto item : pending) {
+        commands.push_back(item->command);
+    }
+    bool success = SendCommands(commands, timeout_ms);
+
+    // 串联时无法知道失败前哪些已生效，整批都不缓存
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    for (auto item : pending) {
+        if (success) {
+            config_cache_[item->key] = item->command;
+        } else {
+            config_cache_.erase(item->key);
+        }
+    }
+    return success;
+}
+
+void AtUart::InvalidateConfig(std::string_view prefix) {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    auto it = config_cache_.lower_bound(prefix);
+    while (it != config_cache_.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        it = config_cache_.erase(it);
+    }
+}
+
 std::list<UrcCallback>::iterator AtUart::RegisterUrcCallback(UrcCallback callback) {
     std::lock_guard<std::mutex> lock(mutex_);
     return urc_callbacks_.insert(urc_callbacks_.end(), callback);
@@ -352,47 +899,176 @@ void AtUart::UnregisterUrcCallback(std::list<UrcCallback>::iterator iterator) {
     urc_callbacks_.erase(iterator);
 }
 
+std::vector<UrcRegistration> AtUart::RegisterUrcHandlers(std::initializer_list<UrcKey> keys, int link_id, const UrcCallback& callback) {
+    std::vector<UrcRegistration> registrations;
+    registrations.reserve(keys.size());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& key : keys) {
+        uint32_t hash = HashUrcCommand(key.command);
+        int handler_link = AT_URC_ANY_LINK;
+        if (key.link_index >= 0 && link_id != AT_URC_ANY_LINK) {
+            handler_link = link_id;
+            auto entry = std::find_if(urc_link_indexes_.begin(), urc_link_indexes_.end(), [&](const UrcLinkIndex& e) {
+                return e.hash == hash && e.command == key.command;
+            });
+            if (entry == urc_link_indexes_.end()) {
+                urc_link_indexes_.push_back({hash, std::string(key.command), key.link_index});
+            } else if (entry->index != key.link_index) {
+                ESP_LOGE(TAG, "URC %.*s link index mismatch: %d vs %d", (int)key.command.size(), key.command.data(), entry->index, key.link_index);
+            }
+        }
+
+        auto* bucket = &urc_buckets_[UrcBucket(hash, handler_link)];
+        auto it = bucket->insert(bucket->end(), UrcHandler{hash, handler_link, std::string(key.command), callback});
+        registrations.push_back({bucket, it});
+    }
+    return registrations;
+}
+
+void AtUart::UnregisterUrcHandlers(std::vector<UrcRegistration>& registrations) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& registration : registrations) {
+        registration.bucket->erase(registration.iterator);
+    }
+    registrations.clear();
+}
+
+void AtUart::SetBinaryUrc(std::string_view command, int link_index, int length_index, int link_id, bool enable) {
+    std::string prefix = "+" + std::string(command) + ": ";
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = std::find_if(binary_urcs_.begin(), binary_urcs_.end(), [&](const BinaryUrc& e) {
+        return e.link_id == link_id && e.prefix == prefix;
+    });
+    if (enable && entry == binary_urcs_.end()) {
+        binary_urcs_.push_back({std::move(prefix), link_index, length_index, link_id});
+    } else if (!enable && entry != binary_urcs_.end()) {
+        binary_urcs_.erase(entry);
+    }
+}
+
+bool AtUart::EnableFlowControl() {
+    if (!transport_->HasFlowControl()) {
+        return false;
+    }
+    if (!flow_control_enabled_) {
+        if (!SendCommand("AT+IFC=2,2")) {
+            ESP_LOGW(TAG, "Modem rejected RTS/CTS flow control");
+            return false;
+        }
+        transport_->EnableFlowControl();
+        flow_control_enabled_ = true;
+        ESP_LOGI(TAG, "RTS/CTS flow control enabled");
+    }
+    return true;
+}
+
 void AtUart::SetDtrPin(bool high) {
+#if !CONFIG_IDF_TARGET_LINUX
     if (dtr_pin_ != GPIO_NUM_NC) {
         ESP_LOGD(TAG, "Set DTR pin %d to %d", dtr_pin_, high ? 1 : 0);
-        gpio_set_level(dtr_pin_, high ? 1 : 0);
+        gpio_set_level((gpio_num_t)dtr_pin_, high ? 1 : 0);
         vTaskDelay(pdMS_TO_TICKS(20));
     }
+#endif
 }
 
-static const char hex_chars[] = "0123456789ABCDEF";
-// 辅助函数，将单个十六进制字符转换为对应的数值
-inline uint8_t CharToHex(char c) {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
-    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-    return 0;  // 对于无效输入，返回0
+void AtUart::SetTranscript(std::shared_ptr<AtTranscriptWriter> transcript) {
+    std::lock_guard<std::mutex> lock(transcript_mutex_);
+    transcript_ = std::move(transcript);
 }
 
-void AtUart::EncodeHexAppend(std::string& dest, const char* data, size_t length) {
-    dest.reserve(dest.size() + length * 2 + 4);  // 预分配空间，多分配4个字节用于\r\n\0
-    for (size_t i = 0; i < length; i++) {
-        dest.push_back(hex_chars[(data[i] & 0xF0) >> 4]);
-        dest.push_back(hex_chars[data[i] & 0x0F]);
+std::shared_ptr<AtTranscriptWriter> AtUart::GetTranscript() {
+    std::lock_guard<std::mutex> lock(transcript_mutex_);
+    return transcript_;
+}
+
+// 十六进制编码: 查表，每项是一个字节对应的两个字符，按 16 位整体写出
+struct HexEncodeTable {
+    uint16_t entries[256];
+
+    constexpr HexEncodeTable() : entries() {
+        const char digits[] = "0123456789ABCDEF";
+        for (int i = 0; i < 256; i++) {
+            // 小端: 低字节在前，即高半字节的字符先出现
+            entries[i] = (uint16_t)((uint8_t)digits[i >> 4] | ((uint8_t)digits[i & 0x0F] << 8));
+        }
+    }
+};
+static constexpr HexEncodeTable hex_encode_table;
+
+// 十六进制解码: 按机器字宽 (ESP32 上 32 位) 同时换算多个字符，不查表也不分支。
+// '0'-'9' 低 4 位即数值，'A'-'F'/'a'-'f' 的第 6 位为 1，低 4 位加 9 即数值；非法字符的结果无意义
+typedef uintptr_t hex_word_t;
+static constexpr hex_word_t kHexOnes = (hex_word_t)~0 / 0xFF;        // 0x0101...
+static constexpr hex_word_t kHexLanes = (hex_word_t)~0 / 0xFFFF * 0xFF; // 0x00FF00FF...
+
+// 返回值的低 sizeof(hex_word_t) / 2 个字节为解码结果
+static inline hex_word_t DecodeHexWord(hex_word_t word) {
+    hex_word_t nibbles = (word & (kHexOnes * 0x0F)) + ((word >> 6) & kHexOnes) * 9;
+    // 每 16 位中: 第一个字符为高半字节，第二个为低半字节
+    hex_word_t pairs = ((nibbles & kHexLanes) << 4) | ((nibbles >> 8) & kHexLanes);
+    if constexpr (sizeof(hex_word_t) == 8) {
+        pairs = (pairs | (pairs >> 8)) & 0x0000FFFF0000FFFFull;
+        return pairs | (pairs >> 16);
+    } else {
+        return (pairs | (pairs >> 8)) & 0xFFFF;
     }
 }
 
-void AtUart::DecodeHexAppend(std::string& dest, const char* data, size_t length) {
-    dest.reserve(dest.size() + length / 2 + 4);  // 预分配空间，多分配4个字节用于\r\n\0
-    for (size_t i = 0; i < length; i += 2) {
-        char byte = (CharToHex(data[i]) << 4) | CharToHex(data[i + 1]);
-        dest.push_back(byte);
+size_t AtUart::EncodeHex(const char* data, size_t length, char* out) {
+    const uint8_t* src = (const uint8_t*)data;
+    size_t i = 0;
+    // 一次处理 2 个字节，合成一个 32 位字写出
+    for (; i + 2 <= length; i += 2) {
+        uint32_t word = (uint32_t)hex_encode_table.entries[src[i]]
+            | ((uint32_t)hex_encode_table.entries[src[i + 1]] << 16);
+        memcpy(out + i * 2, &word, sizeof(word));
+    }
+    if (i < length) {
+        memcpy(out + i * 2, &hex_encode_table.entries[src[i]], 2);
+    }
+    return length * 2;
+}
+
+size_t AtUart::DecodeHex(const char* data, size_t length, char* out) {
+    const size_t step = sizeof(hex_word_t) / 2;
+    size_t count = length / 2;
+    size_t i = 0;
+    // 每次读一个字、写半个字。先读后写，写入位置不超过读取位置，所以 out == data 的原地解码也是安全的
+    for (; i + step <= count; i += step) {
+        hex_word_t word;
+        memcpy(&word, data + i * 2, sizeof(word));
+        hex_word_t bytes = DecodeHexWord(word);
+        memcpy(out + i, &bytes, step);
+    }
+    for (; i < count; i++) {
+        hex_word_t word = (uint8_t)data[i * 2] | ((hex_word_t)(uint8_t)data[i * 2 + 1] << 8);
+        out[i] = (char)DecodeHexWord(word);
     }
+    return count;
+}
+
+void AtUart::EncodeHexAppend(std::string& dest, const char* data, size_t length) {
+    size_t offset = dest.size();
+    dest.resize(offset + length * 2);
+    EncodeHex(data, length, dest.data() + offset);
 }
 
-std::string AtUart::EncodeHex(const std::string& data) {
+void AtUart::DecodeHexAppend(std::string& dest, const char* data, size_t length) {
+    size_t offset = dest.size();
+    dest.resize(offset + length / 2);
+    DecodeHex(data, length, dest.data() + offset);
+}
+
+std::string AtUart::EncodeHex(std::string_view data) {
     std::string encoded;
-    EncodeHexAppend(encoded, data.c_str(), data.size());
+    EncodeHexAppend(encoded, data.data(), data.size());
     return encoded;
 }
 
-std::string AtUart::DecodeHex(const std::string& data) {
+std::string AtUart::DecodeHex(std::string_view data) {
     std::string decoded;
-    DecodeHexAppend(decoded, data.c_str(), data.size());
+    DecodeHexAppend(decoded, data.data(), data.size());
     return decoded;
-}
\ No newline at end of file
+}
@@ -21,11 +21,26 @@ Ec801EAtModem::Ec801EAtModem(std::shared_ptr<AtUart> at_uart) : AtModem(at_uart)
     at_uart_->SendCommand("ATE0");
     // 设置 URC 端口为 UART1
     at_uart_->SendCommand("AT+QURCCFG=\"urcport\",\"uart1\"");
+    // 支持用 ';' 串联扩展命令，批量配置合并为一行
+    at_uart_->SetCommandChaining(true);
 }
 
-void Ec801EAtModem::HandleUrc(const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+void Ec801EAtModem::HandleUrc(std::string_view command, const AtArguments& arguments) {
     // Handle Common URC
     AtModem::HandleUrc(command, arguments);
+    // +QIND: "csq",<rssi>,<ber>
+    if (command == "QIND" && arguments.size() >= 2 && arguments[0].string_value == "csq") {
+        csq_ = arguments[1].int_value();
+    } else if (command == "RDY") {
+        // 模组重启后之前下发的配置都已失效，信号强度上报也随之停止，重新注网时再订阅
+        at_uart_->InvalidateConfig();
+        csq_reporting_ = false;
+    }
+}
+
+void Ec801EAtModem::AppendReportConfig(std::vector<AtConfigItem>& config) {
+    // 信号强度变化时主动上报，不保存到模组 NVRAM
+    config.push_back({"qind/csq", "AT+QINDCFG=\"csq\",1,0"});
 }
 
 bool Ec801EAtModem::SetSleepMode(bool enable, int delay_seconds) {
@@ -6,17 +6,20 @@
 Ec801EMqtt::Ec801EMqtt(std::shared_ptr<AtUart> at_uart, int mqtt_id) : at_uart_(at_uart), mqtt_id_(mqtt_id) {
     event_group_handle_ = xEventGroupCreate();
 
-    urc_callback_it_ = at_uart_->RegisterUrcCallback([this](const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+    urc_registrations_ = at_uart_->RegisterUrcHandlers({{"QMTRECV", 0}, {"QMTSTAT", 0}, {"QMTCONN", 0}, {"QMTOPEN", 0}, {"QMTDISC", 0}}, mqtt_id_,
+        [this](std::string_view command, const AtArguments& arguments) {
         if (command == "QMTRECV" && arguments.size() >= 4) {
-            if (arguments[0].int_value == mqtt_id_) {
-                auto topic = arguments[2].string_value;
+            if (arguments[0].int_value() == mqtt_id_) {
                 if (on_message_callback_) {
-                    on_message_callback_(topic, at_uart_->DecodeHex(arguments[3].string_value));
+                    message_topic_ = arguments[2].string_value;
+                    message_payload_.clear();
+                    at_uart_->DecodeHexAppend(message_payload_, arguments[3].string_value.data(), arguments[3].string_value.size());
+                    on_message_callback_(message_topic_, message_payload_);
                 }
             }
         } else if (command == "QMTSTAT" && arguments.size() == 2) {
-            if (arguments[0].int_value == mqtt_id_) {
-                auto error_code = arguments[1].int_value;
+            if (arguments[0].int_value() == mqtt_id_) {
+                auto error_code = arguments[1].int_value();
                 if (error_code != 0) {
                     auto error_message = ErrorToString(error_code);
                     ESP_LOGE(TAG, "MQTT error occurred: %s", error_message.c_str());
@@ -33,8 +36,8 @@ Ec801EMqtt::Ec801EMqtt(std::shared_ptr<AtUart> at_uart, int mqtt_id) : at_uart_(
                 }
             }
         } else if (command == "QMTCONN" && arguments.size() == 3) {
-            if (arguments[0].int_value == mqtt_id_) {
-                error_code_ = arguments[2].int_value;
+            if (arguments[0].int_value() == mqtt_id_) {
+                error_code_ = arguments[2].int_value();
                 if (error_code_ == 0) {
                     if (!connected_) {
                         connected_ = true;
@@ -54,8 +57,8 @@ Ec801EMqtt::Ec801EMqtt(std::shared_ptr<AtUart> at_uart, int mqtt_id) : at_uart_(
                 }
             }
         } else if (command == "QMTOPEN" && arguments.size() == 2) {
-            if (arguments[0].int_value == mqtt_id_) {
-                error_code_ = arguments[1].int_value;
+            if (arguments[0].int_value() == mqtt_id_) {
+                error_code_ = arguments[1].int_value();
                 if (error_code_ == 0) {
                     xEventGroupSetBits(event_group_handle_, EC801E_MQTT_OPEN_COMPLETE);
                 } else {
@@ -63,8 +66,8 @@ Ec801EMqtt::Ec801EMqtt(std::shared_ptr<AtUart> at_uart, int mqtt_id) : at_uart_(
                 }
             }
         } else if (command == "QMTDISC" && arguments.size() == 2) {
-            if (arguments[0].int_value == mqtt_id_) {
-                if (arguments[1].int_value == 0) {
+            if (arguments[0].int_value() == mqtt_id_) {
+                if (arguments[1].int_value() == 0) {
                     xEventGroupSetBits(event_group_handle_, EC801E_MQTT_DISCONNECTED_EVENT);
                 } else {
                     ESP_LOGE(TAG, "Failed to disconnect from MQTT broker");
@@ -75,43 +78,38 @@ Ec801EMqtt::Ec801EMqtt(std::shared_ptr<AtUart> at_uart, int mqtt_id) : at_uart_(
 }
 
 Ec801EMqtt::~Ec801EMqtt() {
-    at_uart_->UnregisterUrcCallback(urc_callback_it_);
+    at_uart_->UnregisterUrcHandlers(urc_registrations_);
     vEventGroupDelete(event_group_handle_);
 }
 
 bool Ec801EMqtt::Connect(const std::string broker_address, int broker_port, const std::string client_id, const std::string username, const std::string password) {
     EventBits_t bits;
 
+    // 配置一次批量下发，重连时已生效的项直接跳过
+    std::string id = std::to_string(mqtt_id_);
+    std::string prefix = "qmt" + id + "/";
     if (broker_port == 8883) {
         // Config SSL Context
-        at_uart_->SendCommand("AT+QSSLCFG=\"sslversion\",2,4;+QSSLCFG=\"ciphersuite\",2,0xFFFF;+QSSLCFG=\"seclevel\",2,0");
-        if (!at_uart_->SendCommand(std::string("AT+QMTCFG=\"ssl\",") + std::to_string(mqtt_id_) + ",1,2")) {
-            ESP_LOGE(TAG, "Failed to set MQTT to use SSL");
-            return false;
-        }
+        at_uart_->ApplyConfig({
+            {"ssl2/sslversion", "AT+QSSLCFG=\"sslversion\",2,4"},
+            {"ssl2/ciphersuite", "AT+QSSLCFG=\"ciphersuite\",2,0xFFFF"},
+            {"ssl2/seclevel", "AT+QSSLCFG=\"seclevel\",2,0"},
+        });
     }
-
-    // Set version
-    if (!at_uart_->SendCommand(std::string("AT+QMTCFG=\"version\",") + std::to_string(mqtt_id_) + ",4")) {
-        ESP_LOGE(TAG, "Failed to set MQTT version to 3.1.1");
-        return false;
+    std::vector<AtConfigItem> config;
+    if (broker_port == 8883) {
+        config.push_back({prefix + "ssl", "AT+QMTCFG=\"ssl\"," + id + ",1,2"});
     }
-
+    // Set version 3.1.1
+    config.push_back({prefix + "version", "AT+QMTCFG=\"version\"," + id + ",4"});
     // Set clean session
-    if (!at_uart_->SendCommand(std::string("AT+QMTCFG=\"session\",") + std::to_string(mqtt_id_) + ",1")) {
-        ESP_LOGE(TAG, "Failed to set MQTT clean session");
-        return false;
-    }
-
+    config.push_back({prefix + "session", "AT+QMTCFG=\"session\"," + id + ",1"});
     // Set keep alive
-    if (!at_uart_->SendCommand(std::string("AT+QMTCFG=\"keepalive\",") + std::to_string(mqtt_id_) + "," + std::to_string(keep_alive_seconds_))) {
-        ESP_LOGE(TAG, "Failed to set MQTT keep alive");
-        return false;
-    }
-
+    config.push_back({prefix + "keepalive", "AT+QMTCFG=\"keepalive\"," + id + "," + std::to_string(keep_alive_seconds_)});
     // Set HEX encoding (ASCII for sending, HEX for receiving)
-    if (!at_uart_->SendCommand("AT+QMTCFG=\"dataformat\"," + std::to_string(mqtt_id_) + ",0,1")) {
-        ESP_LOGE(TAG, "Failed to set MQTT to use HEX encoding");
+    config.push_back({prefix + "dataformat", "AT+QMTCFG=\"dataformat\"," + id + ",0,1"});
+    if (!at_uart_->ApplyConfig(config)) {
+        ESP_LOGE(TAG, "Failed to configure MQTT, error=%d", at_uart_->GetCmeErrorCode());
         return false;
     }
 
@@ -134,6 +132,8 @@ bool Ec801EMqtt::Connect(const std::string broker_address, int broker_port, cons
         };
         const char* message = error_code_ < 6 ? error_code_str[error_code_] : "Unknown error";
         ESP_LOGE(TAG, "Failed to open MQTT connection: %s", message);
+        // 模组可能已重启而丢失配置，下次重新下发
+        at_uart_->InvalidateConfig(prefix);
 
         if (error_code_ == 2) { // MQTT 标识符被占用
             at_uart_->SendCommand(std::string("AT+QMTDISC=") + std::to_string(mqtt_id_));
@@ -147,6 +147,7 @@ bool Ec801EMqtt::Connect(const std::string broker_address, int broker_port, cons
         return false;
     } else if (!(bits & EC801E_MQTT_OPEN_COMPLETE)) {
         ESP_LOGE(TAG, "MQTT connection timeout");
+        at_uart_->InvalidateConfig(prefix);
         return false;
     }
 
@@ -36,8 +36,9 @@ private:
     int error_code_ = 0;
     EventGroupHandle_t event_group_handle_;
     std::string message_payload_;
+    std::string message_topic_;  // 跨 URC 复用，避免每条消息分配
 
-    std::list<UrcCallback>::iterator urc_callback_it_;
+    std::vector<UrcRegistration> urc_registrations_;
 
     std::string ErrorToString(int error_code);
 };
@@ -8,10 +8,11 @@
 Ec801ESsl::Ec801ESsl(std::shared_ptr<AtUart> at_uart, int ssl_id) : at_uart_(at_uart), ssl_id_(ssl_id) {
     event_group_handle_ = xEventGroupCreate();
 
-    urc_callback_it_ = at_uart_->RegisterUrcCallback([this](const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+    urc_registrations_ = at_uart_->RegisterUrcHandlers({{"QSSLOPEN", 0}, {"QSSLCLOSE", 0}, {"QISEND", 0}, {"QSSLURC", 1}, {"QSSLSTATE", 0}, {"FIFO_OVERFLOW"}}, ssl_id_,
+        [this](std::string_view command, const AtArguments& arguments) {
         if (command == "QSSLOPEN" && arguments.size() == 2) {
-            if (arguments[0].int_value == ssl_id_ && !instance_active_) {
-                if (arguments[1].int_value == 0) {
+            if (arguments[0].int_value() == ssl_id_ && !instance_active_) {
+                if (arguments[1].int_value() == 0) {
                     connected_ = true;
                     instance_active_ = true;
                     xEventGroupClearBits(event_group_handle_, EC801E_SSL_DISCONNECTED | EC801E_SSL_ERROR);
@@ -22,22 +23,24 @@ Ec801ESsl::Ec801ESsl(std::shared_ptr<AtUart> at_uart, int ssl_id) : at_uart_(at_
                 }
             }
         } else if (command == "QSSLCLOSE" && arguments.size() == 1) {
-            if (arguments[0].int_value == ssl_id_) {
+            if (arguments[0].int_value() == ssl_id_) {
                 instance_active_ = false;
             }
         } else if (command == "QISEND" && arguments.size() == 3) {
-            if (arguments[0].int_value == ssl_id_) {
-                if (arguments[1].int_value == 0) {
+            if (arguments[0].int_value() == ssl_id_) {
+                if (arguments[1].int_value() == 0) {
                     xEventGroupSetBits(event_group_handle_, EC801E_SSL_SEND_COMPLETE);
                 } else {
                     xEventGroupSetBits(event_group_handle_, EC801E_SSL_ERROR);
                 }
             }
         } else if (command == "QSSLURC" && arguments.size() >= 2) {
-            if (arguments[1].int_value == ssl_id_) {
+            if (arguments[1].int_value() == ssl_id_) {
                 if (arguments[0].string_value == "recv" && arguments.size() >= 4) {
-                    if (stream_callback_) {
-                        stream_callback_(at_uart_->DecodeHex(arguments[3].string_value));
+                    if (connected_ && stream_callback_) {
+                        rx_payload_.clear();
+                        at_uart_->DecodeHexAppend(rx_payload_, arguments[3].string_value.data(), arguments[3].string_value.size());
+                        stream_callback_(rx_payload_);
                     }
                 } else if (arguments[0].string_value == "closed") {
                     if (connected_) {
@@ -49,25 +52,33 @@ Ec801ESsl::Ec801ESsl(std::shared_ptr<AtUart> at_uart, int ssl_id) : at_uart_(at_
                     }
                     xEventGroupSetBits(event_group_handle_, EC801E_SSL_DISCONNECTED);
                 } else {
-                    ESP_LOGE(TAG, "Unknown QIURC command: %s", arguments[0].string_value.c_str());
+                    ESP_LOGE(TAG, "Unknown QIURC command: %.*s", (int)arguments[0].string_value.size(), arguments[0].string_value.data());
                 }
             }
         } else if (command == "QSSLSTATE" && arguments.size() > 5) {
-            if (arguments[0].int_value == ssl_id_) {
-                connected_ = arguments[5].int_value == 2;
+            if (arguments[0].int_value() == ssl_id_) {
+                connected_ = arguments[5].int_value() == 2;
                 instance_active_ = true;
                 xEventGroupSetBits(event_group_handle_, EC801E_SSL_INITIALIZED);
             }
         } else if (command == "FIFO_OVERFLOW") {
-            xEventGroupSetBits(event_group_handle_, EC801E_SSL_ERROR);
-            Disconnect();
+            // 丢失的字节里可能有本连接的数据，字节流已不完整，按断开处理。
+            // 接收任务中不能发同步命令，instance_active_ 保持 true，由之后的 Disconnect() 关闭模组上的连接
+            if (connected_) {
+                ESP_LOGE(TAG, "Connection %d lost data on UART FIFO overflow", ssl_id_);
+                connected_ = false;
+                xEventGroupSetBits(event_group_handle_, EC801E_SSL_ERROR);
+                if (disconnect_callback_) {
+                    disconnect_callback_();
+                }
+            }
         }
     });
 }
 
 Ec801ESsl::~Ec801ESsl() {
     Disconnect();
-    at_uart_->UnregisterUrcCallback(urc_callback_it_);
+    at_uart_->UnregisterUrcHandlers(urc_registrations_);
 }
 
 bool Ec801ESsl::Connect(const std::string& host, int port) {
@@ -75,10 +86,20 @@ bool Ec801ESsl::Connect(const std::string& host, int port) {
     xEventGroupClearBits(event_group_handle_, EC801E_SSL_CONNECTED | EC801E_SSL_DISCONNECTED | EC801E_SSL_ERROR);
 
     // Keep data in one line; Use HEX encoding in response
-    at_uart_->SendCommand("AT+QICFG=\"close/mode\",1;+QICFG=\"viewmode\",1;+QICFG=\"sendinfo\",1;+QICFG=\"dataformat\",0,1");
+    // 所有连接共用，首次连接时串联为一行下发，之后跳过
+    at_uart_->ApplyConfig({
+        {"qi/close/mode", "AT+QICFG=\"close/mode\",1"},
+        {"qi/viewmode", "AT+QICFG=\"viewmode\",1"},
+        {"qi/sendinfo", "AT+QICFG=\"sendinfo\",1"},
+        {"qi/dataformat", "AT+QICFG=\"dataformat\",0,1"},
+    });
 
     // Config SSL Context
-    at_uart_->SendCommand("AT+QSSLCFG=\"sslversion\",1,4;+QSSLCFG=\"ciphersuite\",1,0xFFFF;+QSSLCFG=\"seclevel\",1,0");
+    at_uart_->ApplyConfig({
+        {"ssl1/sslversion", "AT+QSSLCFG=\"sslversion\",1,4"},
+        {"ssl1/ciphersuite", "AT+QSSLCFG=\"ciphersuite\",1,0xFFFF"},
+        {"ssl1/seclevel", "AT+QSSLCFG=\"seclevel\",1,0"},
+    });
     // at_uart_->SendCommand("AT+QSSLCFG=\"cacert\",1,\"UFS:cacert.pem\"");
 
     // 检查这个 id 是否已经连接
@@ -96,6 +117,9 @@ bool Ec801ESsl::Connect(const std::string& host, int port) {
     command = "AT+QSSLOPEN=1,1," + std::to_string(ssl_id_) + ",\"" + host + "\"," + std::to_string(port) + ",1";
     if (!at_uart_->SendCommand(command)) {
         ESP_LOGE(TAG, "Failed to open TCP connection");
+        // 模组可能已重启而丢失配置，下次重新下发
+        at_uart_->InvalidateConfig("qi/");
+        at_uart_->InvalidateConfig("ssl1/");
         return false;
     }
 
@@ -103,6 +127,8 @@ bool Ec801ESsl::Connect(const std::string& host, int port) {
     auto bits = xEventGroupWaitBits(event_group_handle_, EC801E_SSL_CONNECTED | EC801E_SSL_ERROR, pdTRUE, pdFALSE, SSL_CONNECT_TIMEOUT_MS / portTICK_PERIOD_MS);
     if (bits & EC801E_SSL_ERROR) {
         ESP_LOGE(TAG, "Failed to connect to %s:%d", host.c_str(), port);
+        at_uart_->InvalidateConfig("qi/");
+        at_uart_->InvalidateConfig("ssl1/");
         return false;
     }
     return true;
@@ -8,10 +8,11 @@
 Ec801EUdp::Ec801EUdp(std::shared_ptr<AtUart> at_uart, int udp_id) : at_uart_(at_uart), udp_id_(udp_id) {
     event_group_handle_ = xEventGroupCreate();
 
-    urc_callback_it_ = at_uart_->RegisterUrcCallback([this](const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+    urc_registrations_ = at_uart_->RegisterUrcHandlers({{"QIOPEN", 0}, {"QISEND", 0}, {"QIURC", 1}, {"QISTATE", 0}, {"FIFO_OVERFLOW"}}, udp_id_,
+        [this](std::string_view command, const AtArguments& arguments) {
         if (command == "QIOPEN" && arguments.size() == 2) {
-            if (arguments[0].int_value == udp_id_) {
-                connected_ = arguments[1].int_value == 0;
+            if (arguments[0].int_value() == udp_id_) {
+                connected_ = arguments[1].int_value() == 0;
                 if (connected_) {
                     instance_active_ = true;
                     xEventGroupClearBits(event_group_handle_, EC801E_UDP_DISCONNECTED | EC801E_UDP_ERROR);
@@ -21,43 +22,47 @@ Ec801EUdp::Ec801EUdp(std::shared_ptr<AtUart> at_uart, int udp_id) : at_uart_(at_
                 }
             }
         } else if (command == "QISEND" && arguments.size() == 3) {
-            if (arguments[0].int_value == udp_id_) {
-                if (arguments[1].int_value == 0) {
+            if (arguments[0].int_value() == udp_id_) {
+                if (arguments[1].int_value() == 0) {
                     xEventGroupSetBits(event_group_handle_, EC801E_UDP_SEND_COMPLETE);
                 } else {
                     xEventGroupSetBits(event_group_handle_, EC801E_UDP_SEND_FAILED);
                 }
             }
         } else if (command == "QIURC" && arguments.size() >= 2) {
-            if (arguments[1].int_value == udp_id_) {
+            if (arguments[1].int_value() == udp_id_) {
                 if (arguments[0].string_value == "recv" && arguments.size() >= 4) {
                     if (connected_ && message_callback_) {
-                        message_callback_(at_uart_->DecodeHex(arguments[3].string_value));
+                        rx_payload_.clear();
+                        at_uart_->DecodeHexAppend(rx_payload_, arguments[3].string_value.data(), arguments[3].string_value.size());
+                        message_callback_(rx_payload_);
                     }
                 } else if (arguments[0].string_value == "closed") {
                     connected_ = false;
                     instance_active_ = false;
                     xEventGroupSetBits(event_group_handle_, EC801E_UDP_DISCONNECTED);
                 } else {
-                    ESP_LOGE(TAG, "Unknown QIURC command: %s", arguments[0].string_value.c_str());
+                    ESP_LOGE(TAG, "Unknown QIURC command: %.*s", (int)arguments[0].string_value.size(), arguments[0].string_value.data());
                 }
             }
         } else if (command == "QISTATE" && arguments.size() > 5) {
-            if (arguments[0].int_value == udp_id_) {
-                connected_ = arguments[5].int_value == 2;
+            if (arguments[0].int_value() == udp_id_) {
+                connected_ = arguments[5].int_value() == 2;
                 instance_active_ = true;
                 xEventGroupSetBits(event_group_handle_, EC801E_UDP_INITIALIZED);
             }
         } else if (command == "FIFO_OVERFLOW") {
-            xEventGroupSetBits(event_group_handle_, EC801E_UDP_ERROR);
-            Disconnect();
+            // 被截断的数据报已由解析器丢弃，数据报之间互不依赖，丢包对 UDP 是正常情况，只记录
+            if (connected_) {
+                ESP_LOGW(TAG, "Connection %d may have lost datagrams on UART FIFO overflow", udp_id_);
+            }
         }
     });
 }
 
 Ec801EUdp::~Ec801EUdp() {
     Disconnect();
-    at_uart_->UnregisterUrcCallback(urc_callback_it_);
+    at_uart_->UnregisterUrcHandlers(urc_registrations_);
     if (event_group_handle_) {
         vEventGroupDelete(event_group_handle_);
     }
@@ -68,7 +73,13 @@ bool Ec801EUdp::Connect(const std::string& host, int port) {
     xEventGroupClearBits(event_group_handle_, EC801E_UDP_CONNECTED | EC801E_UDP_DISCONNECTED | EC801E_UDP_ERROR);
 
     // Keep data in one line; Use HEX encoding in response
-    at_uart_->SendCommand("AT+QICFG=\"close/mode\",1;+QICFG=\"viewmode\",1;+QICFG=\"sendinfo\",1;+QICFG=\"dataformat\",0,1");
+    // 所有连接共用，首次连接时串联为一行下发，之后跳过
+    at_uart_->ApplyConfig({
+        {"qi/close/mode", "AT+QICFG=\"close/mode\",1"},
+        {"qi/viewmode", "AT+QICFG=\"viewmode\",1"},
+        {"qi/sendinfo", "AT+QICFG=\"sendinfo\",1"},
+        {"qi/dataformat", "AT+QICFG=\"dataformat\",0,1"},
+    });
 
     // 检查这个 id 是否已经连接
     std::string command = "AT+QISTATE=1," + std::to_string(udp_id_);
@@ -85,6 +96,8 @@ bool Ec801EUdp::Connect(const std::string& host, int port) {
     command = "AT+QIOPEN=1," + std::to_string(udp_id_) + ",\"UDP\",\"" + host + "\"," + std::to_string(port) + ",0,1";
     if (!at_uart_->SendCommand(command)) {
         ESP_LOGE(TAG, "Failed to open UDP connection");
+        // 模组可能已重启而丢失配置，下次重新下发
+        at_uart_->InvalidateConfig("qi/");
         return false;
     }
 
@@ -92,6 +105,7 @@ bool Ec801EUdp::Connect(const std::string& host, int port) {
     auto bits = xEventGroupWaitBits(event_group_handle_, EC801E_UDP_CONNECTED | EC801E_UDP_ERROR, pdTRUE, pdFALSE, UDP_CONNECT_TIMEOUT_MS / portTICK_PERIOD_MS);
     if (bits & EC801E_UDP_ERROR) {
         ESP_LOGE(TAG, "Failed to connect to %s:%d", host.c_str(), port);
+        at_uart_->InvalidateConfig("qi/");
         return false;
     }
     return true;
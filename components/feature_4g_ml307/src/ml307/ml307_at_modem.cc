@@ -28,18 +28,20 @@ void Ml307AtModem::ResetConnections() {
     at_uart_->SendCommand("AT+MHTTPDEL=3");
 }
 
-void Ml307AtModem::HandleUrc(const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+void Ml307AtModem::HandleUrc(std::string_view command, const AtArguments& arguments) {
     // Handle Common URC
     AtModem::HandleUrc(command, arguments);
     // Handle ML307 URC
     if (command == "MIPCALL" && arguments.size() >= 3) {
-        if (arguments[1].int_value == 1) {
+        if (arguments[1].int_value() == 1) {
             auto ip = arguments[2].string_value;
-            ESP_LOGI(TAG, "PDP Context %d IP: %s", arguments[0].int_value, ip.c_str());
+            ESP_LOGI(TAG, "PDP Context %d IP: %.*s", arguments[0].int_value(), (int)ip.size(), ip.data());
             network_ready_ = true;
             xEventGroupSetBits(event_group_handle_, AT_EVENT_NETWORK_READY);
         }
     } else if (command == "MATREADY") {
+        // 模组重启后之前下发的配置都已失效
+        at_uart_->InvalidateConfig();
         if (network_ready_) {
             network_ready_ = false;
             if (on_network_state_changed_) {
@@ -51,6 +53,7 @@ void Ml307AtModem::HandleUrc(const std::string& command, const std::vector<AtArg
 
 void Ml307AtModem::Reboot() {
     at_uart_->SendCommand("AT+MREBOOT=0");
+    at_uart_->InvalidateConfig();
 }
 
 bool Ml307AtModem::SetSleepMode(bool enable, int delay_seconds) {
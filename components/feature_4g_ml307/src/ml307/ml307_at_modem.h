@@ -26,7 +26,7 @@ public:
     std::unique_ptr<WebSocket> CreateWebSocket(int connect_id) override;
 
 protected:
-    void HandleUrc(const std::string& command, const std::vector<AtArgumentValue>& arguments) override;
+    void HandleUrc(std::string_view command, const AtArguments& arguments) override;
     void ResetConnections();
 };
 
@@ -9,17 +9,21 @@ static const char *TAG = "Ml307Http";
 Ml307Http::Ml307Http(std::shared_ptr<AtUart> at_uart) : at_uart_(at_uart) {
     event_group_handle_ = xEventGroupCreate();
 
-    urc_callback_it_ = at_uart_->RegisterUrcCallback([this](const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+    // http_id_ 要等 MHTTPCREATE 返回后才知道，这里只按命令名订阅
+    urc_registrations_ = at_uart_->RegisterUrcHandlers({{"MHTTPURC"}, {"MHTTPCREATE"}, {"FIFO_OVERFLOW"}}, AT_URC_ANY_LINK,
+        [this](std::string_view command, const AtArguments& arguments) {
         if (command == "MHTTPURC") {
-            if (arguments[1].int_value == http_id_) {
+            if (arguments[1].int_value() == http_id_) {
                 auto& type = arguments[0].string_value;
                 if (type == "header") {
                     eof_ = false;
                     body_offset_ = 0;
                     body_.clear();
-                    status_code_ = arguments[2].int_value;
+                    status_code_ = arguments[2].int_value();
                     if (arguments.size() >= 5) {
-                        ParseResponseHeaders(at_uart_->DecodeHex(arguments[4].string_value));
+                        rx_buffer_.clear();
+                        at_uart_->DecodeHexAppend(rx_buffer_, arguments[4].string_value.data(), arguments[4].string_value.size());
+                        ParseResponseHeaders(rx_buffer_);
                     } else {
                         // FIXME: <header> 被分包发送
                         ESP_LOGE(TAG, "Missing header");
@@ -27,49 +31,56 @@ Ml307Http::Ml307Http(std::shared_ptr<AtUart> at_uart) : at_uart_(at_uart) {
                     xEventGroupSetBits(event_group_handle_, ML307_HTTP_EVENT_HEADERS_RECEIVED);
                 } else if (type == "content") {
                     // +MHTTPURC: "content",<httpid>,<content_len>,<sum_len>,<cur_len>,<data>
-                    std::string decoded_data;
+                    std::lock_guard<std::mutex> lock(mutex_);
                     if (arguments.size() >= 6) {
-                        at_uart_->DecodeHexAppend(decoded_data, arguments[5].string_value.c_str(), arguments[5].string_value.length());
+                        // 直接解码追加到 body_，不经过临时字符串
+                        at_uart_->DecodeHexAppend(body_, arguments[5].string_value.data(), arguments[5].string_value.size());
                     } else {
                         // FIXME: <data> 被分包发送
                         ESP_LOGE(TAG, "Missing content");
                     }
 
-                    std::lock_guard<std::mutex> lock(mutex_);
-                    body_.append(decoded_data);
-
                     // chunked传输时，EOF由cur_len == 0判断，非 chunked传输时，EOF由content_len判断
                     if (!eof_) {
                         if (response_chunked_) {
-                            eof_ = arguments[4].int_value == 0;
+                            eof_ = arguments[4].int_value() == 0;
                         } else {
-                            eof_ = arguments[3].int_value >= arguments[2].int_value;
+                            eof_ = arguments[3].int_value() >= arguments[2].int_value();
                         }
                     }
                     
-                    body_offset_ += arguments[4].int_value;
-                    if (arguments[3].int_value > body_offset_) {
-                        ESP_LOGE(TAG, "body_offset_: %u, arguments[3].int_value: %d", body_offset_, arguments[3].int_value);
+                    body_offset_ += arguments[4].int_value();
+                    if (arguments[3].int_value() > body_offset_) {
+                        ESP_LOGE(TAG, "body_offset_: %u, arguments[3].int_value(): %d", body_offset_, arguments[3].int_value());
                         Close();
                         return;
                     }
                     cv_.notify_one();  // 使用条件变量通知
                 } else if (type == "err") {
-                    error_code_ = arguments[2].int_value;
+                    error_code_ = arguments[2].int_value();
                     xEventGroupSetBits(event_group_handle_, ML307_HTTP_EVENT_ERROR);
                 } else if (type == "ind") {
                     xEventGroupSetBits(event_group_handle_, ML307_HTTP_EVENT_IND);
                 } else {
-                    ESP_LOGE(TAG, "Unknown HTTP event: %s", type.c_str());
+                    ESP_LOGE(TAG, "Unknown HTTP event: %.*s", (int)type.size(), type.data());
                 }
             }
         } else if (command == "MHTTPCREATE") {
-            http_id_ = arguments[0].int_value;
+            http_id_ = arguments[0].int_value();
             instance_active_ = true;
             xEventGroupSetBits(event_group_handle_, ML307_HTTP_EVENT_INITIALIZED);
         } else if (command == "FIFO_OVERFLOW") {
-            xEventGroupSetBits(event_group_handle_, ML307_HTTP_EVENT_ERROR);
-            Close();
+            // 响应以文本 URC 到达，丢失的字节里可能有本会话的头或正文: 当前响应作废，
+            // Read() 返回错误而不是把缺了一段的正文当作完整的交给调用者
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (instance_active_ && !eof_) {
+                ESP_LOGE(TAG, "HTTP %d response lost data on UART FIFO overflow", http_id_);
+                corrupted_ = true;
+                eof_ = true;
+                body_.clear();
+                xEventGroupSetBits(event_group_handle_, ML307_HTTP_EVENT_ERROR);
+                cv_.notify_all();
+            }
         }
     });
 }
@@ -77,6 +88,9 @@ Ml307Http::Ml307Http(std::shared_ptr<AtUart> at_uart) : at_uart_(at_uart) {
 int Ml307Http::Read(char* buffer, size_t buffer_size) {
     std::unique_lock<std::mutex> lock(mutex_);
     
+    if (corrupted_) {
+        return -1;
+    }
     if (eof_ && body_.empty()) {
         return 0;
     }
@@ -91,7 +105,7 @@ int Ml307Http::Read(char* buffer, size_t buffer_size) {
         ESP_LOGE(TAG, "Timeout waiting for HTTP content to be received");
         return -1;
     }
-    if (!instance_active_) {
+    if (!instance_active_ || corrupted_) {
         return -1;
     }
     
@@ -128,7 +142,7 @@ Ml307Http::~Ml307Http() {
         Close();
     }
 
-    at_uart_->UnregisterUrcCallback(urc_callback_it_);
+    at_uart_->UnregisterUrcHandlers(urc_registrations_);
     vEventGroupDelete(event_group_handle_);
 }
 
@@ -172,6 +186,7 @@ void Ml307Http::ParseResponseHeaders(const std::string& headers) {
 bool Ml307Http::Open(const std::string& method, const std::string& url) {
     method_ = method;
     url_ = url;
+    corrupted_ = false;
     
     // 判断是否为需要发送内容的HTTP方法
     bool method_supports_content = (method_ == "POST" || method_ == "PUT");
@@ -324,6 +339,10 @@ std::string Ml307Http::ReadAll() {
         ESP_LOGE(TAG, "Timeout waiting for HTTP content to be received");
         return body_;
     }
+    if (corrupted_) {
+        ESP_LOGE(TAG, "HTTP response incomplete, discarded");
+        return {};
+    }
 
     return body_;
 }
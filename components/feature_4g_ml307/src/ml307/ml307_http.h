@@ -46,8 +46,8 @@ private:
     int status_code_ = -1;
     int error_code_ = -1;
     int timeout_ms_ = 30000;
-    std::string rx_buffer_;
-    std::list<UrcCallback>::iterator urc_callback_it_;
+    std::string rx_buffer_;    // 解码后的响应头，跨 URC 复用
+    std::vector<UrcRegistration> urc_registrations_;
     std::map<std::string, std::string> headers_;
     std::string url_;
     std::string method_;
@@ -60,6 +60,7 @@ private:
     size_t body_offset_ = 0;
     size_t content_length_ = 0;
     bool eof_ = false;
+    bool corrupted_ = false;   // 接收期间 UART FIFO 溢出，响应不完整
     bool instance_active_ = false;
     bool request_chunked_ = false;
     bool response_chunked_ = false;
@@ -6,12 +6,13 @@ static const char *TAG = "Ml307Mqtt";
 Ml307Mqtt::Ml307Mqtt(std::shared_ptr<AtUart> at_uart, int mqtt_id) : at_uart_(at_uart), mqtt_id_(mqtt_id) {
     event_group_handle_ = xEventGroupCreate();
 
-    urc_callback_it_ = at_uart_->RegisterUrcCallback([this](const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+    urc_registrations_ = at_uart_->RegisterUrcHandlers({{"MQTTURC", 1}, {"MQTTSTATE"}}, mqtt_id_,
+        [this](std::string_view command, const AtArguments& arguments) {
         if (command == "MQTTURC" && arguments.size() >= 2) {
-            if (arguments[1].int_value == mqtt_id_) {
+            if (arguments[1].int_value() == mqtt_id_) {
                 auto type = arguments[0].string_value;
                 if (type == "conn") {
-                    int error_code = arguments[2].int_value;
+                    int error_code = arguments[2].int_value();
                     if (error_code == 0) {
                         if (!connected_) {
                             connected_ = true;
@@ -38,31 +39,33 @@ Ml307Mqtt::Ml307Mqtt(std::shared_ptr<AtUart> at_uart, int mqtt_id) : at_uart_(at
                     }
                 } else if (type == "suback") {
                 } else if (type == "publish" && arguments.size() >= 7) {
-                    auto topic = arguments[3].string_value;
-                    if (arguments[4].int_value == arguments[5].int_value) {
+                    message_topic_ = arguments[3].string_value;
+                    auto& data = arguments[6].string_value;
+                    // <total_len> == <cur_len> 表示单包消息，否则分包累积到 message_payload_
+                    bool single = arguments[4].int_value() == arguments[5].int_value();
+                    if (single) {
+                        message_payload_.clear();
+                    }
+                    at_uart_->DecodeHexAppend(message_payload_, data.data(), data.size());
+                    if (single || message_payload_.size() >= arguments[4].int_value()) {
                         if (on_message_callback_) {
-                            on_message_callback_(topic, at_uart_->DecodeHex(arguments[6].string_value));
-                        }
-                    } else {
-                        message_payload_.append(at_uart_->DecodeHex(arguments[6].string_value));
-                        if (message_payload_.size() >= arguments[4].int_value && on_message_callback_) {
-                            on_message_callback_(topic, message_payload_);
-                            message_payload_.clear();
+                            on_message_callback_(message_topic_, message_payload_);
                         }
+                        message_payload_.clear();
                     }
                 } else {
-                    ESP_LOGI(TAG, "unhandled MQTT event: %s", type.c_str());
+                    ESP_LOGI(TAG, "unhandled MQTT event: %.*s", (int)type.size(), type.data());
                 }
             }
         } else if (command == "MQTTSTATE" && arguments.size() == 1) {
-            connected_ = arguments[0].int_value != 3;
+            connected_ = arguments[0].int_value() != 3;
             xEventGroupSetBits(event_group_handle_, MQTT_INITIALIZED_EVENT);
         }
     });
 }
 
 Ml307Mqtt::~Ml307Mqtt() {
-    at_uart_->UnregisterUrcCallback(urc_callback_it_);
+    at_uart_->UnregisterUrcHandlers(urc_registrations_);
     vEventGroupDelete(event_group_handle_);
 }
 
@@ -78,32 +81,22 @@ bool Ml307Mqtt::Connect(const std::string broker_address, int broker_port, const
         }
     }
 
+    // 配置一次批量下发，重连时已生效的项直接跳过
+    std::string id = std::to_string(mqtt_id_);
+    std::string prefix = "mqtt" + id + "/";
+    std::vector<AtConfigItem> config;
     if (broker_port == 8883) {
-        if (!at_uart_->SendCommand(std::string("AT+MQTTCFG=\"ssl\",") + std::to_string(mqtt_id_) + ",1")) {
-            ESP_LOGE(TAG, "Failed to set MQTT to use SSL");
-            return false;
-        }
+        config.push_back({prefix + "ssl", "AT+MQTTCFG=\"ssl\"," + id + ",1"});
     }
-
     // Set clean session
-    if (!at_uart_->SendCommand(std::string("AT+MQTTCFG=\"clean\",") + std::to_string(mqtt_id_) + ",1")) {
-        ESP_LOGE(TAG, "Failed to set MQTT clean session");
-        return false;
-    }
-
+    config.push_back({prefix + "clean", "AT+MQTTCFG=\"clean\"," + id + ",1"});
     // Set keep alive and ping interval both to the same value
-    if (!at_uart_->SendCommand(std::string("AT+MQTTCFG=\"keepalive\",") + std::to_string(mqtt_id_) + "," + std::to_string(keep_alive_seconds_))) {
-        ESP_LOGE(TAG, "Failed to set MQTT keepalive interval");
-        return false;
-    }
-    if (!at_uart_->SendCommand(std::string("AT+MQTTCFG=\"pingreq\",") + std::to_string(mqtt_id_) + "," + std::to_string(keep_alive_seconds_))) {
-        ESP_LOGE(TAG, "Failed to set MQTT ping interval");
-        return false;
-    }
-
+    config.push_back({prefix + "keepalive", "AT+MQTTCFG=\"keepalive\"," + id + "," + std::to_string(keep_alive_seconds_)});
+    config.push_back({prefix + "pingreq", "AT+MQTTCFG=\"pingreq\"," + id + "," + std::to_string(keep_alive_seconds_)});
     // Set HEX encoding (ASCII for sending, HEX for receiving)
-    if (!at_uart_->SendCommand("AT+MQTTCFG=\"encoding\"," + std::to_string(mqtt_id_) + ",0,1")) {
-        ESP_LOGE(TAG, "Failed to set MQTT to use HEX encoding");
+    config.push_back({prefix + "encoding", "AT+MQTTCFG=\"encoding\"," + id + ",0,1"});
+    if (!at_uart_->ApplyConfig(config)) {
+        ESP_LOGE(TAG, "Failed to configure MQTT, error=%d", at_uart_->GetCmeErrorCode());
         return false;
     }
 
@@ -112,6 +105,7 @@ bool Ml307Mqtt::Connect(const std::string broker_address, int broker_port, const
     std::string command = "AT+MQTTCONN=" + std::to_string(mqtt_id_) + ",\"" + broker_address + "\"," + std::to_string(broker_port) + ",\"" + client_id + "\",\"" + username + "\",\"" + password + "\"";
     if (!at_uart_->SendCommand(command)) {
         ESP_LOGE(TAG, "Failed to create MQTT connection");
+        at_uart_->InvalidateConfig(prefix);
         return false;
     }
 
@@ -119,6 +113,7 @@ bool Ml307Mqtt::Connect(const std::string broker_address, int broker_port, const
     bits = xEventGroupWaitBits(event_group_handle_, MQTT_CONNECTED_EVENT | MQTT_DISCONNECTED_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(MQTT_CONNECT_TIMEOUT_MS));
     if (!(bits & MQTT_CONNECTED_EVENT)) {
         ESP_LOGE(TAG, "Failed to connect to MQTT broker");
+        at_uart_->InvalidateConfig(prefix);
         return false;
     }
     return true;
@@ -1,25 +1,12 @@
 #include "ml307_ssl.h"
-#include <esp_log.h>
-
-static const char *TAG = "Ml307Ssl";
 
 Ml307Ssl::Ml307Ssl(std::shared_ptr<AtUart> at_uart, int tcp_id) : Ml307Tcp(at_uart, tcp_id) {
 }
 
-bool Ml307Ssl::ConfigureSsl(int port) {
-    // 设置 SSL 配置
-    std::string command = "AT+MSSLCFG=\"auth\",0,0";
-    if (!at_uart_->SendCommand(command)) {
-        ESP_LOGE(TAG, "Failed to set SSL configuration");
-        return false;
-    }
-
+void Ml307Ssl::AppendSslConfig(int port, std::vector<AtConfigItem>& config) {
+    // SSL 上下文 0 为所有连接共用
+    config.push_back({"ssl0/auth", "AT+MSSLCFG=\"auth\",0,0"});
     // 强制启用 SSL
-    command = "AT+MIPCFG=\"ssl\"," + std::to_string(tcp_id_) + ",1,0";
-    if (!at_uart_->SendCommand(command)) {
-        ESP_LOGE(TAG, "Failed to set SSL configuration");
-        return false;
-    }
-
-    return true;
+    std::string prefix = "mip" + std::to_string(tcp_id_) + "/";
+    config.push_back({prefix + "ssl", "AT+MIPCFG=\"ssl\"," + std::to_string(tcp_id_) + ",1,0"});
 } 
\ No newline at end of file
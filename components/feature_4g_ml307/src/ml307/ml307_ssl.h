@@ -10,7 +10,7 @@ public:
 
 protected:
     // 重写SSL配置方法
-    bool ConfigureSsl(int port) override;
+    void AppendSslConfig(int port, std::vector<AtConfigItem>& config) override;
 };
 
 #endif // ML307_SSL_H 
\ No newline at end of file
@@ -7,10 +7,11 @@
 Ml307Tcp::Ml307Tcp(std::shared_ptr<AtUart> at_uart, int tcp_id) : at_uart_(at_uart), tcp_id_(tcp_id) {
     event_group_handle_ = xEventGroupCreate();
 
-    urc_callback_it_ = at_uart_->RegisterUrcCallback([this](const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+    urc_registrations_ = at_uart_->RegisterUrcHandlers({{"MIPOPEN", 0}, {"MIPCLOSE", 0}, {"MIPSEND", 0}, {"MIPURC", 1}, {"MIPSTATE", 0}, {"FIFO_OVERFLOW"}}, tcp_id_,
+        [this](std::string_view command, const AtArguments& arguments) {
         if (command == "MIPOPEN" && arguments.size() == 2) {
-            if (arguments[0].int_value == tcp_id_) {
-                connected_ = arguments[1].int_value == 0;
+            if (arguments[0].int_value() == tcp_id_) {
+                connected_ = arguments[1].int_value() == 0;
                 if (connected_) {
                     instance_active_ = true;
                     xEventGroupClearBits(event_group_handle_, ML307_TCP_DISCONNECTED | ML307_TCP_ERROR);
@@ -20,19 +21,20 @@ Ml307Tcp::Ml307Tcp(std::shared_ptr<AtUart> at_uart, int tcp_id) : at_uart_(at_ua
                 }
             }
         } else if (command == "MIPCLOSE" && arguments.size() == 1) {
-            if (arguments[0].int_value == tcp_id_) {
+            if (arguments[0].int_value() == tcp_id_) {
                 instance_active_ = false;
                 xEventGroupSetBits(event_group_handle_, ML307_TCP_DISCONNECTED);
             }
         } else if (command == "MIPSEND" && arguments.size() == 2) {
-            if (arguments[0].int_value == tcp_id_) {
+            if (arguments[0].int_value() == tcp_id_) {
                 xEventGroupSetBits(event_group_handle_, ML307_TCP_SEND_COMPLETE);
             }
         } else if (command == "MIPURC" && arguments.size() >= 3) {
-            if (arguments[1].int_value == tcp_id_) {
+            if (arguments[1].int_value() == tcp_id_) {
                 if (arguments[0].string_value == "rtcp") {
                     if (connected_ && stream_callback_) {
-                        stream_callback_(at_uart_->DecodeHex(arguments[3].string_value));
+                        rx_payload_.assign(arguments[3].string_value);
+                        stream_callback_(rx_payload_);
                     }
                 } else if (arguments[0].string_value == "disconn") {
                     if (connected_) {
@@ -44,25 +46,34 @@ Ml307Tcp::Ml307Tcp(std::shared_ptr<AtUart> at_uart, int tcp_id) : at_uart_(at_ua
                     instance_active_ = false;
                     xEventGroupSetBits(event_group_handle_, ML307_TCP_DISCONNECTED);
                 } else {
-                    ESP_LOGE(TAG, "Unknown MIPURC command: %s", arguments[0].string_value.c_str());
+                    ESP_LOGE(TAG, "Unknown MIPURC command: %.*s", (int)arguments[0].string_value.size(), arguments[0].string_value.data());
                 }
             }
         } else if (command == "MIPSTATE" && arguments.size() >= 5) {
-            if (arguments[0].int_value == tcp_id_) {
+            if (arguments[0].int_value() == tcp_id_) {
                 connected_ = arguments[4].string_value == "CONNECTED";
                 instance_active_ = arguments[4].string_value != "INITIAL";
                 xEventGroupSetBits(event_group_handle_, ML307_TCP_INITIALIZED);
             }
         } else if (command == "FIFO_OVERFLOW") {
-            xEventGroupSetBits(event_group_handle_, ML307_TCP_ERROR);
-            Disconnect();
+            // 丢失的字节里可能有本连接的数据，字节流已不完整，按断开处理。
+            // 接收任务中不能发同步命令，instance_active_ 保持 true，由之后的 Disconnect() 关闭模组上的连接
+            if (connected_) {
+                ESP_LOGE(TAG, "Connection %d lost data on UART FIFO overflow", tcp_id_);
+                connected_ = false;
+                xEventGroupSetBits(event_group_handle_, ML307_TCP_ERROR);
+                if (disconnect_callback_) {
+                    disconnect_callback_();
+                }
+            }
         }
     });
 }
 
 Ml307Tcp::~Ml307Tcp() {
     Disconnect();
-    at_uart_->UnregisterUrcCallback(urc_callback_it_);
+    at_uart_->SetBinaryUrc("MIPURC", 1, 2, tcp_id_, false);
+    at_uart_->UnregisterUrcHandlers(urc_registrations_);
     if (event_group_handle_) {
         vEventGroupDelete(event_group_handle_);
     }
@@ -90,23 +101,24 @@ bool Ml307Tcp::Connect(const std::string& host, int port) {
         }
     }
 
-    // 配置SSL（子类可以重写）
-    if (!ConfigureSsl(port)) {
-        ESP_LOGE(TAG, "Failed to configure SSL");
-        return false;
-    }
-
-    // 使用 HEX 编码
-    command = "AT+MIPCFG=\"encoding\"," + std::to_string(tcp_id_) + ",1,1";
-    if (!at_uart_->SendCommand(command)) {
-        ESP_LOGE(TAG, "Failed to set HEX encoding");
+    // SSL（子类可以重写）和编码配置一起下发，已生效的跳过。
+    // 收发都使用原始数据: 发送走 '>' 提示符后按长度写入，接收按 URC 中的长度切帧
+    std::string prefix = "mip" + std::to_string(tcp_id_) + "/";
+    std::vector<AtConfigItem> config;
+    AppendSslConfig(port, config);
+    config.push_back({prefix + "encoding", "AT+MIPCFG=\"encoding\"," + std::to_string(tcp_id_) + ",0,0"});
+    if (!at_uart_->ApplyConfig(config)) {
+        ESP_LOGE(TAG, "Failed to configure connection, error=%d", at_uart_->GetCmeErrorCode());
         return false;
     }
+    at_uart_->SetBinaryUrc("MIPURC", 1, 2, tcp_id_, true);
 
     // 打开 TCP 连接
     command = "AT+MIPOPEN=" + std::to_string(tcp_id_) + ",\"TCP\",\"" + host + "\"," + std::to_string(port) + ",,0";
     if (!at_uart_->SendCommand(command)) {
         ESP_LOGE(TAG, "Failed to open TCP connection, error=%d", at_uart_->GetCmeErrorCode());
+        // 模组可能已重启而丢失配置，下次重新下发
+        at_uart_->InvalidateConfig(prefix);
         return false;
     }
 
@@ -114,6 +126,7 @@ bool Ml307Tcp::Connect(const std::string& host, int port) {
     bits = xEventGroupWaitBits(event_group_handle_, ML307_TCP_CONNECTED | ML307_TCP_ERROR, pdTRUE, pdFALSE, TCP_CONNECT_TIMEOUT_MS / portTICK_PERIOD_MS);
     if (bits & ML307_TCP_ERROR) {
         ESP_LOGE(TAG, "Failed to connect to %s:%d", host.c_str(), port);
+        at_uart_->InvalidateConfig(prefix);
         return false;
     }
     return true;
@@ -137,17 +150,12 @@ void Ml307Tcp::Disconnect() {
     }
 }
 
-bool Ml307Tcp::ConfigureSsl(int port) {
-    std::string command = "AT+MIPCFG=\"ssl\"," + std::to_string(tcp_id_) + ",0,0";
-    if (!at_uart_->SendCommand(command)) {
-        ESP_LOGE(TAG, "Failed to set SSL configuration");
-        return false;
-    }
-    return true;
+void Ml307Tcp::AppendSslConfig(int port, std::vector<AtConfigItem>& config) {
+    config.push_back({"mip" + std::to_string(tcp_id_) + "/ssl", "AT+MIPCFG=\"ssl\"," + std::to_string(tcp_id_) + ",0,0"});
 }
 
 int Ml307Tcp::Send(const std::string& data) {
-    const size_t MAX_PACKET_SIZE = 1460 / 2;
+    const size_t MAX_PACKET_SIZE = 1460;
     size_t total_sent = 0;
 
     if (!connected_) {
@@ -155,34 +163,28 @@ int Ml307Tcp::Send(const std::string& data) {
         return -1;
     }
 
-    // 在循环外预先分配command
     std::string command;
-    command.reserve(32 + MAX_PACKET_SIZE * 2);  // 预分配最大可能需要的空间
+    command.reserve(32);
 
     while (total_sent < data.size()) {
         size_t chunk_size = std::min(data.size() - total_sent, MAX_PACKET_SIZE);
         
-        // 重置command并构建新的命令，利用预分配的容量
+        // 只发命令头，模组回 '>' 后再写入 chunk_size 字节原始数据
         command.clear();
         command += "AT+MIPSEND=";
         command += std::to_string(tcp_id_);
         command += ",";
         command += std::to_string(chunk_size);
-        command += ",";
-        
-        // 直接在command字符串上进行十六进制编码
-        at_uart_->EncodeHexAppend(command, data.data() + total_sent, chunk_size);
-        command += "\r\n";
         
         // 根据波特率和命令长度动态计算超时：传输时间(10位/字节) + 处理余量
         int baud = at_uart_->GetBaudRate();
         if (baud <= 0) baud = 115200;
-        size_t bytes_to_tx = command.size();
+        size_t bytes_to_tx = command.size() + 2 + chunk_size;
         // 发送位数≈字节*10（1起始+8数据+1停止），转毫秒
         uint32_t tx_time_ms = static_cast<uint32_t>((bytes_to_tx * 10ULL * 1000ULL) / static_cast<uint32_t>(baud));
         uint32_t timeout_ms = tx_time_ms + 100; // 余量
 
-        if (!at_uart_->SendCommand(command, timeout_ms, false)) {
+        if (!at_uart_->SendCommandWithData(command, timeout_ms, true, data.data() + total_sent, chunk_size)) {
             ESP_LOGE(TAG, "Failed to send data chunk");
             Disconnect();
             return -1;
@@ -30,10 +30,11 @@ protected:
     int tcp_id_;
     bool instance_active_ = false;
     EventGroupHandle_t event_group_handle_;
-    std::list<UrcCallback>::iterator urc_callback_it_;
+    std::vector<UrcRegistration> urc_registrations_;
+    std::string rx_payload_;    // 接收数据，跨 URC 复用以免每包分配
     
-    // 虚函数允许子类自定义SSL配置
-    virtual bool ConfigureSsl(int port);
+    // 虚函数允许子类自定义SSL配置，配置项与其他连接配置一起批量下发
+    virtual void AppendSslConfig(int port, std::vector<AtConfigItem>& config);
 };
 
 #endif // ML307_TCP_H 
\ No newline at end of file
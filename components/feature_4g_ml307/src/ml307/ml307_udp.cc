@@ -8,10 +8,11 @@
 Ml307Udp::Ml307Udp(std::shared_ptr<AtUart> at_uart, int udp_id) : at_uart_(at_uart), udp_id_(udp_id) {
     event_group_handle_ = xEventGroupCreate();
 
-    urc_callback_it_ = at_uart_->RegisterUrcCallback([this](const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+    urc_registrations_ = at_uart_->RegisterUrcHandlers({{"MIPOPEN", 0}, {"MIPCLOSE", 0}, {"MIPSEND", 0}, {"MIPURC", 1}, {"MIPSTATE", 0}, {"FIFO_OVERFLOW"}}, udp_id_,
+        [this](std::string_view command, const AtArguments& arguments) {
         if (command == "MIPOPEN" && arguments.size() == 2) {
-            if (arguments[0].int_value == udp_id_) {
-                connected_ = arguments[1].int_value == 0;
+            if (arguments[0].int_value() == udp_id_) {
+                connected_ = arguments[1].int_value() == 0;
                 if (connected_) {
                     instance_active_ = true;
                     xEventGroupClearBits(event_group_handle_, ML307_UDP_DISCONNECTED | ML307_UDP_ERROR);
@@ -21,44 +22,48 @@ Ml307Udp::Ml307Udp(std::shared_ptr<AtUart> at_uart, int udp_id) : at_uart_(at_ua
                 }
             }
         } else if (command == "MIPCLOSE" && arguments.size() == 1) {
-            if (arguments[0].int_value == udp_id_) {
+            if (arguments[0].int_value() == udp_id_) {
                 instance_active_ = false;
                 xEventGroupSetBits(event_group_handle_, ML307_UDP_DISCONNECTED);
             }
         } else if (command == "MIPSEND" && arguments.size() == 2) {
-            if (arguments[0].int_value == udp_id_) {
+            if (arguments[0].int_value() == udp_id_) {
                 xEventGroupSetBits(event_group_handle_, ML307_UDP_SEND_COMPLETE);
             }
         } else if (command == "MIPURC" && arguments.size() == 4) {
-            if (arguments[1].int_value == udp_id_) {
+            if (arguments[1].int_value() == udp_id_) {
                 if (arguments[0].string_value == "rudp") {
                     if (connected_ && message_callback_) {
-                        message_callback_(at_uart_->DecodeHex(arguments[3].string_value));
+                        rx_payload_.assign(arguments[3].string_value);
+                        message_callback_(rx_payload_);
                     }
                 } else if (arguments[0].string_value == "disconn") {
                     connected_ = false;
                     instance_active_ = false;
                     xEventGroupSetBits(event_group_handle_, ML307_UDP_DISCONNECTED);
                 } else {
-                    ESP_LOGE(TAG, "Unknown MIPURC command: %s", arguments[0].string_value.c_str());
+                    ESP_LOGE(TAG, "Unknown MIPURC command: %.*s", (int)arguments[0].string_value.size(), arguments[0].string_value.data());
                 }
             }
         } else if (command == "MIPSTATE" && arguments.size() == 5) {
-            if (arguments[0].int_value == udp_id_) {
+            if (arguments[0].int_value() == udp_id_) {
                 connected_ = arguments[4].string_value == "CONNECTED";
                 instance_active_ = arguments[4].string_value != "INITIAL";
                 xEventGroupSetBits(event_group_handle_, ML307_UDP_INITIALIZED);
             }
         } else if (command == "FIFO_OVERFLOW") {
-            xEventGroupSetBits(event_group_handle_, ML307_UDP_ERROR);
-            Disconnect();
+            // 被截断的数据报已由解析器丢弃，数据报之间互不依赖，丢包对 UDP 是正常情况，只记录
+            if (connected_) {
+                ESP_LOGW(TAG, "Connection %d may have lost datagrams on UART FIFO overflow", udp_id_);
+            }
         }
     });
 }
 
 Ml307Udp::~Ml307Udp() {
     Disconnect();
-    at_uart_->UnregisterUrcCallback(urc_callback_it_);
+    at_uart_->SetBinaryUrc("MIPURC", 1, 2, udp_id_, false);
+    at_uart_->UnregisterUrcHandlers(urc_registrations_);
     if (event_group_handle_) {
         vEventGroupDelete(event_group_handle_);
     }
@@ -86,22 +91,23 @@ bool Ml307Udp::Connect(const std::string& host, int port) {
         }
     }
 
-    // 使用 HEX 编码
-    command = "AT+MIPCFG=\"encoding\"," + std::to_string(udp_id_) + ",1,1";
-    if (!at_uart_->SendCommand(command)) {
-        ESP_LOGE(TAG, "Failed to set HEX encoding");
-        return false;
-    }
-    command = "AT+MIPCFG=\"ssl\"," + std::to_string(udp_id_) + ",0,0";
-    if (!at_uart_->SendCommand(command)) {
-        ESP_LOGE(TAG, "Failed to set SSL configuration");
+    // 收发都使用原始数据: 发送走 '>' 提示符后按长度写入，接收按 URC 中的长度切帧。
+    // 与 TCP 共用连接号，配置缓存的 key 也相同
+    std::string prefix = "mip" + std::to_string(udp_id_) + "/";
+    if (!at_uart_->ApplyConfig({
+        {prefix + "encoding", "AT+MIPCFG=\"encoding\"," + std::to_string(udp_id_) + ",0,0"},
+        {prefix + "ssl", "AT+MIPCFG=\"ssl\"," + std::to_string(udp_id_) + ",0,0"},
+    })) {
+        ESP_LOGE(TAG, "Failed to configure connection");
         return false;
     }
+    at_uart_->SetBinaryUrc("MIPURC", 1, 2, udp_id_, true);
 
     // 打开 UDP 连接
     command = "AT+MIPOPEN=" + std::to_string(udp_id_) + ",\"UDP\",\"" + host + "\"," + std::to_string(port) + ",,0";
     if (!at_uart_->SendCommand(command)) {
         ESP_LOGE(TAG, "Failed to open UDP connection");
+        at_uart_->InvalidateConfig(prefix);
         return false;
     }
 
@@ -109,6 +115,7 @@ bool Ml307Udp::Connect(const std::string& host, int port) {
     bits = xEventGroupWaitBits(event_group_handle_, ML307_UDP_CONNECTED | ML307_UDP_ERROR, pdTRUE, pdFALSE, UDP_CONNECT_TIMEOUT_MS / portTICK_PERIOD_MS);
     if (bits & ML307_UDP_ERROR) {
         ESP_LOGE(TAG, "Failed to connect to %s:%d", host.c_str(), port);
+        at_uart_->InvalidateConfig(prefix);
         return false;
     }
     return true;
@@ -125,7 +132,7 @@ void Ml307Udp::Disconnect() {
 }
 
 int Ml307Udp::Send(const std::string& data) {
-    const size_t MAX_PACKET_SIZE = 1460 / 2;
+    const size_t MAX_PACKET_SIZE = 1460;
 
     if (!connected_) {
         ESP_LOGE(TAG, "Not connected");
@@ -137,14 +144,9 @@ int Ml307Udp::Send(const std::string& data) {
         return -1;
     }
 
-    // 在循环外预先分配command
-    std::string command = "AT+MIPSEND=" + std::to_string(udp_id_) + "," + std::to_string(data.size()) + ",";
-    
-    // 直接在command字符串上进行十六进制编码
-    at_uart_->EncodeHexAppend(command, data.data(), data.size());
-    command += "\r\n";
-    
-    if (!at_uart_->SendCommand(command, 1000, false)) {
+    // 只发命令头，模组回 '>' 后再写入原始数据
+    std::string command = "AT+MIPSEND=" + std::to_string(udp_id_) + "," + std::to_string(data.size());
+    if (!at_uart_->SendCommandWithData(command, 1000, true, data.data(), data.size())) {
         ESP_LOGE(TAG, "Failed to send data chunk");
         return -1;
     }
@@ -30,7 +30,8 @@ private:
     int udp_id_;
     bool instance_active_ = false;
     EventGroupHandle_t event_group_handle_;
-    std::list<UrcCallback>::iterator urc_callback_it_;
+    std::vector<UrcRegistration> urc_registrations_;
+    std::string rx_payload_;    // 接收数据，跨 URC 复用以免每包分配
 };
 
 #endif // ML307_UDP_H
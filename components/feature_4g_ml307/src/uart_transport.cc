@@ -0,0 +1,106 @@
+#include "uart_transport.h"
+#include <esp_log.h>
+#include <esp_err.h>
+
+#define TAG "UartTransport"
+
+
+UartTransport::UartTransport(gpio_num_t tx_pin, gpio_num_t rx_pin, gpio_num_t rts_pin, gpio_num_t cts_pin, uart_port_t uart_num)
+    : tx_pin_(tx_pin), rx_pin_(rx_pin), rts_pin_(rts_pin), cts_pin_(cts_pin), uart_num_(uart_num) {
+}
+
+UartTransport::~UartTransport() {
+    if (event_task_handle_) {
+        vTaskDelete(event_task_handle_);
+    }
+    if (opened_) {
+        uart_driver_delete(uart_num_);
+    }
+}
+
+bool UartTransport::Open(int baud_rate, size_t rx_buffer_size, size_t tx_buffer_size, AtTransportEventCallback callback) {
+    if (opened_) {
+        return true;
+    }
+    callback_ = std::move(callback);
+
+    uart_config_t uart_config = {};
+    uart_config.baud_rate = baud_rate;
+    uart_config.data_bits = UART_DATA_8_BITS;
+    uart_config.parity = UART_PARITY_DISABLE;
+    uart_config.stop_bits = UART_STOP_BITS_1;
+    uart_config.source_clk = UART_SCLK_DEFAULT;
+
+    ESP_ERROR_CHECK(uart_driver_install(uart_num_, rx_buffer_size, tx_buffer_size, 100, &event_queue_handle_, ESP_INTR_FLAG_IRAM));
+    ESP_ERROR_CHECK(uart_param_config(uart_num_, &uart_config));
+    bool has_flow_pins = HasFlowControl();
+    ESP_ERROR_CHECK(uart_set_pin(uart_num_, tx_pin_, rx_pin_,
+        has_flow_pins ? rts_pin_ : UART_PIN_NO_CHANGE, has_flow_pins ? cts_pin_ : UART_PIN_NO_CHANGE));
+    // 降低 FIFO 满阈值、缩短超时，高波特率下中断延迟有更多余量
+    uart_set_rx_full_threshold(uart_num_, AT_UART_RX_FULL_THRESHOLD);
+    uart_set_rx_timeout(uart_num_, AT_UART_RX_TIMEOUT_SYMBOLS);
+    if (has_flow_pins) {
+        // RTS 先由本地驱动，模组在 AT+IFC 之前会忽略它；CTS 要等模组确认后再启用，否则可能永远发不出数据
+        uart_set_hw_flow_ctrl(uart_num_, UART_HW_FLOWCTRL_RTS, AT_UART_RTS_THRESHOLD);
+    }
+    opened_ = true;
+
+    xTaskCreatePinnedToCore([](void* arg) {
+        auto transport = (UartTransport*)arg;
+        transport->EventTask();
+        vTaskDelete(NULL);
+    }, "modem_event", 2048, this, configMAX_PRIORITIES - 1, &event_task_handle_, 0);
+    return true;
+}
+
+void UartTransport::EventTask() {
+    uart_event_t event;
+    while (true) {
+        if (xQueueReceive(event_queue_handle_, &event, portMAX_DELAY) == pdTRUE) {
+            switch (event.type)
+            {
+            case UART_DATA:
+                callback_(AtTransportEvent::DataAvailable);
+                break;
+            case UART_BREAK:
+                callback_(AtTransportEvent::Break);
+                break;
+            case UART_BUFFER_FULL:
+                callback_(AtTransportEvent::BufferFull);
+                break;
+            case UART_FIFO_OVF:
+                callback_(AtTransportEvent::FifoOverflow);
+                break;
+            default:
+                ESP_LOGE(TAG, "unknown event type: %d", event.type);
+                break;
+            }
+        }
+    }
+}
+
+size_t UartTransport::Available() {
+    size_t available = 0;
+    uart_get_buffered_data_len(uart_num_, &available);
+    return available;
+}
+
+int UartTransport::Read(char* buffer, size_t length) {
+    return uart_read_bytes(uart_num_, buffer, length, 0);
+}
+
+int UartTransport::Write(const char* data, size_t length) {
+    return uart_write_bytes(uart_num_, data, length);
+}
+
+void UartTransport::SetBaudRate(int baud_rate) {
+    uart_set_baudrate(uart_num_, baud_rate);
+}
+
+void UartTransport::WaitTxDone(uint32_t timeout_ms) {
+    uart_wait_tx_done(uart_num_, pdMS_TO_TICKS(timeout_ms));
+}
+
+void UartTransport::EnableFlowControl() {
+    uart_set_hw_flow_ctrl(uart_num_, UART_HW_FLOWCTRL_CTS_RTS, AT_UART_RTS_THRESHOLD);
+}
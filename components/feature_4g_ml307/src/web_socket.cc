@@ -323,13 +323,13 @@ void WebSocket::OnTcpData(const std::string& data) {
         size_t header_length = 2;
         if (payload_length == 126) {
             if (buffer_size - buffer_offset < 4) break; // 需要更多数据
-            payload_length = (buffer[buffer_offset + 2] << 8) | buffer[buffer_offset + 3];
+            payload_length = ((uint8_t)buffer[buffer_offset + 2] << 8) | (uint8_t)buffer[buffer_offset + 3];
             header_length += 2;
         } else if (payload_length == 127) {
             if (buffer_size - buffer_offset < 10) break; // 需要更多数据
             payload_length = 0;
             for (int i = 0; i < 8; ++i) {
-                payload_length = (payload_length << 8) | buffer[buffer_offset + 2 + i];
+                payload_length = (payload_length << 8) | (uint8_t)buffer[buffer_offset + 2 + i];
             }
             header_length += 8;
         }
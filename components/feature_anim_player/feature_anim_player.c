@@ -8,6 +8,7 @@
 #include "freertos/semphr.h"
 #include <string.h>
 #include <stdio.h>
+#include <inttypes.h>
 
 #include "esp_jpeg_common.h"
 #include "esp_jpeg_dec.h"
@@ -48,6 +49,14 @@ static const anim_info_t g_anim_database[ANIM_TYPE_MAX] = {
     [ANIM_TYPE_SHENGYIN_100] = {"shengyin_100", 1},
 };
 
+// --- 时间轴提示 (帧序号升序)，默认全部为空，由 anim_player_set_cues() 按需挂上 ---
+typedef struct {
+    const anim_cue_t* cues;
+    uint8_t count;
+} anim_cue_table_t;
+
+static anim_cue_table_t g_anim_cues[ANIM_TYPE_MAX];
+
 // --- 模块私有变量 ---
 static volatile bool g_target_on_off_state = true;
 static volatile bool g_current_on_off_state = true;
@@ -60,6 +69,12 @@ static portMUX_TYPE animation_spinlock = portMUX_INITIALIZER_UNLOCKED;
 static const anim_info_t* g_current_anim_info = NULL;
 static volatile int g_current_frame_index = 0;
 
+static anim_sync_stats_t g_sync_stats;
+static uint64_t g_sync_error_sum_us = 0;
+static int64_t g_prev_draw_done_us = 0;
+static int64_t g_cue_pending_done_us = 0;   // 已触发、等待马达开始输出的提示所在帧的上屏时刻
+static uint32_t g_late_reported = 0;
+
 static esp_err_t decode_jpeg_to_buffer(const char* jpeg_path, uint16_t* target_buffer)
 {
     FILE *f = fopen(jpeg_path, "r");
@@ -111,6 +126,61 @@ static esp_err_t decode_jpeg_to_buffer(const char* jpeg_path, uint16_t* target_b
     return ESP_OK;
 }
 
+// 触觉任务真正开始输出时回调: 误差从提示所在帧的DMA完成时刻算到这里
+static void on_haptic_output_start(int64_t start_us, void* arg)
+{
+    taskENTER_CRITICAL(&animation_spinlock);
+    if (g_cue_pending_done_us != 0) {
+        uint32_t error_us = (start_us > g_cue_pending_done_us) ? (uint32_t)(start_us - g_cue_pending_done_us) : 0;
+        g_cue_pending_done_us = 0;
+        g_sync_stats.cues_fired++;
+        g_sync_stats.last_error_us = error_us;
+        if (error_us > g_sync_stats.max_error_us) {
+            g_sync_stats.max_error_us = error_us;
+        }
+        g_sync_error_sum_us += error_us;
+        g_sync_stats.avg_error_us = (uint32_t)(g_sync_error_sum_us / g_sync_stats.cues_fired);
+        if (g_sync_stats.frame_period_us != 0 && error_us > g_sync_stats.frame_period_us) {
+            g_sync_stats.late_count++;
+        }
+    }
+    taskEXIT_CRITICAL(&animation_spinlock);
+}
+
+// 在帧上屏后立即触发该帧的提示，误差在马达实际开始输出时统计 (见 on_haptic_output_start)
+static void fire_frame_cues(anim_type_t anim_type, int frame_index)
+{
+    int64_t done_us = bsp_lcd_get_draw_done_us();
+
+    taskENTER_CRITICAL(&animation_spinlock);
+    if (g_prev_draw_done_us != 0 && done_us > g_prev_draw_done_us) {
+        g_sync_stats.frame_period_us = (uint32_t)(done_us - g_prev_draw_done_us);
+    }
+    const anim_cue_t* cues = g_anim_cues[anim_type].cues;
+    uint8_t cue_count = g_anim_cues[anim_type].count;
+    uint32_t late_count = g_sync_stats.late_count;
+    uint32_t last_error_us = g_sync_stats.last_error_us;
+    uint32_t frame_period_us = g_sync_stats.frame_period_us;
+    taskEXIT_CRITICAL(&animation_spinlock);
+    g_prev_draw_done_us = done_us;
+
+    // 回调在触觉任务中执行，不在那里打日志，由渲染任务补报
+    if (late_count != g_late_reported) {
+        g_late_reported = late_count;
+        ESP_LOGW(TAG, "提示同步误差 %" PRIu32 "us 超过帧周期 %" PRIu32 "us", last_error_us, frame_period_us);
+    }
+
+    for (uint8_t i = 0; i < cue_count && cues[i].frame <= frame_index; i++) {
+        if (cues[i].frame != frame_index) {
+            continue;
+        }
+        taskENTER_CRITICAL(&animation_spinlock);
+        g_cue_pending_done_us = done_us;
+        taskEXIT_CRITICAL(&animation_spinlock);
+        mada_play_preset(cues[i].haptic);
+    }
+}
+
 static void jpeg_animation_task(void *pvParameters)
 {
     char jpeg_path[64];
@@ -137,8 +207,9 @@ static void jpeg_animation_task(void *pvParameters)
                 // 2. 将缓冲区通过BSP接口发送到屏幕
                 bsp_lcd_draw_bitmap(0, 0, bsp_lcd_get_width(), bsp_lcd_get_height(), g_frame_buffer);
                 
-                // 3. 等待BSP通知DMA传输完成
+                // 3. 等待BSP通知DMA传输完成，然后触发挂在这一帧上的提示
                 bsp_lcd_wait_for_draw_done();
+                fire_frame_cues((anim_type_t)(active_anim - g_anim_database), frame_index);
             }
 
             // 4. 更新到下一帧
@@ -163,6 +234,7 @@ esp_err_t anim_player_init(void)
         ESP_LOGE(TAG, "创建播放器互斥锁失败!");
         return ESP_FAIL;
     }
+    mada_set_output_start_cb(on_haptic_output_start, NULL);
     // 初始化LCD硬件
     return bsp_lcd_init();
 }
@@ -210,6 +282,26 @@ void anim_player_switch_animation(anim_type_t anim_type) {
     ESP_LOGI(TAG, "切换动画到 '%s', 共 %d 帧", g_anim_database[anim_type].base_name, g_anim_database[anim_type].frame_count);
 }
 
+void anim_player_set_cues(anim_type_t anim_type, const anim_cue_t* cues, uint8_t count) {
+    if (anim_type >= ANIM_TYPE_MAX) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&animation_spinlock);
+    g_anim_cues[anim_type].cues = cues;
+    g_anim_cues[anim_type].count = (cues != NULL) ? count : 0;
+    taskEXIT_CRITICAL(&animation_spinlock);
+}
+
+void anim_player_get_sync_stats(anim_sync_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&animation_spinlock);
+    *stats = g_sync_stats;
+    taskEXIT_CRITICAL(&animation_spinlock);
+}
+
 esp_err_t anim_player_display_off(void) {
     // g_target_on_off_state = false;
     bsp_lcd_set_power(0);
@@ -3,6 +3,7 @@
 
 #include "esp_err.h"
 #include <stdint.h>
+#include "feature_motor.h"
 
 // 明确定义所有动画类型的枚举
 typedef enum {
@@ -26,6 +27,29 @@ typedef enum {
     ANIM_TYPE_MAX // 用于计算枚举成员的数量
 } anim_type_t;
 
+/**
+ * @brief 时间轴提示: 指定帧上屏 (DMA传输完成) 时触发的震动
+ */
+typedef struct {
+    uint16_t      frame;   // 帧序号 (从0开始)
+    mada_preset_t haptic;  // 要播放的内置震动波形
+} anim_cue_t;
+
+/**
+ * @brief 提示与画面的同步误差统计
+ *
+ * 误差 = 触觉任务实际开始输出波形的时刻 - 该帧DMA传输完成的时刻，目标是小于一个帧周期。
+ * 同一帧上的多个提示只统计最后一个 (后触发的波形会替换前一个)。
+ */
+typedef struct {
+    uint32_t cues_fired;
+    uint32_t late_count;        // 误差超过当时帧周期的次数
+    uint32_t last_error_us;
+    uint32_t max_error_us;
+    uint32_t avg_error_us;
+    uint32_t frame_period_us;   // 最近两帧上屏时刻之差
+} anim_sync_stats_t;
+
 // --- 公共 API ---
 
 /**
@@ -45,6 +69,19 @@ void anim_player_task_start(void);
  */
 void anim_player_switch_animation(anim_type_t anim_type);
 
+/**
+ * @brief 替换某个动画的时间轴提示表 (默认没有提示，需要震动的动画由调用方挂上)
+ *
+ * @param cues  按帧序号升序排列的提示表，需在使用期间保持有效；NULL 表示清空
+ * @param count 提示数量
+ */
+void anim_player_set_cues(anim_type_t anim_type, const anim_cue_t* cues, uint8_t count);
+
+/**
+ * @brief 获取提示同步误差统计
+ */
+void anim_player_get_sync_stats(anim_sync_stats_t* stats);
+
 /**
  * @brief 请求关闭屏幕显示
  * @return esp_err_t
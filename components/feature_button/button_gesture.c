@@ -0,0 +1,227 @@
+#include "button_gesture.h"
+#include <string.h>
+
+typedef enum {
+    GESTURE_STATE_IDLE = 0,
+    GESTURE_STATE_PRESSED,       // 按下中，等待松开或长按超时
+    GESTURE_STATE_WAIT_NEXT,     // 已松开，等待下一次连击或超时上报
+    GESTURE_STATE_HELD,          // 长按已触发，等待重复或松开
+    GESTURE_STATE_WAIT_RELEASE,  // 手势已上报 (组合键/提前上报)，等待松开
+} gesture_state_t;
+
+static inline bool prv_reached(uint32_t deadline, uint32_t now_ms)
+{
+    return (int32_t)(now_ms - deadline) >= 0;
+}
+
+static void prv_emit(button_gesture_t *engine, button_gesture_type_t type, uint8_t id, uint8_t count)
+{
+    if (engine->callback) {
+        engine->callback(type, id, count, engine->ctx);
+    }
+}
+
+// 按下时检查组合键，命中则上报并让组合中的所有按键进入等待释放
+static bool prv_check_chords(button_gesture_t *engine, uint8_t id, uint32_t now_ms)
+{
+    for (uint8_t c = 0; c < engine->chord_count; c++) {
+        const button_chord_config_t *chord = &engine->chords[c];
+        if (!(chord->buttons_mask & (1UL << id))) {
+            continue;
+        }
+
+        bool complete = true;
+        for (uint8_t i = 0; i < engine->button_count && complete; i++) {
+            if (!(chord->buttons_mask & (1UL << i))) {
+                continue;
+            }
+            const button_gesture_button_t *btn = &engine->buttons[i];
+            complete = btn->stable_pressed &&
+                       (btn->state == GESTURE_STATE_PRESSED || btn->state == GESTURE_STATE_HELD) &&
+                       (now_ms - btn->pressed_at) <= chord->window_ms;
+        }
+        if (!complete) {
+            continue;
+        }
+
+        for (uint8_t i = 0; i < engine->button_count; i++) {
+            if (chord->buttons_mask & (1UL << i)) {
+                engine->buttons[i].state = GESTURE_STATE_WAIT_RELEASE;
+                engine->buttons[i].click_count = 0;
+            }
+        }
+        prv_emit(engine, BUTTON_GESTURE_CHORD, c, 1);
+        return true;
+    }
+    return false;
+}
+
+// 消抖后的稳定电平变化
+static void prv_on_level(button_gesture_t *engine, uint8_t id, bool pressed, uint32_t now_ms)
+{
+    const button_gesture_config_t *cfg = &engine->configs[id];
+    button_gesture_button_t *btn = &engine->buttons[id];
+
+    if (pressed) {
+        btn->pressed_at = now_ms;
+        if (btn->state != GESTURE_STATE_IDLE && btn->state != GESTURE_STATE_WAIT_NEXT) {
+            return;
+        }
+        if (btn->state == GESTURE_STATE_IDLE) {
+            btn->click_count = 0;
+        }
+        btn->state = GESTURE_STATE_PRESSED;
+        btn->deadline = now_ms + cfg->hold_ms;
+
+        if (prv_check_chords(engine, id, now_ms)) {
+            return;
+        }
+        if (cfg->early_dispatch && cfg->max_clicks <= 1 && cfg->hold_ms == 0) {
+            // 不需要区分单击/连击/长按，按下即上报
+            btn->state = GESTURE_STATE_WAIT_RELEASE;
+            prv_emit(engine, BUTTON_GESTURE_CLICK, id, 1);
+        }
+        return;
+    }
+
+    switch (btn->state) {
+        case GESTURE_STATE_PRESSED:
+            btn->click_count++;
+            if (btn->click_count >= cfg->max_clicks || cfg->click_gap_ms == 0) {
+                // 已达到最大连击数，无需再等连击窗口
+                uint8_t count = btn->click_count;
+                btn->state = GESTURE_STATE_IDLE;
+                btn->click_count = 0;
+                prv_emit(engine, BUTTON_GESTURE_CLICK, id, count);
+            } else {
+                btn->state = GESTURE_STATE_WAIT_NEXT;
+                btn->deadline = now_ms + cfg->click_gap_ms;
+            }
+            break;
+
+        case GESTURE_STATE_HELD:
+        case GESTURE_STATE_WAIT_RELEASE:
+            btn->state = GESTURE_STATE_IDLE;
+            btn->click_count = 0;
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void prv_on_timeout(button_gesture_t *engine, uint8_t id, uint32_t now_ms)
+{
+    const button_gesture_config_t *cfg = &engine->configs[id];
+    button_gesture_button_t *btn = &engine->buttons[id];
+
+    switch (btn->state) {
+        case GESTURE_STATE_PRESSED:
+            if (cfg->hold_ms == 0) {
+                break;
+            }
+            btn->click_count = 0;
+            btn->repeat_count = 0;
+            if (cfg->hold_repeat_ms) {
+                btn->state = GESTURE_STATE_HELD;
+                btn->deadline = now_ms + cfg->hold_repeat_ms;
+            } else {
+                btn->state = GESTURE_STATE_WAIT_RELEASE;
+            }
+            prv_emit(engine, BUTTON_GESTURE_HOLD, id, 1);
+            break;
+
+        case GESTURE_STATE_HELD:
+            // 以上一次的期望时间为基准，避免重复间隔累积漂移
+            btn->deadline += cfg->hold_repeat_ms;
+            if (btn->repeat_count < UINT8_MAX) {
+                btn->repeat_count++;
+            }
+            prv_emit(engine, BUTTON_GESTURE_HOLD_REPEAT, id, btn->repeat_count);
+            break;
+
+        case GESTURE_STATE_WAIT_NEXT: {
+            uint8_t count = btn->click_count;
+            btn->state = GESTURE_STATE_IDLE;
+            btn->click_count = 0;
+            prv_emit(engine, BUTTON_GESTURE_CLICK, id, count);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static bool prv_has_deadline(const button_gesture_config_t *cfg, const button_gesture_button_t *btn)
+{
+    switch (btn->state) {
+        case GESTURE_STATE_PRESSED:   return cfg->hold_ms > 0;
+        case GESTURE_STATE_HELD:      return cfg->hold_repeat_ms > 0;
+        case GESTURE_STATE_WAIT_NEXT: return true;
+        default:                      return false;
+    }
+}
+
+void button_gesture_init(button_gesture_t *engine,
+                         const button_gesture_config_t *configs, uint8_t button_count,
+                         const button_chord_config_t *chords, uint8_t chord_count,
+                         button_gesture_cb_t callback, void *ctx, uint32_t initial_mask)
+{
+    memset(engine, 0, sizeof(*engine));
+    engine->configs = configs;
+    engine->button_count = button_count > BUTTON_GESTURE_MAX_BUTTONS ? BUTTON_GESTURE_MAX_BUTTONS : button_count;
+    engine->chords = chords;
+    engine->chord_count = chord_count > BUTTON_GESTURE_MAX_CHORDS ? BUTTON_GESTURE_MAX_CHORDS : chord_count;
+    engine->callback = callback;
+    engine->ctx = ctx;
+
+    for (uint8_t i = 0; i < engine->button_count; i++) {
+        bool pressed = (initial_mask >> i) & 1;
+        engine->buttons[i].stable_pressed = pressed;
+        engine->buttons[i].state = pressed ? GESTURE_STATE_WAIT_RELEASE : GESTURE_STATE_IDLE;
+    }
+}
+
+void button_gesture_on_edge(button_gesture_t *engine, uint8_t id, uint32_t now_ms)
+{
+    if (id >= engine->button_count) {
+        return;
+    }
+    engine->buttons[id].settle_pending = true;
+    engine->buttons[id].settle_deadline = now_ms + engine->configs[id].debounce_ms;
+}
+
+uint32_t button_gesture_process(button_gesture_t *engine, uint32_t pressed_mask, uint32_t now_ms)
+{
+    uint32_t next = BUTTON_GESTURE_NO_DEADLINE;
+
+    for (uint8_t id = 0; id < engine->button_count; id++) {
+        const button_gesture_config_t *cfg = &engine->configs[id];
+        button_gesture_button_t *btn = &engine->buttons[id];
+
+        if (btn->settle_pending && prv_reached(btn->settle_deadline, now_ms)) {
+            btn->settle_pending = false;
+            bool pressed = (pressed_mask >> id) & 1;
+            if (pressed != btn->stable_pressed) {
+                btn->stable_pressed = pressed;
+                prv_on_level(engine, id, pressed, now_ms);
+            }
+        }
+
+        if (prv_has_deadline(cfg, btn) && prv_reached(btn->deadline, now_ms)) {
+            prv_on_timeout(engine, id, now_ms);
+        }
+
+        // 汇总所有按键中最近的消抖/状态超时时刻
+        if (btn->settle_pending) {
+            uint32_t wait = (uint32_t)(btn->settle_deadline - now_ms);
+            next = wait < next ? wait : next;
+        }
+        if (prv_has_deadline(cfg, btn)) {
+            uint32_t wait = prv_reached(btn->deadline, now_ms) ? 0 : (uint32_t)(btn->deadline - now_ms);
+            next = wait < next ? wait : next;
+        }
+    }
+    return next;
+}
@@ -0,0 +1,97 @@
+#ifndef BUTTON_GESTURE_H
+#define BUTTON_GESTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * 表驱动的多按键手势引擎。
+ *
+ * 引擎本身不依赖 FreeRTOS/GPIO: 调用方在边沿中断后调用 button_gesture_on_edge()，
+ * 然后在 button_gesture_process() 返回的时间点 (或下一次边沿时) 再次调用处理函数，
+ * 传入当前所有按键的电平位掩码。空闲时 process 返回 BUTTON_GESTURE_NO_DEADLINE，
+ * 调用方可以无限期休眠。
+ */
+
+#define BUTTON_GESTURE_MAX_BUTTONS  (8)
+#define BUTTON_GESTURE_MAX_CHORDS   (4)
+#define BUTTON_GESTURE_NO_DEADLINE  (UINT32_MAX)
+
+typedef enum {
+    BUTTON_GESTURE_CLICK,        // n 连击 (count 为连击次数)
+    BUTTON_GESTURE_HOLD,         // 按住达到 hold_ms
+    BUTTON_GESTURE_HOLD_REPEAT,  // 长按后每隔 hold_repeat_ms 触发一次 (count 为重复次数，从1开始)
+    BUTTON_GESTURE_CHORD,        // 组合键 (id 为组合键下标)
+} button_gesture_type_t;
+
+/**
+ * @brief 单个按键的手势配置
+ */
+typedef struct {
+    uint16_t debounce_ms;     // 消抖时间，最后一次边沿后电平稳定这么久才采样
+    uint16_t click_gap_ms;    // 连击间隔，松开后在此时间内再次按下算作连击
+    uint8_t  max_clicks;      // 最大连击数，达到后立即上报不再等待；1 表示只识别单击 (松开即上报)
+    uint16_t hold_ms;         // 长按判定时间，0 表示禁用长按
+    uint16_t hold_repeat_ms;  // 长按后的重复间隔，0 表示不重复
+    bool     early_dispatch;  // 按下即上报单击，要求 max_clicks == 1 且 hold_ms == 0
+} button_gesture_config_t;
+
+/**
+ * @brief 组合键配置: 掩码中的按键在 window_ms 内全部按下即触发
+ *
+ * 触发后这些按键在全部松开前不再产生单独的手势。
+ */
+typedef struct {
+    uint32_t buttons_mask;
+    uint16_t window_ms;
+} button_chord_config_t;
+
+typedef void (*button_gesture_cb_t)(button_gesture_type_t type, uint8_t id, uint8_t count, void *ctx);
+
+typedef struct {
+    uint8_t  state;
+    bool     stable_pressed;
+    bool     settle_pending;
+    uint8_t  click_count;
+    uint8_t  repeat_count;
+    uint32_t settle_deadline;
+    uint32_t deadline;         // 当前状态的超时时刻，state 为空闲/等待释放时无效
+    uint32_t pressed_at;
+} button_gesture_button_t;
+
+typedef struct {
+    const button_gesture_config_t *configs;
+    uint8_t                        button_count;
+    const button_chord_config_t   *chords;
+    uint8_t                        chord_count;
+    button_gesture_cb_t            callback;
+    void                          *ctx;
+    button_gesture_button_t        buttons[BUTTON_GESTURE_MAX_BUTTONS];
+} button_gesture_t;
+
+/**
+ * @brief 初始化手势引擎，配置表需在引擎生命周期内保持有效
+ *
+ * @param initial_mask 初始电平位掩码 (上电时已按下的按键不会产生手势)
+ */
+void button_gesture_init(button_gesture_t *engine,
+                         const button_gesture_config_t *configs, uint8_t button_count,
+                         const button_chord_config_t *chords, uint8_t chord_count,
+                         button_gesture_cb_t callback, void *ctx, uint32_t initial_mask);
+
+/**
+ * @brief 通知引擎某个按键出现了边沿，重新开始该按键的消抖计时
+ */
+void button_gesture_on_edge(button_gesture_t *engine, uint8_t id, uint32_t now_ms);
+
+/**
+ * @brief 推进所有按键的消抖和手势状态机
+ *
+ * @param pressed_mask 当前所有按键的电平位掩码
+ * @param now_ms       当前时间 (毫秒，允许32位回绕)
+ *
+ * @return 距离下一次需要调用的毫秒数，没有待处理的超时时返回 BUTTON_GESTURE_NO_DEADLINE
+ */
+uint32_t button_gesture_process(button_gesture_t *engine, uint32_t pressed_mask, uint32_t now_ms);
+
+#endif // BUTTON_GESTURE_H
@@ -2,33 +2,41 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 
 // 引用依赖组件的头文件
 #include "bsp_button.h"
 #include "event_manager.h"
+#include "button_gesture.h"
 
 #define TAG "INPUT_HANDLER"
-
-// --- 新增的宏定义 ---
-#define DEBOUNCE_TIME_MS        50   // 按键消抖时间 (ms)
-#define LONG_PRESS_TIME_MS      1000 // 长按判定时间 (ms)
-#define DOUBLE_CLICK_TIME_MS    300  // 双击间隔时间 (ms)
-
-// --- 新增的枚举和变量 ---
-// 定义按钮状态机的状态
-typedef enum {
-    BUTTON_STATE_IDLE,          // 空闲状态
-    BUTTON_STATE_PRESSED,       // 已按下，等待消抖
-    BUTTON_STATE_WAIT_RELEASE,  // 等待释放 (已触发短按或长按)
-    BUTTON_STATE_WAIT_DOUBLE,   // 等待双击的第二次按下
-} ButtonState;
-
-static ButtonState current_button_state = BUTTON_STATE_IDLE; // 当前按键状态
-static TickType_t last_press_time = 0; // 上次按键按下的时间戳
+#define BUTTON_TASK_STACK_SIZE  (1024 * 3)
+
+// --- 每个按键的手势配置表 (下标即按键ID，与 bsp_button 的引脚表对应) ---
+static const button_gesture_config_t s_button_configs[BSP_BUTTON_NUM] = {
+    [0] = {
+        .debounce_ms = 30,       // 按键消抖时间
+        .click_gap_ms = 300,     // 双击间隔时间
+        .max_clicks = 2,         // 识别单击和双击
+        .hold_ms = 1000,         // 长按判定时间
+        .hold_repeat_ms = 0,
+        .early_dispatch = false,
+    },
+};
+
+// --- 组合键配置表 (目前板上只有一个按键，暂无组合键) ---
+// 例如按键0和按键1在80ms内同时按下:
+//   { .buttons_mask = (1 << 0) | (1 << 1), .window_ms = 80 },
+#define BUTTON_CHORD_TABLE  NULL
+#define BUTTON_CHORD_COUNT  (0)
+
+static button_gesture_t s_gesture_engine;
+static TaskHandle_t s_button_task_handle = NULL;
 
 // ======================= 修改点 1: 添加函数前向声明 =======================
 // 告诉编译器后面会有一个叫 send_button_event 的函数，这样在 button_scan_task 中就可以正常调用它了
-static void send_button_event(EventType_t event_type);
+static void send_button_event(EventType_t event_type, uint32_t arg);
 // =======================================================================
 
 
@@ -36,105 +44,114 @@ static void send_button_event(EventType_t event_type);
  * @brief 发送按键事件的辅助函数
  * 
  * @param event_type 要发送的事件类型
+ * @param arg        事件参数，见 BUTTON_EVENT_ARG
  */
 // ======================= 修改点 2: 修正函数参数的类型 =======================
-static void send_button_event(EventType_t event_type) // <-- 这里从 AppEventType_t 改为 EventType_t
+static void send_button_event(EventType_t event_type, uint32_t arg) // <-- 这里从 AppEventType_t 改为 EventType_t
 // =======================================================================
 {
     AppEvent_t event_msg = {
         .event_type = event_type,
-        .p_data = NULL,
-        .data_len = 0
+        .arg = arg,
+        .payload = NULL,
+        .producer = EVENT_PRODUCER_BUTTON
     };
 
-    QueueHandle_t queue = get_event_queue();
-    if (queue != NULL) {
-        if (xQueueSend(queue, &event_msg, 0) == pdPASS) {
-            ESP_LOGI(TAG, "成功发送事件: %d", event_type);
-        } else {
-            ESP_LOGW(TAG, "发送事件失败，队列已满: %d", event_type);
-        }
+    // 发布到事件总线，所有订阅了该按键事件的模块都会收到
+    esp_err_t err = event_bus_publish(&event_msg, 0);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "成功发布事件: %d", event_type);
     } else {
-        ESP_LOGE(TAG, "无法获取事件队列句柄");
+        ESP_LOGW(TAG, "发布事件失败 (%s): %d", esp_err_to_name(err), event_type);
+    }
+}
+
+
+// 手势引擎回调: 把手势转换为事件总线上的按键事件
+static void button_gesture_handler(button_gesture_type_t type, uint8_t id, uint8_t count, void *ctx)
+{
+    switch (type) {
+        case BUTTON_GESTURE_CLICK:
+            if (count == 1) {
+                send_button_event(EVENT_BUTTON_SHORT_PRESS, BUTTON_EVENT_ARG(id, 1));
+            } else if (count == 2) {
+                send_button_event(EVENT_BUTTON_DOUBLE_CLICK, BUTTON_EVENT_ARG(id, 2));
+            } else {
+                send_button_event(EVENT_BUTTON_MULTI_CLICK, BUTTON_EVENT_ARG(id, count));
+            }
+            break;
+
+        case BUTTON_GESTURE_HOLD:
+            send_button_event(EVENT_BUTTON_LONG_PRESS, BUTTON_EVENT_ARG(id, 1));
+            break;
+
+        case BUTTON_GESTURE_HOLD_REPEAT:
+            send_button_event(EVENT_BUTTON_HOLD_REPEAT, BUTTON_EVENT_ARG(id, count));
+            break;
+
+        case BUTTON_GESTURE_CHORD:
+            send_button_event(EVENT_BUTTON_CHORD, BUTTON_EVENT_ARG(id, 1));
+            break;
     }
 }
 
+// GPIO边沿中断: 只记录是哪个按键并唤醒按键任务，消抖和手势识别都在任务中完成
+static void IRAM_ATTR button_edge_isr(uint32_t button_id, void *arg)
+{
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    xTaskNotifyFromISR((TaskHandle_t)arg, 1UL << button_id, eSetBits, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
 
 static void button_scan_task(void *pvParameters)
 {
-    ESP_LOGI(TAG, "按键扫描任务已启动 (增强版)");
+    ESP_LOGI(TAG, "按键任务已启动 (中断驱动, %d 个按键)", BSP_BUTTON_NUM);
+
+    button_gesture_init(&s_gesture_engine, s_button_configs, BSP_BUTTON_NUM,
+                        BUTTON_CHORD_TABLE, BUTTON_CHORD_COUNT,
+                        button_gesture_handler, NULL, bsp_button_get_pressed_mask());
 
+    uint32_t next_ms = BUTTON_GESTURE_NO_DEADLINE;
     while(1) {
-        bool is_pressed = bsp_button_is_pressed();
-        TickType_t current_tick = xTaskGetTickCount();
-
-        switch (current_button_state) {
-            case BUTTON_STATE_IDLE:
-                // 空闲状态：等待按键按下
-                if (is_pressed) {
-                    last_press_time = current_tick; // 记录按下时间
-                    current_button_state = BUTTON_STATE_PRESSED;
-                }
-                break;
-
-            case BUTTON_STATE_PRESSED:
-                // 已按下状态：进行消抖并判断是长按还是短按
-                if (is_pressed) {
-                    // 检查是否达到长按时间
-                    if ((current_tick - last_press_time) >= pdMS_TO_TICKS(LONG_PRESS_TIME_MS)) {
-                        send_button_event(EVENT_BUTTON_LONG_PRESS);
-                        current_button_state = BUTTON_STATE_WAIT_RELEASE; // 进入等待释放状态
-                    }
-                } else {
-                    // 按下后短时间内释放，说明不是长按，可能是单击或双击的第一次
-                    // 进行防抖判断
-                    if ((current_tick - last_press_time) >= pdMS_TO_TICKS(DEBOUNCE_TIME_MS)) {
-                        last_press_time = current_tick; // 更新时间戳，用于双击计时
-                        current_button_state = BUTTON_STATE_WAIT_DOUBLE;
-                    } else {
-                        // 按下时间太短，认为是抖动，忽略
-                        current_button_state = BUTTON_STATE_IDLE;
-                    }
-                }
-                break;
-
-            case BUTTON_STATE_WAIT_DOUBLE:
-                // 等待双击状态：在指定时间内等待第二次按下或超时
-                if (is_pressed) {
-                    // 在双击间隔内被再次按下，判定为双击
-                    send_button_event(EVENT_BUTTON_DOUBLE_CLICK);
-                    current_button_state = BUTTON_STATE_WAIT_RELEASE; // 进入等待释放状态
-                } else {
-                    // 检查是否超过了双击等待时间
-                    if ((current_tick - last_press_time) >= pdMS_TO_TICKS(DOUBLE_CLICK_TIME_MS)) {
-                        // 超时未按下，判定为单击
-                        send_button_event(EVENT_BUTTON_SHORT_PRESS);
-                        current_button_state = BUTTON_STATE_IDLE; // 返回空闲状态
-                    }
-                }
-                break;
-            
-            case BUTTON_STATE_WAIT_RELEASE:
-                // 等待释放状态：在触发长按或双击后，必须等待按键释放才能进行下一次检测
-                if (!is_pressed) {
-                    current_button_state = BUTTON_STATE_IDLE;
-                }
-                break;
+        // 只在消抖结束或手势超时时醒来，空闲时无限期阻塞等待边沿中断
+        TickType_t wait = portMAX_DELAY;
+        if (next_ms != BUTTON_GESTURE_NO_DEADLINE) {
+            wait = (next_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
         }
 
-        // 任务轮询间隔
-        vTaskDelay(pdMS_TO_TICKS(20));
+        uint32_t edge_mask = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &edge_mask, wait);
+
+        uint32_t now = now_ms();
+        while (edge_mask) {
+            uint8_t id = __builtin_ctz(edge_mask);
+            edge_mask &= edge_mask - 1;
+            button_gesture_on_edge(&s_gesture_engine, id, now);
+        }
+        next_ms = button_gesture_process(&s_gesture_engine, bsp_button_get_pressed_mask(), now);
     }
 }
 
 void button_scan_task_start(void)
 {
-    xTaskCreate(
+    if (xTaskCreate(
         button_scan_task,
         "btn_scan_task",
-        8192,
+        BUTTON_TASK_STACK_SIZE,
         NULL,
         5,
-        NULL
-    );
+        &s_button_task_handle
+    ) != pdPASS) {
+        ESP_LOGE(TAG, "按键任务创建失败!");
+        return;
+    }
+
+    if (bsp_button_set_edge_callback(button_edge_isr, s_button_task_handle) != ESP_OK) {
+        ESP_LOGE(TAG, "按键中断注册失败，按键将无法使用!");
+    }
 }
\ No newline at end of file
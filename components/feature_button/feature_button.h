@@ -1,9 +1,15 @@
 #ifndef FEATURE_INPUT_HANDLER_H
 #define FEATURE_INPUT_HANDLER_H
 
+// 按键事件的 arg 编码: 低8位为按键ID (组合键事件为组合键下标)，其余位为次数
+#define BUTTON_EVENT_ARG(id, count)  ((uint32_t)(id) | ((uint32_t)(count) << 8))
+#define BUTTON_EVENT_ID(arg)         ((uint8_t)((arg) & 0xFF))
+#define BUTTON_EVENT_COUNT(arg)      ((uint32_t)(arg) >> 8)
+
 /**
  * @brief 启动输入处理任务
  * 
+ * 各按键的消抖、连击、长按和组合键参数见 feature_button.c 中的配置表。
  */
 void button_scan_task_start(void);
 
@@ -1,8 +1,11 @@
 #include "feature_motor.h"
 #include "bsp_motor.h" // 包含新的驱动层头文件
 #include "freertos/FreeRTOS.h"
-#include "freertos/timers.h"
+#include "freertos/task.h"
+#include "timer_service.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 
 static const char* TAG = "motor_module";
 
@@ -12,15 +15,69 @@ static const char* TAG = "motor_module";
 // =======================================================
 #define MADA_GPIO           GPIO_NUM_18
 #define MADA_LEDC_CHANNEL   LEDC_CHANNEL_0
-#define MADA_CONTROL_MODE   MADA_CONTROL_DIGITAL // 可切换为 MADA_CONTROL_PWM
+#ifndef MADA_CONTROL_MODE
+#define MADA_CONTROL_MODE   MADA_CONTROL_DIGITAL // 可切换为 MADA_CONTROL_PWM (主机测试按 PWM 编译)
+#endif
+
+#define HAPTIC_TASK_STACK_SIZE  (1024 * 2)
+#define HAPTIC_TASK_PRIORITY    (9)
+
+// 触觉任务通知位
+#define HAPTIC_NOTIFY_FADE_DONE (1u << 0)
+#define HAPTIC_NOTIFY_PLAY      (1u << 1)
+#define HAPTIC_NOTIFY_STOP      (1u << 2)   // 停止波形，并把 s_manual_on 应用到输出
 
 // 内部状态变量
 static bool          g_is_vibrating = false;
-static TimerHandle_t g_timer = NULL;
+static timer_service_timer_t g_timer;
 static bool          g_is_initialized = false;
 
+static TaskHandle_t  s_haptic_task = NULL;
+static haptic_engine_t s_haptic_engine;
+static bool          s_hw_fade = false;                       // 是否可用 LEDC 硬件渐变
+static const haptic_pattern_t* volatile s_pending_pattern = NULL;
+static volatile bool s_pattern_active = false;
+// 定时/持续震动的开关状态。输出只由触觉任务操作，调用方改完状态后通知任务，
+// 避免任务里较晚执行的停止把调用方刚打开的马达又关掉
+static volatile bool s_manual_on = false;
+static mada_output_start_cb_t volatile s_output_start_cb = NULL;
+static void* volatile s_output_start_arg = NULL;
+
+// =======================================================
+//  2. 内置波形表
+// =======================================================
+static const haptic_step_t s_steps_tap[] = {
+    HAPTIC_HOLD(255, 40),
+};
+static const haptic_step_t s_steps_double_tap[] = {
+    HAPTIC_PULSE(255, 40, 80),
+    HAPTIC_HOLD(255, 40),
+};
+static const haptic_step_t s_steps_ramp_up[] = {
+    HAPTIC_RAMP(255, 400),
+    HAPTIC_HOLD(255, 100),
+    HAPTIC_RAMP(0, 300),
+};
+static const haptic_step_t s_steps_heartbeat[] = {
+    HAPTIC_RAMP(200, 60),
+    HAPTIC_RAMP(0, 80),
+    HAPTIC_RAMP(255, 60),
+    HAPTIC_RAMP(0, 150),
+    HAPTIC_HOLD(0, 450),
+    HAPTIC_LOOP(0, 2),
+};
+
+static const haptic_pattern_t s_presets[MADA_PRESET_MAX] = {
+    [MADA_PRESET_TAP]        = HAPTIC_PATTERN(s_steps_tap),
+    [MADA_PRESET_DOUBLE_TAP] = HAPTIC_PATTERN(s_steps_double_tap),
+    [MADA_PRESET_RAMP_UP]    = HAPTIC_PATTERN(s_steps_ramp_up),
+    [MADA_PRESET_HEARTBEAT]  = HAPTIC_PATTERN(s_steps_heartbeat),
+};
+
 // 定时器回调函数
-static void timer_callback(TimerHandle_t timer);
+static void timer_callback(timer_service_timer_t *timer, void *arg);
+static esp_err_t prv_haptic_start(void);
+static void prv_haptic_notify(uint32_t bits);
 
 esp_err_t mada_initialize(void) {
     if (g_is_initialized) {
@@ -40,12 +97,21 @@ esp_err_t mada_initialize(void) {
         return ret;
     }
 
-    // 2. 创建用于定时震动的软件定时器
-    g_timer = xTimerCreate("mada_timer", pdMS_TO_TICKS(100), pdFALSE, NULL, timer_callback);
-    if (g_timer == NULL) {
-        ESP_LOGE(TAG, "Failed to create timer");
+    // 2. 初始化用于定时震动的定时器 (由共享定时器服务驱动)
+    ret = timer_service_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start timer service");
         mada_driver_deinit(); // 清理已初始化的驱动
-        return ESP_FAIL;
+        return ret;
+    }
+    timer_service_timer_init(&g_timer, timer_callback, NULL);
+
+    // 3. 触觉波形任务 (PWM 模式下步骤之间由 LEDC 硬件渐变完成)
+    ret = prv_haptic_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start haptic task");
+        mada_driver_deinit();
+        return ret;
     }
     
     g_is_initialized = true;
@@ -57,10 +123,10 @@ void mada_deinitialize() {
     if (!g_is_initialized) return;
     
     mada_stop();
-    if (g_timer != NULL) {
-        xTimerDelete(g_timer, portMAX_DELAY);
-        g_timer = NULL;
-    }
+    timer_service_cancel(&g_timer);
+    // 触觉任务保留，再次初始化时复用；这里只等它停掉当前波形
+    s_manual_on = false;
+    prv_haptic_notify(HAPTIC_NOTIFY_STOP);
     
     mada_driver_deinit(); // 反初始化底层驱动
     
@@ -69,14 +135,14 @@ void mada_deinitialize() {
 }
 
 void mada_stop() {
-    if (!g_is_initialized || !g_is_vibrating) return;
+    if (!g_is_initialized) return;
+    if (!s_pattern_active && !g_is_vibrating) return;
 
-    mada_driver_off(); // 调用驱动层函数
+    s_manual_on = false;
+    prv_haptic_notify(HAPTIC_NOTIFY_STOP);
     g_is_vibrating = false;
 
-    if (g_timer != NULL) {
-        xTimerStop(g_timer, 0);
-    }
+    timer_service_cancel(&g_timer);
 }
 
 void mada_set_intensity(uint8_t intensity) {
@@ -87,25 +153,22 @@ void mada_set_intensity(uint8_t intensity) {
 
 void mada_vibrate(uint32_t duration_ms) {
     if (!g_is_initialized) return;
-    
-    mada_driver_on(); // 调用驱动层函数
+
+    // 由触觉任务停掉波形后再打开马达
+    s_manual_on = true;
+    prv_haptic_notify(HAPTIC_NOTIFY_STOP);
     g_is_vibrating = true;
 
-    if (g_timer != NULL) {
-        xTimerChangePeriod(g_timer, pdMS_TO_TICKS(duration_ms), 0);
-        xTimerStart(g_timer, 0);
-    }
+    timer_service_start(&g_timer, duration_ms, 0);
 }
 
 void mada_continuous_vibrate() {
     if (!g_is_initialized) return;
     
-    // 停止可能正在运行的定时器
-    if (g_timer != NULL) {
-        xTimerStop(g_timer, 0);
-    }
-    
-    mada_driver_on(); // 调用驱动层函数
+    // 停止可能正在运行的定时器和波形
+    timer_service_cancel(&g_timer);
+    s_manual_on = true;
+    prv_haptic_notify(HAPTIC_NOTIFY_STOP);
     g_is_vibrating = true;
 }
 
@@ -117,11 +180,139 @@ void mada_long_vibrate() {
     mada_vibrate(500);
 }
 
+void mada_play_pattern(const haptic_pattern_t* pattern) {
+    if (!g_is_initialized || pattern == NULL) return;
+
+    // 与定时震动互斥: 先让任务关掉马达，再播放波形
+    if (g_is_vibrating) {
+        timer_service_cancel(&g_timer);
+        g_is_vibrating = false;
+        s_manual_on = false;
+        prv_haptic_notify(HAPTIC_NOTIFY_STOP);
+    }
+    s_pending_pattern = pattern;
+    s_pattern_active = true;
+    prv_haptic_notify(HAPTIC_NOTIFY_PLAY);
+}
+
+void mada_play_preset(mada_preset_t preset) {
+    if (preset >= MADA_PRESET_MAX) return;
+    mada_play_pattern(&s_presets[preset]);
+}
+
 bool mada_is_vibrating() {
-    return g_is_vibrating;
+    return g_is_vibrating || s_pattern_active;
 }
 
-static void timer_callback(TimerHandle_t timer) {
+void mada_set_output_start_cb(mada_output_start_cb_t cb, void* arg) {
+    // 先清回调再换参数，触觉任务不会拿到新旧混搭的一对
+    s_output_start_cb = NULL;
+    s_output_start_arg = arg;
+    s_output_start_cb = cb;
+}
+
+static void timer_callback(timer_service_timer_t *timer, void *arg) {
     // 定时器到期后，调用停止函数
     mada_stop();
-}
\ No newline at end of file
+}
+
+// =======================================================
+//  3. 触觉后端与任务
+// =======================================================
+static bool prv_backend_fade(void *ctx, uint8_t level, uint16_t time_ms) {
+    if (!s_hw_fade) {
+        return false;
+    }
+    return mada_driver_fade_start(level, time_ms) == ESP_OK;
+}
+
+static void prv_backend_set_level(void *ctx, uint8_t level) {
+    mada_driver_set_level(level);
+}
+
+static void prv_backend_stop(void *ctx) {
+    mada_driver_fade_stop();
+}
+
+static const haptic_backend_ops_t s_haptic_ops = {
+    .fade      = prv_backend_fade,
+    .set_level = prv_backend_set_level,
+    .stop      = prv_backend_stop,
+};
+
+// LEDC 渐变结束中断: 只通知任务发起下一步。IDF 的渐变接口在回调返回后才释放通道，
+// 不能在这里直接启动下一段渐变。
+static bool IRAM_ATTR prv_fade_done_isr(void* arg) {
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(s_haptic_task, HAPTIC_NOTIFY_FADE_DONE, eSetBits, &woken);
+    return woken == pdTRUE;
+}
+
+static void prv_haptic_notify(uint32_t bits) {
+    if (bits & HAPTIC_NOTIFY_STOP) {
+        // 先停后播的顺序可能在同一批通知里合并，清掉待播波形保证停止生效
+        s_pending_pattern = NULL;
+    }
+    if (s_haptic_task != NULL) {
+        xTaskNotify(s_haptic_task, bits, eSetBits);
+    }
+}
+
+static void haptic_task(void* arg) {
+    uint32_t wait_ms = HAPTIC_WAIT_IDLE;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        if (wait_ms != HAPTIC_WAIT_IDLE && wait_ms != HAPTIC_WAIT_FADE) {
+            wait = pdMS_TO_TICKS(wait_ms);
+            if (wait == 0) {
+                wait = 1;
+            }
+        }
+
+        uint32_t bits = 0;
+        BaseType_t notified = xTaskNotifyWait(0, UINT32_MAX, &bits, wait);
+
+        if (bits & HAPTIC_NOTIFY_STOP) {
+            haptic_engine_stop(&s_haptic_engine);
+            if (s_manual_on) {
+                mada_driver_on();
+            } else {
+                mada_driver_off();
+            }
+            wait_ms = HAPTIC_WAIT_IDLE;
+        }
+        if (bits & HAPTIC_NOTIFY_PLAY) {
+            const haptic_pattern_t* pattern = s_pending_pattern;
+            // 新波形会先停掉旧的渐变，同一批通知里的 FADE_DONE 属于旧波形，忽略
+            wait_ms = haptic_engine_play(&s_haptic_engine, pattern);
+            mada_output_start_cb_t cb = s_output_start_cb;
+            if (pattern != NULL && cb != NULL) {
+                cb(esp_timer_get_time(), s_output_start_arg);
+            }
+        } else if (!(bits & HAPTIC_NOTIFY_STOP)) {
+            bool fade_done = (notified == pdTRUE) && (bits & HAPTIC_NOTIFY_FADE_DONE) && wait_ms == HAPTIC_WAIT_FADE;
+            bool hold_done = (notified != pdTRUE) && wait_ms != HAPTIC_WAIT_IDLE && wait_ms != HAPTIC_WAIT_FADE;
+            if (fade_done || hold_done) {
+                wait_ms = haptic_engine_advance(&s_haptic_engine);
+            }
+        }
+
+        s_pattern_active = haptic_engine_is_playing(&s_haptic_engine);
+    }
+}
+
+static esp_err_t prv_haptic_start(void) {
+    haptic_engine_init(&s_haptic_engine, &s_haptic_ops, NULL);
+
+    if (s_haptic_task == NULL &&
+        xTaskCreate(haptic_task, "haptic_task", HAPTIC_TASK_STACK_SIZE, NULL,
+                    HAPTIC_TASK_PRIORITY, &s_haptic_task) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 数字模式不支持硬件渐变，引擎会退化为开/关并由任务计时
+    s_hw_fade = (mada_driver_fade_init(prv_fade_done_isr, NULL) == ESP_OK);
+    ESP_LOGI(TAG, "Haptic engine ready (%s)", s_hw_fade ? "LEDC fade" : "digital fallback");
+    return ESP_OK;
+}
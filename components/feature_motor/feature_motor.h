@@ -4,6 +4,18 @@
 #include "esp_err.h"
 #include <stdbool.h>
 #include <stdint.h>
+#include "haptic_engine.h"
+
+/**
+ * @brief 内置的触觉波形
+ */
+typedef enum {
+    MADA_PRESET_TAP,        // 短促轻触
+    MADA_PRESET_DOUBLE_TAP, // 两次轻触
+    MADA_PRESET_RAMP_UP,    // 由弱到强渐入后渐出
+    MADA_PRESET_HEARTBEAT,  // 心跳 (重复三次)
+    MADA_PRESET_MAX,
+} mada_preset_t;
 
 /**
  * @brief 初始化震动马达模块 (使用内部预设配置)
@@ -51,6 +63,19 @@ void mada_short_vibrate(void);
  */
 void mada_long_vibrate(void);
 
+/**
+ * @brief 播放一个触觉波形，打断当前的震动
+ *
+ * PWM 模式下渐变步骤由 LEDC 硬件完成；数字模式下渐变退化为开/关。
+ * 步骤表需在播放期间保持有效 (通常为 static const)。
+ */
+void mada_play_pattern(const haptic_pattern_t* pattern);
+
+/**
+ * @brief 播放内置波形
+ */
+void mada_play_preset(mada_preset_t preset);
+
 /**
  * @brief 检查马达当前是否正在震动
  *
@@ -59,4 +84,18 @@ void mada_long_vibrate(void);
  */
 bool mada_is_vibrating(void);
 
+/**
+ * @brief 波形开始输出的回调，在触觉任务中调用，不能阻塞
+ *
+ * @param start_us 触觉任务发出第一个步骤的时刻 (esp_timer 时基)
+ */
+typedef void (*mada_output_start_cb_t)(int64_t start_us, void* arg);
+
+/**
+ * @brief 注册波形开始输出的回调 (只保留一个)，用于测量从触发到马达实际动作的延迟
+ *
+ * @param cb 传 NULL 取消注册
+ */
+void mada_set_output_start_cb(mada_output_start_cb_t cb, void* arg);
+
 #endif
\ No newline at end of file
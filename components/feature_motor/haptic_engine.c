@@ -0,0 +1,108 @@
+#include "haptic_engine.h"
+#include <stddef.h>
+
+void haptic_engine_init(haptic_engine_t *engine, const haptic_backend_ops_t *ops, void *ctx)
+{
+    engine->ops = ops;
+    engine->ctx = ctx;
+    engine->pattern = NULL;
+    engine->index = 0;
+    engine->loop_index = -1;
+    engine->loop_left = 0;
+}
+
+uint32_t haptic_engine_play(haptic_engine_t *engine, const haptic_pattern_t *pattern)
+{
+    if (engine->pattern != NULL) {
+        engine->ops->stop(engine->ctx);
+    }
+    engine->pattern = pattern;
+    engine->index = 0;
+    engine->loop_index = -1;
+    engine->loop_left = 0;
+    if (pattern == NULL || pattern->count == 0) {
+        engine->pattern = NULL;
+        return HAPTIC_WAIT_IDLE;
+    }
+    return haptic_engine_advance(engine);
+}
+
+uint32_t haptic_engine_advance(haptic_engine_t *engine)
+{
+    const haptic_pattern_t *pattern = engine->pattern;
+    if (pattern == NULL) {
+        return HAPTIC_WAIT_IDLE;
+    }
+
+    // 零时长的步骤 (立即设置、循环跳转) 连续执行，直到遇到需要等待的步骤
+    for (uint32_t guard = 0; guard < HAPTIC_MAX_IDLE_STEPS; guard++) {
+        if (engine->index >= pattern->count) {
+            break;
+        }
+
+        const haptic_step_t *step = &pattern->steps[engine->index];
+        switch (step->op) {
+        case HAPTIC_OP_RAMP:
+            engine->index++;
+            if (step->time_ms == 0) {
+                engine->ops->set_level(engine->ctx, step->level);
+                continue;
+            }
+            if (engine->ops->fade(engine->ctx, step->level, step->time_ms)) {
+                return HAPTIC_WAIT_FADE;
+            }
+            // 后端不支持渐变: 直接跳到目标强度，并保持原定的时长
+            engine->ops->set_level(engine->ctx, step->level);
+            return step->time_ms;
+
+        case HAPTIC_OP_HOLD:
+            engine->index++;
+            engine->ops->set_level(engine->ctx, step->level);
+            if (step->time_ms == 0) {
+                continue;
+            }
+            return step->time_ms;
+
+        case HAPTIC_OP_LOOP:
+            if (engine->loop_index != (int16_t)engine->index) {
+                engine->loop_index = (int16_t)engine->index;
+                engine->loop_left = step->time_ms;
+            }
+            if (engine->loop_left == 0 || step->level >= engine->index) {
+                // 循环结束 (或跳转目标非法)，继续执行后面的步骤
+                engine->loop_index = -1;
+                engine->index++;
+                continue;
+            }
+            if (engine->loop_left != HAPTIC_LOOP_FOREVER) {
+                engine->loop_left--;
+            }
+            engine->index = step->level;
+            continue;
+
+        default:
+            engine->index++;
+            continue;
+        }
+    }
+
+    // 播放结束或零时长步骤过多 (例如只有跳转的无限循环)，关闭输出
+    engine->ops->set_level(engine->ctx, 0);
+    engine->pattern = NULL;
+    return HAPTIC_WAIT_IDLE;
+}
+
+void haptic_engine_stop(haptic_engine_t *engine)
+{
+    if (engine->pattern == NULL) {
+        return;
+    }
+    engine->ops->stop(engine->ctx);
+    engine->ops->set_level(engine->ctx, 0);
+    engine->pattern = NULL;
+}
+
+bool haptic_engine_is_playing(const haptic_engine_t *engine)
+{
+    return engine->pattern != NULL;
+}
@@ -0,0 +1,102 @@
+#ifndef HAPTIC_ENGINE_H
+#define HAPTIC_ENGINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * 表驱动的触觉包络引擎。
+ *
+ * 波形由 4 字节的步骤表描述 (渐变/保持/循环)，引擎本身不依赖 FreeRTOS/LEDC:
+ * 输出通过 haptic_backend_ops_t 交给后端。后端的 fade 接口是异步的，硬件渐变
+ * 结束后由调用方再次调用 haptic_engine_advance()；保持步骤和不支持渐变的后端
+ * (数字GPIO) 则由 advance 的返回值告诉调用方需要等待多久。
+ * 主机上用记录调用的假后端即可驱动整个引擎。
+ */
+
+#define HAPTIC_WAIT_IDLE        (UINT32_MAX)      // 播放结束，无需再调用 advance
+#define HAPTIC_WAIT_FADE        (UINT32_MAX - 1)  // 等待后端的渐变完成通知
+#define HAPTIC_LOOP_FOREVER     (0xFFFF)
+#define HAPTIC_MAX_IDLE_STEPS   (64)              // 单次 advance 最多连续执行的零时长步骤数
+
+typedef enum {
+    HAPTIC_OP_RAMP,  // 在 time_ms 内从当前强度线性变化到 level
+    HAPTIC_OP_HOLD,  // 立即设置为 level 并保持 time_ms
+    HAPTIC_OP_LOOP,  // 跳回下标 level 处，额外重复 time_ms 次 (HAPTIC_LOOP_FOREVER 为无限)
+} haptic_op_t;
+
+/**
+ * @brief 波形步骤，每步 4 字节，可直接放在 flash 中的常量表里
+ */
+typedef struct {
+    uint8_t  op;       // haptic_op_t
+    uint8_t  level;    // 目标强度 0-255；LOOP 时为跳转目标下标
+    uint16_t time_ms;  // 渐变/保持时长；LOOP 时为重复次数
+} haptic_step_t;
+
+#define HAPTIC_RAMP(level, ms)          { HAPTIC_OP_RAMP, (level), (ms) }
+#define HAPTIC_HOLD(level, ms)          { HAPTIC_OP_HOLD, (level), (ms) }
+#define HAPTIC_PULSE(level, on_ms, off_ms) HAPTIC_HOLD(level, on_ms), HAPTIC_HOLD(0, off_ms)
+#define HAPTIC_LOOP(to_index, times)    { HAPTIC_OP_LOOP, (to_index), (times) }
+
+typedef struct {
+    const haptic_step_t *steps;
+    uint8_t              count;
+} haptic_pattern_t;
+
+#define HAPTIC_PATTERN(table)  { (table), (uint8_t)(sizeof(table) / sizeof((table)[0])) }
+
+/**
+ * @brief 输出后端
+ */
+typedef struct {
+    // 启动硬件渐变并立即返回，完成后调用方需调用 haptic_engine_advance()。
+    // 返回 false 表示不支持渐变，引擎会退化为直接设置目标强度并计时等待。
+    bool (*fade)(void *ctx, uint8_t level, uint16_t time_ms);
+    // 立即设置输出强度
+    void (*set_level)(void *ctx, uint8_t level);
+    // 中止正在进行的渐变
+    void (*stop)(void *ctx);
+} haptic_backend_ops_t;
+
+typedef struct {
+    const haptic_backend_ops_t *ops;
+    void                       *ctx;
+    const haptic_pattern_t     *pattern;
+    uint8_t                     index;       // 下一个要执行的步骤
+    int16_t                     loop_index;  // 当前正在计数的 LOOP 步骤下标，-1 表示无
+    uint16_t                    loop_left;
+} haptic_engine_t;
+
+/**
+ * @brief 初始化引擎，ops 需在引擎生命周期内保持有效
+ */
+void haptic_engine_init(haptic_engine_t *engine, const haptic_backend_ops_t *ops, void *ctx);
+
+/**
+ * @brief 开始播放一个波形 (会打断正在播放的波形)，步骤表需在播放期间保持有效
+ *
+ * @return 需要等待的毫秒数，或 HAPTIC_WAIT_FADE / HAPTIC_WAIT_IDLE
+ */
+uint32_t haptic_engine_play(haptic_engine_t *engine, const haptic_pattern_t *pattern);
+
+/**
+ * @brief 当前步骤结束 (渐变完成或等待时间到) 时调用，执行后续步骤
+ *
+ * 不支持循环嵌套: 内层 LOOP 会重置外层的计数。
+ *
+ * @return 同 haptic_engine_play()
+ */
+uint32_t haptic_engine_advance(haptic_engine_t *engine);
+
+/**
+ * @brief 停止播放并关闭输出
+ */
+void haptic_engine_stop(haptic_engine_t *engine);
+
+/**
+ * @brief 是否正在播放
+ */
+bool haptic_engine_is_playing(const haptic_engine_t *engine);
+
+#endif
@@ -0,0 +1,216 @@
+#include "init_graph.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "boot_trace.h"
+
+#define TAG "INIT_GRAPH"
+#define INIT_GRAPH_WORKER_STACK_SIZE (1024 * 4)
+#define INIT_GRAPH_WORKER_PRIORITY   (5)
+
+// 一次启动图执行期间的共享状态，claimed/failed 受 lock 保护，
+// 节点结束 (成功、失败或跳过) 时在 done 事件组中置位
+static struct {
+    const init_graph_node_t *nodes;
+    size_t count;
+    uint32_t all_mask;
+    uint32_t claimed;   // 已被工作任务领取 (或已跳过) 的节点
+    uint32_t failed;    // 失败或因依赖失败而被跳过的节点
+    SemaphoreHandle_t lock;
+    EventGroupHandle_t done;
+    SemaphoreHandle_t workers_exited;
+} s_graph;
+
+static volatile bool s_graph_busy = false;
+static portMUX_TYPE s_graph_busy_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 检查依赖是否越界、自依赖或成环 (按拓扑序逐层消解)
+static bool prv_validate(const init_graph_node_t *nodes, size_t count)
+{
+    uint32_t all_mask = (1UL << count) - 1;
+    uint32_t resolved = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (nodes[i].fn == NULL || (nodes[i].deps & ~all_mask) || (nodes[i].deps & INIT_GRAPH_DEP(i))) {
+            ESP_LOGE(TAG, "节点 '%s' 的定义非法", nodes[i].name ? nodes[i].name : "?");
+            return false;
+        }
+    }
+
+    while (resolved != all_mask) {
+        uint32_t layer = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!(resolved & INIT_GRAPH_DEP(i)) && (nodes[i].deps & ~resolved) == 0) {
+                layer |= INIT_GRAPH_DEP(i);
+            }
+        }
+        if (layer == 0) {
+            ESP_LOGE(TAG, "启动图存在循环依赖, 未能消解的节点掩码: 0x%08lx", (unsigned long)(all_mask & ~resolved));
+            return false;
+        }
+        resolved |= layer;
+    }
+    return true;
+}
+
+// 领取下一个依赖已全部完成的节点。依赖失败的节点在这里直接跳过。
+// 返回 -1 表示暂时没有可执行的节点，wait_mask 为需要等待的节点位。
+// 调用方需持有 s_graph.lock。
+static int prv_claim_next(uint32_t *wait_mask)
+{
+    bool skipped;
+    do {
+        skipped = false;
+        uint32_t finished = xEventGroupGetBits(s_graph.done) & s_graph.all_mask;
+        *wait_mask = 0;
+
+        for (size_t i = 0; i < s_graph.count; i++) {
+            uint32_t bit = INIT_GRAPH_DEP(i);
+            uint32_t deps = s_graph.nodes[i].deps;
+            if (s_graph.claimed & bit) {
+                continue;
+            }
+            if (deps & s_graph.failed) {
+                ESP_LOGE(TAG, "依赖失败，跳过节点 '%s'", s_graph.nodes[i].name);
+                s_graph.claimed |= bit;
+                s_graph.failed |= bit;
+                xEventGroupSetBits(s_graph.done, bit);
+                skipped = true;
+                continue;
+            }
+            if ((deps & finished) == deps) {
+                s_graph.claimed |= bit;
+                return (int)i;
+            }
+            *wait_mask |= deps & ~finished;
+        }
+    } while (skipped);
+
+    return -1;
+}
+
+static void prv_worker_task(void *pvParameters)
+{
+    for (;;) {
+        uint32_t wait_mask = 0;
+
+        xSemaphoreTake(s_graph.lock, portMAX_DELAY);
+        int index = prv_claim_next(&wait_mask);
+        bool all_claimed = (s_graph.claimed == s_graph.all_mask);
+        xSemaphoreGive(s_graph.lock);
+
+        if (index < 0) {
+            if (all_claimed) {
+                break;
+            }
+            // 等待任意一个尚未完成的依赖结束后再尝试领取
+            xEventGroupWaitBits(s_graph.done, wait_mask, pdFALSE, pdFALSE, portMAX_DELAY);
+            continue;
+        }
+
+        const init_graph_node_t *node = &s_graph.nodes[index];
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t err = node->fn();
+        int64_t cost_us = esp_timer_get_time() - start_us;
+        boot_trace_mark(node->name);
+
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "节点 '%s' 初始化失败: %s", node->name, esp_err_to_name(err));
+            xSemaphoreTake(s_graph.lock, portMAX_DELAY);
+            s_graph.failed |= INIT_GRAPH_DEP(index);
+            xSemaphoreGive(s_graph.lock);
+        } else {
+            ESP_LOGI(TAG, "节点 '%s' 完成 (core %d, 耗时 %lld us)", node->name, (int)xPortGetCoreID(), (long long)cost_us);
+        }
+        // 必须在更新 failed 之后置位，保证其他任务看到完成位时也能看到失败状态
+        xEventGroupSetBits(s_graph.done, INIT_GRAPH_DEP(index));
+    }
+
+    xSemaphoreGive(s_graph.workers_exited);
+    vTaskDelete(NULL);
+}
+
+static void prv_release(void)
+{
+    if (s_graph.workers_exited) {
+        vSemaphoreDelete(s_graph.workers_exited);
+    }
+    if (s_graph.done) {
+        vEventGroupDelete(s_graph.done);
+    }
+    if (s_graph.lock) {
+        vSemaphoreDelete(s_graph.lock);
+    }
+    s_graph.workers_exited = NULL;
+    s_graph.done = NULL;
+    s_graph.lock = NULL;
+
+    taskENTER_CRITICAL(&s_graph_busy_lock);
+    s_graph_busy = false;
+    taskEXIT_CRITICAL(&s_graph_busy_lock);
+}
+
+esp_err_t init_graph_run(const init_graph_node_t *nodes, size_t count, TickType_t timeout, uint32_t *failed_mask)
+{
+    if (nodes == NULL || count == 0 || count > INIT_GRAPH_MAX_NODES || !prv_validate(nodes, count)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&s_graph_busy_lock);
+    bool busy = s_graph_busy;
+    s_graph_busy = true;
+    taskEXIT_CRITICAL(&s_graph_busy_lock);
+    if (busy) {
+        ESP_LOGE(TAG, "已有启动图在执行");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_graph.nodes = nodes;
+    s_graph.count = count;
+    s_graph.all_mask = (1UL << count) - 1;
+    s_graph.claimed = 0;
+    s_graph.failed = 0;
+    s_graph.lock = xSemaphoreCreateMutex();
+    s_graph.done = xEventGroupCreate();
+    s_graph.workers_exited = xSemaphoreCreateCounting(INIT_GRAPH_WORKER_COUNT, 0);
+    if (!s_graph.lock || !s_graph.done || !s_graph.workers_exited) {
+        ESP_LOGE(TAG, "创建同步对象失败!");
+        prv_release();
+        return ESP_ERR_NO_MEM;
+    }
+
+    int started = 0;
+    for (int core = 0; core < INIT_GRAPH_WORKER_COUNT; core++) {
+        if (xTaskCreatePinnedToCore(prv_worker_task, "init_worker", INIT_GRAPH_WORKER_STACK_SIZE,
+                                    NULL, INIT_GRAPH_WORKER_PRIORITY, NULL, core % portNUM_PROCESSORS) == pdPASS) {
+            started++;
+        }
+    }
+    if (started == 0) {
+        ESP_LOGE(TAG, "创建工作任务失败!");
+        prv_release();
+        return ESP_ERR_NO_MEM;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(s_graph.done, s_graph.all_mask, pdFALSE, pdTRUE, timeout);
+    if ((bits & s_graph.all_mask) != s_graph.all_mask) {
+        // 工作任务仍在访问共享状态，不能释放，启动图保持占用
+        ESP_LOGE(TAG, "等待启动图超时, 未完成的节点掩码: 0x%08lx", (unsigned long)(s_graph.all_mask & ~bits));
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // 全部节点已结束，等工作任务退出后再释放同步对象
+    for (int i = 0; i < started; i++) {
+        xSemaphoreTake(s_graph.workers_exited, portMAX_DELAY);
+    }
+
+    uint32_t failed = s_graph.failed;
+    prv_release();
+
+    if (failed_mask) {
+        *failed_mask = failed;
+    }
+    return failed ? ESP_FAIL : ESP_OK;
+}
@@ -0,0 +1,60 @@
+#ifndef INIT_GRAPH_H
+#define INIT_GRAPH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 单次启动图最多支持的节点数 (受 FreeRTOS 事件组可用位数限制)
+#define INIT_GRAPH_MAX_NODES   24
+// 工作任务数量，分别固定在 core 0 和 core 1 上
+#define INIT_GRAPH_WORKER_COUNT 2
+
+// 将节点下标转换为依赖位掩码，例如 INIT_GRAPH_DEP(NODE_A) | INIT_GRAPH_DEP(NODE_B)
+#define INIT_GRAPH_DEP(index) (1UL << (index))
+
+typedef esp_err_t (*init_graph_fn_t)(void);
+
+/**
+ * @brief 启动图中的一个初始化节点
+ */
+typedef struct {
+    const char     *name;  // 节点名称，同时作为 boot_trace 的阶段名
+    init_graph_fn_t fn;    // 初始化函数
+    uint32_t        deps;  // 依赖的节点位掩码 (见 INIT_GRAPH_DEP)，只能依赖数组中的其他节点
+} init_graph_node_t;
+
+/**
+ * @brief 并行执行一组有依赖关系的初始化函数，并阻塞等待全部结束
+ *
+ * 节点在 INIT_GRAPH_WORKER_COUNT 个工作任务上执行，依赖全部成功的节点才会被调度；
+ * 某个节点失败时，所有直接或间接依赖它的节点都会被跳过并视为失败。
+ * 每个节点结束时会以其名称调用 boot_trace_mark()。
+ *
+ * 同一时间只能有一张启动图在执行。nodes 数组在函数返回前必须保持有效。
+ *
+ * @param nodes       节点数组
+ * @param count       节点数量 (1 ~ INIT_GRAPH_MAX_NODES)
+ * @param timeout     等待全部节点结束的最长时间
+ * @param failed_mask 输出参数，失败或被跳过的节点位掩码，可为NULL
+ *
+ * @return
+ *  - ESP_OK                 全部节点成功
+ *  - ESP_FAIL               至少一个节点失败或被跳过
+ *  - ESP_ERR_TIMEOUT        超时仍有节点未完成
+ *  - ESP_ERR_INVALID_ARG    参数或依赖关系非法 (越界、自依赖、存在环)
+ *  - ESP_ERR_INVALID_STATE  已有启动图在执行
+ *  - ESP_ERR_NO_MEM         创建同步对象或工作任务失败
+ */
+esp_err_t init_graph_run(const init_graph_node_t *nodes, size_t count, TickType_t timeout, uint32_t *failed_mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,5 +1,6 @@
 #include "storage_manager.h"
 #include "esp_vfs_fat.h"
+#include "nvs_flash.h"
 #include "esp_log.h"
 #include <dirent.h>
 
@@ -45,4 +46,19 @@ esp_err_t storage_init(void)
         ESP_LOGE(TAG, "Could not open directory %s", MOUNT_PATH);
     }
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+esp_err_t storage_nvs_init(void)
+{
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        // NVS 只保存可以重新生成的缓存数据 (如模组波特率)，擦除不会丢失用户数据
+        ESP_LOGW(TAG, "NVS partition needs erase (%s)", esp_err_to_name(err));
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init NVS (%s)", esp_err_to_name(err));
+    }
+    return err;
+}
@@ -2,4 +2,6 @@
 #define STORAGE_MANAGER_H
 #include "esp_err.h"
 esp_err_t storage_init(void);
+// 初始化 NVS 分区，分区已满或版本不符时擦除后重建
+esp_err_t storage_nvs_init(void);
 #endif
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include "timer_service.h"
+#include <string.h>
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#define TAG "TIMER_SERVICE"
+#define TIMER_SERVICE_TASK_STACK_SIZE (1024 * 4)
+#define TIMER_SERVICE_TASK_PRIORITY   (8)
+
+// 时间轮结构: 第0级 256 个槽 (每槽1 tick)，其上3级各 64 个槽，
+// 共覆盖 2^26 个 tick (100Hz 时约7.7天)，更远的到期时间会被截断
+#define WHEEL0_BITS   (8)
+#define WHEELN_BITS   (6)
+#define WHEEL0_SIZE   (1 << WHEEL0_BITS)
+#define WHEELN_SIZE   (1 << WHEELN_BITS)
+#define WHEEL0_MASK   (WHEEL0_SIZE - 1)
+#define WHEELN_MASK   (WHEELN_SIZE - 1)
+#define UPPER_LEVELS  (3)
+#define MAX_DELTA     ((1UL << (WHEEL0_BITS + UPPER_LEVELS * WHEELN_BITS)) - 1)
+
+static timer_service_timer_t *s_wheel0[WHEEL0_SIZE];
+static timer_service_timer_t *s_wheel_upper[UPPER_LEVELS][WHEELN_SIZE];
+static timer_service_timer_t *s_expired = NULL;       // 已到期、等待执行回调的定时器
+static uint32_t s_wheel0_bitmap[WHEEL0_SIZE / 32];    // 第0级非空槽位图，用于快速计算下一个到期时间
+static uint32_t s_upper_count = 0;                    // 挂在上层时间轮中的定时器数量
+static TickType_t s_wheel_now = 0;                    // 下一个待处理的 tick
+static TickType_t s_wait_until = 0;                   // 服务任务本次休眠的唤醒时间
+static bool s_wait_forever = true;                    // 服务任务没有定时器，无限期休眠
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task_handle = NULL;
+
+static inline bool prv_in_wheel0(timer_service_timer_t **head)
+{
+    return head >= &s_wheel0[0] && head < &s_wheel0[WHEEL0_SIZE];
+}
+
+static inline bool prv_in_upper(timer_service_timer_t **head)
+{
+    return head >= &s_wheel_upper[0][0] && head < &s_wheel_upper[UPPER_LEVELS - 1][WHEELN_SIZE];
+}
+
+static void prv_list_add(timer_service_timer_t **head, timer_service_timer_t *timer)
+{
+    timer->prev = NULL;
+    timer->next = *head;
+    if (*head) {
+        (*head)->prev = timer;
+    }
+    *head = timer;
+    timer->head = head;
+
+    if (prv_in_wheel0(head)) {
+        uint32_t idx = head - s_wheel0;
+        s_wheel0_bitmap[idx / 32] |= (1UL << (idx % 32));
+    } else if (prv_in_upper(head)) {
+        s_upper_count++;
+    }
+}
+
+static void prv_list_del(timer_service_timer_t *timer)
+{
+    timer_service_timer_t **head = timer->head;
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        *head = timer->next;
+    }
+    if (timer->next) {
+        timer->next->prev = timer->prev;
+    }
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->head = NULL;
+
+    if (prv_in_wheel0(head)) {
+        if (*head == NULL) {
+            uint32_t idx = head - s_wheel0;
+            s_wheel0_bitmap[idx / 32] &= ~(1UL << (idx % 32));
+        }
+    } else if (prv_in_upper(head)) {
+        s_upper_count--;
+    }
+}
+
+// 时间轮中没有任何定时器 (到期链表由服务任务自己处理，不算在内)，调用方需持有 s_lock
+static bool prv_wheel_empty(void)
+{
+    if (s_upper_count > 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < WHEEL0_SIZE / 32; i++) {
+        if (s_wheel0_bitmap[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 按距离选择层级和槽位，调用方需持有 s_lock
+static void prv_insert(timer_service_timer_t *timer)
+{
+    int32_t delta = (int32_t)(timer->expires - s_wheel_now);
+    if (delta < 0) {
+        // 已经过期 (例如周期定时器追赶)，放到下一个待处理的槽
+        timer->expires = s_wheel_now;
+        delta = 0;
+    } else if ((uint32_t)delta > MAX_DELTA) {
+        timer->expires = s_wheel_now + MAX_DELTA;
+        delta = MAX_DELTA;
+    }
+
+    TickType_t expires = timer->expires;
+    timer_service_timer_t **head;
+    if ((uint32_t)delta < WHEEL0_SIZE) {
+        head = &s_wheel0[expires & WHEEL0_MASK];
+    } else if ((uint32_t)delta < (1UL << (WHEEL0_BITS + WHEELN_BITS))) {
+        head = &s_wheel_upper[0][(expires >> WHEEL0_BITS) & WHEELN_MASK];
+    } else if ((uint32_t)delta < (1UL << (WHEEL0_BITS + 2 * WHEELN_BITS))) {
+        head = &s_wheel_upper[1][(expires >> (WHEEL0_BITS + WHEELN_BITS)) & WHEELN_MASK];
+    } else {
+        head = &s_wheel_upper[2][(expires >> (WHEEL0_BITS + 2 * WHEELN_BITS)) & WHEELN_MASK];
+    }
+    prv_list_add(head, timer);
+}
+
+// 把上层某个槽的定时器按剩余时间重新分配到下层，返回该槽下标
+static uint32_t prv_cascade(int level, uint32_t index)
+{
+    timer_service_timer_t *timer = s_wheel_upper[level][index];
+    while (timer) {
+        timer_service_timer_t *next = timer->next;
+        prv_list_del(timer);
+        prv_insert(timer);
+        timer = next;
+    }
+    return index;
+}
+
+// 处理一个 tick: 必要时逐级下放，然后把第0级当前槽移到到期链表
+static void prv_advance_one_tick(void)
+{
+    uint32_t idx = s_wheel_now & WHEEL0_MASK;
+    if (idx == 0 &&
+        prv_cascade(0, (s_wheel_now >> WHEEL0_BITS) & WHEELN_MASK) == 0 &&
+        prv_cascade(1, (s_wheel_now >> (WHEEL0_BITS + WHEELN_BITS)) & WHEELN_MASK) == 0) {
+        prv_cascade(2, (s_wheel_now >> (WHEEL0_BITS + 2 * WHEELN_BITS)) & WHEELN_MASK);
+    }
+
+    while (s_wheel0[idx]) {
+        timer_service_timer_t *timer = s_wheel0[idx];
+        prv_list_del(timer);
+        prv_list_add(&s_expired, timer);
+    }
+    s_wheel_now++;
+}
+
+// 距离 s_wheel_now 还有多少 tick 需要处理 (到期或下放)，没有定时器时返回 portMAX_DELAY
+static TickType_t prv_ticks_to_next_event(void)
+{
+    TickType_t best = portMAX_DELAY;
+
+    // 第0级: 从当前槽开始找第一个非空槽
+    uint32_t start = s_wheel_now & WHEEL0_MASK;
+    for (uint32_t offset = 0; offset < WHEEL0_SIZE; ) {
+        uint32_t idx = (start + offset) & WHEEL0_MASK;
+        uint32_t word = s_wheel0_bitmap[idx / 32] >> (idx % 32);
+        if (word) {
+            uint32_t step = __builtin_ctz(word);
+            // 不能越过第0级末尾回绕后的起点
+            if (offset + step < WHEEL0_SIZE) {
+                best = offset + step;
+            }
+            break;
+        }
+        offset += 32 - (idx % 32);
+    }
+
+    // 上层: 下一次下放发生在第0级回到下标0时
+    if (s_upper_count > 0) {
+        TickType_t to_cascade = (WHEEL0_SIZE - start) & WHEEL0_MASK;
+        if (to_cascade < best) {
+            best = to_cascade;
+        }
+    }
+    return best;
+}
+
+static void prv_dispatch(timer_service_timer_t *timer, timer_service_cb_t callback, void *arg,
+                         EventType_t event_type, uint32_t event_arg)
+{
+    if (callback) {
+        callback(timer, arg);
+        return;
+    }
+    if (event_type != EVENT_NONE) {
+        AppEvent_t event = {
+            .event_type = event_type,
+            .arg = event_arg,
+            .payload = NULL,
+            .producer = EVENT_PRODUCER_TIMER
+        };
+        if (event_bus_publish(&event, 0) != ESP_OK) {
+            ESP_LOGW(TAG, "定时器事件发布失败: %d", event_type);
+        }
+    }
+}
+
+static void timer_service_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "定时器服务任务已启动");
+
+    for (;;) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+
+        TickType_t now = xTaskGetTickCount();
+        while ((int32_t)(now - s_wheel_now) >= 0) {
+            prv_advance_one_tick();
+        }
+
+        // 逐个执行到期回调，执行期间释放锁，回调中可以启动/取消任意定时器
+        while (s_expired) {
+            timer_service_timer_t *timer = s_expired;
+            prv_list_del(timer);
+            if (timer->period) {
+                timer->expires += timer->period;
+                prv_insert(timer);
+            }
+            timer_service_cb_t callback = timer->callback;
+            void *arg = timer->arg;
+            EventType_t event_type = timer->event_type;
+            uint32_t event_arg = timer->event_arg;
+
+            xSemaphoreGive(s_lock);
+            prv_dispatch(timer, callback, arg, event_type, event_arg);
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+        }
+
+        TickType_t next = prv_ticks_to_next_event();
+        TickType_t wait = portMAX_DELAY;
+        s_wait_forever = (next == portMAX_DELAY);
+        if (!s_wait_forever) {
+            s_wait_until = s_wheel_now + next;
+            int32_t remaining = (int32_t)(s_wait_until - xTaskGetTickCount());
+            wait = remaining > 0 ? (TickType_t)remaining : 0;
+        }
+        xSemaphoreGive(s_lock);
+
+        // 只在下一个到期时间醒来，期间有更早的定时器启动时会被通知唤醒
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+esp_err_t timer_service_init(void)
+{
+    if (s_task_handle != NULL) {
+        return ESP_OK;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        ESP_LOGE(TAG, "创建互斥锁失败!");
+        return ESP_ERR_NO_MEM;
+    }
+    s_wheel_now = xTaskGetTickCount();
+
+    if (xTaskCreate(timer_service_task, "timer_service", TIMER_SERVICE_TASK_STACK_SIZE,
+                    NULL, TIMER_SERVICE_TASK_PRIORITY, &s_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "创建定时器服务任务失败!");
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+        s_task_handle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void timer_service_timer_init(timer_service_timer_t *timer, timer_service_cb_t callback, void *arg)
+{
+    memset(timer, 0, sizeof(*timer));
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->event_type = EVENT_NONE;
+}
+
+void timer_service_timer_init_event(timer_service_timer_t *timer, EventType_t event_type, uint32_t event_arg)
+{
+    memset(timer, 0, sizeof(*timer));
+    timer->event_type = event_type;
+    timer->event_arg = event_arg;
+}
+
+static inline TickType_t prv_ms_to_ticks_ceil(uint32_t ms)
+{
+    return (TickType_t)((ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+}
+
+esp_err_t timer_service_start(timer_service_timer_t *timer, uint32_t delay_ms, uint32_t period_ms)
+{
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    TickType_t delay = prv_ms_to_ticks_ceil(delay_ms);
+    TickType_t period = prv_ms_to_ticks_ceil(period_ms);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (timer->head) {
+        prv_list_del(timer);
+    }
+    TickType_t now = xTaskGetTickCount();
+    // 空闲期间服务任务不推进 s_wheel_now，时间轮为空时直接对齐到当前 tick，
+    // 避免按过时的基准插入，以及服务任务醒来后逐 tick 追赶整个空闲期
+    if (prv_wheel_empty() && (int32_t)(now - s_wheel_now) > 0) {
+        s_wheel_now = now;
+    }
+    timer->period = period;
+    timer->expires = now + (delay ? delay : 1);
+    prv_insert(timer);
+    // 比服务任务当前的唤醒时间更早，需要提前唤醒它重新计算休眠时间
+    bool wake = s_wait_forever || (int32_t)(timer->expires - s_wait_until) < 0;
+    xSemaphoreGive(s_lock);
+
+    if (wake) {
+        xTaskNotifyGive(s_task_handle);
+    }
+    return ESP_OK;
+}
+
+bool timer_service_cancel(timer_service_timer_t *timer)
+{
+    if (s_lock == NULL) {
+        return false;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool was_active = timer->head != NULL;
+    if (was_active) {
+        prv_list_del(timer);
+    }
+    // 取消后周期定时器也不再重新启动
+    timer->period = 0;
+    xSemaphoreGive(s_lock);
+    return was_active;
+}
+
+bool timer_service_is_active(const timer_service_timer_t *timer)
+{
+    return timer->head != NULL;
+}
+
+TickType_t timer_service_get_next_deadline(void)
+{
+    if (s_lock == NULL) {
+        return portMAX_DELAY;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    TickType_t next = prv_ticks_to_next_event();
+    TickType_t result = portMAX_DELAY;
+    if (next != portMAX_DELAY) {
+        int32_t remaining = (int32_t)(s_wheel_now + next - xTaskGetTickCount());
+        result = remaining > 0 ? (TickType_t)remaining : 0;
+    }
+    xSemaphoreGive(s_lock);
+    return result;
+}
@@ -0,0 +1,93 @@
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "event_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 共享定时器服务: 分层时间轮 + 一个服务任务。
+ *
+ * - 定时器对象由调用方持有 (通常是静态变量)，内部用侵入式双向链表挂在时间轮上，
+ *   启动和取消都是 O(1)，不分配内存。
+ * - 分辨率为一个 FreeRTOS tick，到期的回调在服务任务中依次执行，回调里可以再次启动/取消定时器。
+ * - 定时器也可以不设回调，到期时向事件总线发布一个事件。
+ * - 服务任务只在下一个到期时间醒来，空闲时无限期阻塞，不做周期轮询，
+ *   timer_service_get_next_deadline() 可用于低功耗决策。
+ */
+
+struct timer_service_timer;
+typedef void (*timer_service_cb_t)(struct timer_service_timer *timer, void *arg);
+
+/**
+ * @brief 定时器对象，字段由本服务内部维护，调用方不要直接修改
+ */
+typedef struct timer_service_timer {
+    struct timer_service_timer *next;
+    struct timer_service_timer *prev;
+    struct timer_service_timer **head;   // 当前所在链表的头指针，NULL 表示未启动
+    TickType_t          expires;
+    TickType_t          period;          // 0 表示单次定时器
+    timer_service_cb_t  callback;
+    void               *arg;
+    EventType_t         event_type;      // callback 为 NULL 时到期发布的事件
+    uint32_t            event_arg;
+} timer_service_timer_t;
+
+/**
+ * @brief 初始化定时器服务并启动服务任务 (重复调用安全)
+ */
+esp_err_t timer_service_init(void);
+
+/**
+ * @brief 初始化一个回调型定时器，回调在服务任务中执行，不可长时间阻塞
+ */
+void timer_service_timer_init(timer_service_timer_t *timer, timer_service_cb_t callback, void *arg);
+
+/**
+ * @brief 初始化一个事件型定时器，到期时发布 { event_type, event_arg } 到事件总线
+ */
+void timer_service_timer_init_event(timer_service_timer_t *timer, EventType_t event_type, uint32_t event_arg);
+
+/**
+ * @brief 启动 (或重新启动) 定时器
+ *
+ * 对已启动的定时器调用会先取消再按新的时间启动。
+ *
+ * @param delay_ms  首次到期的延时，向上取整到 tick
+ * @param period_ms 周期，0 表示单次
+ *
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 服务未初始化
+ */
+esp_err_t timer_service_start(timer_service_timer_t *timer, uint32_t delay_ms, uint32_t period_ms);
+
+/**
+ * @brief 取消定时器
+ *
+ * @return true 定时器原本在运行并已取消, false 定时器未启动
+ */
+bool timer_service_cancel(timer_service_timer_t *timer);
+
+/**
+ * @brief 定时器是否在运行 (已启动且尚未到期/取消)
+ */
+bool timer_service_is_active(const timer_service_timer_t *timer);
+
+/**
+ * @brief 获取距离最近一个定时器到期的 tick 数
+ *
+ * @return tick 数，没有运行中的定时器时返回 portMAX_DELAY
+ */
+TickType_t timer_service_get_next_deadline(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMER_SERVICE_H
@@ -9,32 +9,76 @@
 #include "app_logic.h"
 #include "storage_manager.h"
 #include "feature_4g_ml307.h"  // ******* 新增4G模块头文件 *******
+#include "boot_trace.h"
+#include "init_graph.h"
+#include "timer_service.h"
 
 #define TAG "MAIN_APP"
+#define BOOT_INIT_TIMEOUT_MS (10000)
 
-void app_main(void)
+// 启动图节点下标，用于声明依赖关系
+enum {
+    INIT_NODE_EVENT_BUS = 0,
+    INIT_NODE_TIMER_SERVICE,
+    INIT_NODE_STORAGE,
+    INIT_NODE_NVS,
+    INIT_NODE_BUTTON,
+    INIT_NODE_MOTOR,
+    INIT_NODE_ANIM_PLAYER,
+    INIT_NODE_4G,
+    INIT_NODE_COUNT,
+};
+
+static esp_err_t prv_init_event_bus(void)
 {
-    ESP_ERROR_CHECK(storage_init()); 
-    ESP_ERROR_CHECK(bsp_button_init()); 
-    ESP_ERROR_CHECK(mada_initialize()); 
-    ESP_ERROR_CHECK(anim_player_init());
-    feature_4g_init();
+    event_bus_init();
+    return ESP_OK;
+}
 
-    // 2. 初始化消息队列
-    event_queue_init();
+static esp_err_t prv_init_4g(void)
+{
+    // 非阻塞：模组检测和注网在4G任务中后台完成
+    return feature_4g_init() == pdPASS ? ESP_OK : ESP_FAIL;
+}
 
-    
+// 没有依赖关系的节点会在两个核上并行执行，
+// 启动耗时取决于最长的依赖链 (通常是LCD初始化或FATFS挂载)
+static const init_graph_node_t s_boot_graph[INIT_NODE_COUNT] = {
+    // 4G模块通过事件总线异步上报网络状态，需要先初始化总线
+    [INIT_NODE_EVENT_BUS]     = { "event_bus",     prv_init_event_bus,   0 },
+    // 定时器服务到期时可以向事件总线发布事件
+    [INIT_NODE_TIMER_SERVICE] = { "timer_service", timer_service_init,   INIT_GRAPH_DEP(INIT_NODE_EVENT_BUS) },
+    [INIT_NODE_STORAGE]       = { "storage",       storage_init,         0 },
+    [INIT_NODE_NVS]           = { "nvs",           storage_nvs_init,     0 },
+    [INIT_NODE_BUTTON]        = { "button",        bsp_button_init,      0 },
+    [INIT_NODE_MOTOR]         = { "motor",         mada_initialize,      INIT_GRAPH_DEP(INIT_NODE_TIMER_SERVICE) },
+    [INIT_NODE_ANIM_PLAYER]   = { "anim_player",   anim_player_init,     0 },
+    // 4G任务启动时会从 NVS 读取上次协商的波特率
+    [INIT_NODE_4G]            = { "4g_init",       prv_init_4g,          INIT_GRAPH_DEP(INIT_NODE_EVENT_BUS) | INIT_GRAPH_DEP(INIT_NODE_NVS) },
+};
+
+void app_main(void)
+{
+    boot_trace_mark("app_main");
+
+    // 1. 并行初始化所有组件，任何一个失败都视为致命错误 (与原先的 ESP_ERROR_CHECK 行为一致)
+    ESP_ERROR_CHECK(init_graph_run(s_boot_graph, INIT_NODE_COUNT, pdMS_TO_TICKS(BOOT_INIT_TIMEOUT_MS), NULL));
+    boot_trace_mark("init_graph");
 
     // 消费者先启动
     app_logic_task_start();
     
-    // 3. 初始化并启动所有功能/服务任务
+    // 2. 先启动显示和按键，保证上电后立即可交互
+    anim_player_task_start();
+    button_scan_task_start();
+
+    // 3. 启动4G任务，模组在后台启动
     if (feature_4g_task_start() != pdPASS) {
         ESP_LOGE("MAIN", "启动4G模块失败，系统可能无法正常工作！");
     }
-    anim_player_task_start();
-    button_scan_task_start();
-    
 
+    boot_trace_mark("tasks_started");
     ESP_LOGI(TAG, "所有任务已启动，系统运行中...");
+    // 模组检测/注网完成后由4G任务追加记录并再次输出
+    boot_trace_dump();
 }
\ No newline at end of file
@@ -0,0 +1,300 @@
+// boot_trace 的主机测试，同时是串口日志的解析工具:
+//   test_boot_trace                                 自测: 记录阶段 -> 输出汇总 -> 解析并校验
+//   test_boot_trace <log> [<阶段>=<ms> ...]          解析设备日志中的 BOOT_TRACE 汇总，
+//                                                   按给定的阶段耗时预算检查，超出时返回非 0
+// 预算中的阶段名 total 表示总耗时。
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "boot_trace.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define MAX_PARSED_STAGES 64
+
+typedef struct {
+    uint32_t index;
+    char     name[BOOT_TRACE_NAME_LEN];
+    int64_t  timestamp_us;
+    int64_t  delta_us;
+} parsed_stage_t;
+
+typedef struct {
+    uint32_t       count;
+    parsed_stage_t stages[MAX_PARSED_STAGES];
+    int            has_total;
+    uint32_t       total_count;
+    int64_t        total_us;
+    uint32_t       dropped;
+} parsed_trace_t;
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// 一份日志可能包含多次汇总 (启动时一次，4G 就绪后再一次)，以最后一次为准
+static void prv_parse(const char *log, parsed_trace_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    const char *line = log;
+    while (line && *line) {
+        const char *end = strchr(line, '\n');
+        size_t length = end ? (size_t)(end - line) : strlen(line);
+        char buffer[256];
+        if (length >= sizeof(buffer)) {
+            length = sizeof(buffer) - 1;
+        }
+        memcpy(buffer, line, length);
+        buffer[length] = '\0';
+
+        const char *total = strstr(buffer, "BOOT_TRACE_TOTAL,");
+        const char *stage = strstr(buffer, "BOOT_TRACE,");
+        if (total) {
+            unsigned long count, dropped;
+            long long total_us;
+            if (sscanf(total, "BOOT_TRACE_TOTAL,%lu,%lld,%lu", &count, &total_us, &dropped) == 3) {
+                out->has_total = 1;
+                out->total_count = count;
+                out->total_us = total_us;
+                out->dropped = dropped;
+            }
+        } else if (stage) {
+            unsigned long index;
+            char name[BOOT_TRACE_NAME_LEN];
+            long long timestamp_us, delta_us;
+            if (sscanf(stage, "BOOT_TRACE,%lu,%23[^,],%lld,%lld", &index, name, &timestamp_us, &delta_us) == 4) {
+                // 新一轮汇总从头开始
+                if (out->has_total) {
+                    memset(out, 0, sizeof(*out));
+                }
+                if (out->count < MAX_PARSED_STAGES) {
+                    parsed_stage_t *parsed = &out->stages[out->count++];
+                    parsed->index = index;
+                    strcpy(parsed->name, name);
+                    parsed->timestamp_us = timestamp_us;
+                    parsed->delta_us = delta_us;
+                }
+            }
+        }
+        line = end ? end + 1 : NULL;
+    }
+}
+
+// 检查汇总自身的一致性，返回发现的问题数
+static int prv_validate(const parsed_trace_t *trace)
+{
+    int errors = 0;
+    if (!trace->has_total) {
+        printf("missing BOOT_TRACE_TOTAL line\n");
+        return 1;
+    }
+    if (trace->total_count != trace->count) {
+        printf("stage count %" PRIu32 " != total line count %" PRIu32 "\n", trace->count, trace->total_count);
+        errors++;
+    }
+    for (uint32_t i = 0; i < trace->count; i++) {
+        const parsed_stage_t *stage = &trace->stages[i];
+        if (stage->index != trace->dropped + i) {
+            printf("stage %s: index %" PRIu32 ", expected %" PRIu32 "\n", stage->name, stage->index, trace->dropped + i);
+            errors++;
+        }
+        if (i > 0) {
+            const parsed_stage_t *prev = &trace->stages[i - 1];
+            if (stage->timestamp_us < prev->timestamp_us || stage->delta_us != stage->timestamp_us - prev->timestamp_us) {
+                printf("stage %s: timestamp/delta inconsistent with %s\n", stage->name, prev->name);
+                errors++;
+            }
+        }
+    }
+    if (trace->count > 0 && trace->total_us != trace->stages[trace->count - 1].timestamp_us) {
+        printf("total %lld != last timestamp\n", (long long)trace->total_us);
+        errors++;
+    }
+    return errors;
+}
+
+// budgets 为 "<阶段>=<ms>" 形式，同名阶段出现多次时逐一检查，返回超出预算的数目
+static int prv_check_budgets(const parsed_trace_t *trace, const char *const *budgets, int budget_count)
+{
+    int violations = 0;
+    for (int i = 0; i < budget_count; i++) {
+        const char *eq = strchr(budgets[i], '=');
+        if (!eq) {
+            printf("bad budget '%s', expected <stage>=<ms>\n", budgets[i]);
+            violations++;
+            continue;
+        }
+        size_t name_len = (size_t)(eq - budgets[i]);
+        int64_t limit_us = (int64_t)(atof(eq + 1) * 1000);
+        int found = 0;
+        if (name_len == 5 && strncmp(budgets[i], "total", 5) == 0) {
+            found = 1;
+            if (trace->total_us > limit_us) {
+                printf("REGRESSION total: %lld us > %lld us\n", (long long)trace->total_us, (long long)limit_us);
+                violations++;
+            }
+        }
+        for (uint32_t j = 0; j < trace->count; j++) {
+            const parsed_stage_t *stage = &trace->stages[j];
+            if (strlen(stage->name) != name_len || strncmp(stage->name, budgets[i], name_len) != 0) {
+                continue;
+            }
+            found = 1;
+            if (stage->delta_us > limit_us) {
+                printf("REGRESSION %s: %lld us > %lld us\n", stage->name, (long long)stage->delta_us, (long long)limit_us);
+                violations++;
+            }
+        }
+        if (!found) {
+            printf("stage '%.*s' not found in trace\n", (int)name_len, budgets[i]);
+            violations++;
+        }
+    }
+    return violations;
+}
+
+static void prv_dump_and_parse(char *log, size_t size, parsed_trace_t *out)
+{
+    host_log_capture(log, size);
+    boot_trace_dump();
+    host_log_capture(NULL, 0);
+    prv_parse(log, out);
+}
+
+static void test_summary_round_trip(void)
+{
+    static char log[16 * 1024];
+    static boot_trace_summary_t summary;
+    parsed_trace_t trace;
+
+    host_clock_set_manual(0);
+    host_clock_advance_us(120000);
+    boot_trace_mark("storage");
+    host_clock_advance_us(5000);
+    boot_trace_mark("button");
+    host_clock_advance_us(3000);
+    boot_trace_mark("motor");
+    host_clock_advance_us(250000);
+    boot_trace_mark("anim");
+
+    boot_trace_get_summary(&summary);
+    CHECK(summary.count == 4);
+    CHECK(summary.dropped == 0);
+    CHECK(summary.total_us == 378000);
+    CHECK(strcmp(summary.stages[3].name, "anim") == 0);
+    CHECK(summary.stages[3].delta_us == 250000);
+
+    prv_dump_and_parse(log, sizeof(log), &trace);
+    CHECK(prv_validate(&trace) == 0);
+    CHECK(trace.count == summary.count);
+    CHECK(trace.total_us == summary.total_us);
+    for (uint32_t i = 0; i < trace.count && i < summary.count; i++) {
+        CHECK(strcmp(trace.stages[i].name, summary.stages[i].name) == 0);
+        CHECK(trace.stages[i].timestamp_us == summary.stages[i].timestamp_us);
+        CHECK(trace.stages[i].delta_us == summary.stages[i].delta_us);
+    }
+
+    // 预算内通过，某阶段变慢时能被发现
+    const char *pass[] = {"storage=150", "anim=300", "total=400"};
+    const char *fail[] = {"anim=200", "total=350"};
+    const char *missing[] = {"modem_ready=1000"};
+    CHECK(prv_check_budgets(&trace, pass, 3) == 0);
+    CHECK(prv_check_budgets(&trace, fail, 2) == 2);
+    CHECK(prv_check_budgets(&trace, missing, 1) == 1);
+}
+
+static void test_long_name_truncated(void)
+{
+    static boot_trace_summary_t summary;
+    host_clock_advance_us(1000);
+    boot_trace_mark("a_stage_name_longer_than_the_buffer");
+    boot_trace_get_summary(&summary);
+    CHECK(strlen(summary.stages[summary.count - 1].name) == BOOT_TRACE_NAME_LEN - 1);
+}
+
+static void test_ring_wraps(void)
+{
+    static char log[16 * 1024];
+    static boot_trace_summary_t summary;
+    parsed_trace_t trace;
+    char name[16];
+
+    for (int i = 0; i < BOOT_TRACE_MAX_STAGES + 6; i++) {
+        host_clock_advance_us(1000 + i);
+        snprintf(name, sizeof(name), "stage_%d", i);
+        boot_trace_mark(name);
+    }
+    boot_trace_get_summary(&summary);
+    CHECK(summary.count == BOOT_TRACE_MAX_STAGES);
+    CHECK(summary.dropped > 0);
+    CHECK(strcmp(summary.stages[BOOT_TRACE_MAX_STAGES - 1].name, "stage_29") == 0);
+
+    prv_dump_and_parse(log, sizeof(log), &trace);
+    CHECK(prv_validate(&trace) == 0);
+    CHECK(trace.dropped == summary.dropped);
+    CHECK(trace.stages[0].index == summary.dropped);
+
+    // 截断或重复的日志要能被发现
+    char *last_line = strstr(log, "stage_29");
+    CHECK(last_line != NULL);
+    if (last_line) {
+        char *line_start = last_line;
+        while (line_start > log && line_start[-1] != '\n') {
+            line_start--;
+        }
+        *line_start = '\0';
+        prv_parse(log, &trace);
+        CHECK(prv_validate(&trace) != 0);
+    }
+}
+
+static int prv_check_log_file(const char *path, const char *const *budgets, int budget_count)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        printf("cannot open %s\n", path);
+        return 2;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *log = malloc((size_t)size + 1);
+    size_t read = fread(log, 1, (size_t)size, file);
+    log[read] = '\0';
+    fclose(file);
+
+    static parsed_trace_t trace;
+    prv_parse(log, &trace);
+    free(log);
+
+    for (uint32_t i = 0; i < trace.count; i++) {
+        printf("%-24s %10.1f ms  (+%.1f ms)\n", trace.stages[i].name,
+               trace.stages[i].timestamp_us / 1000.0, trace.stages[i].delta_us / 1000.0);
+    }
+    int errors = prv_validate(&trace);
+    errors += prv_check_budgets(&trace, budgets, budget_count);
+    printf("%s\n", errors ? "BOOT TRACE CHECK FAILED" : "BOOT TRACE OK");
+    return errors ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        return prv_check_log_file(argv[1], (const char *const *)&argv[2], argc - 2);
+    }
+
+    host_log_set_quiet(1);
+    test_summary_round_trip();
+    test_long_name_truncated();
+    test_ring_wraps();
+    host_log_set_quiet(0);
+
+    printf("%s (%d failures)\n", s_failures ? "FAILED" : "OK", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+// 事件总线合并策略的主机测试: COUNTED_MERGE 保留 arg 中的按键ID，次数放在 count 中，
+// 不同按键的事件不会被合并到一起
+#include <stdio.h>
+#include <string.h>
+#include "event_manager.h"
+#include "esp_log.h"
+
+// 与 feature_button.h 的编码一致
+#define BUTTON_EVENT_ARG(id, count)  ((uint32_t)(id) | ((uint32_t)(count) << 8))
+#define BUTTON_EVENT_ID(arg)         ((uint8_t)((arg) & 0xFF))
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static void prv_press(uint8_t id)
+{
+    AppEvent_t event = {
+        .event_type = EVENT_BUTTON_SHORT_PRESS,
+        .arg = BUTTON_EVENT_ARG(id, 1),
+        .producer = EVENT_PRODUCER_BUTTON,
+    };
+    CHECK(event_bus_publish(&event, 0) == ESP_OK);
+}
+
+static void test_counted_merge_keeps_id(event_subscriber_t merged, event_subscriber_t plain)
+{
+    AppEvent_t event;
+
+    // 按键0连按三次，中间按一次按键1，再按一次按键0
+    prv_press(0);
+    prv_press(0);
+    prv_press(1);
+    prv_press(0);
+    prv_press(0);
+
+    // 合并订阅者: 按键0的四次合并成一个事件，按键1单独一个事件
+    CHECK(event_bus_receive(merged, &event, 0) == pdPASS);
+    CHECK(event.event_type == EVENT_BUTTON_SHORT_PRESS);
+    CHECK(BUTTON_EVENT_ID(event.arg) == 0);
+    CHECK(event.arg == BUTTON_EVENT_ARG(0, 1));
+    CHECK(event.count == 4);
+    CHECK(event_bus_receive(merged, &event, 0) == pdPASS);
+    CHECK(BUTTON_EVENT_ID(event.arg) == 1);
+    CHECK(event.count == 1);
+    CHECK(event_bus_receive(merged, &event, 0) == pdFAIL);
+
+    // 默认策略的订阅者不受影响，每个事件的 count 都是1
+    for (int i = 0; i < 5; i++) {
+        CHECK(event_bus_receive(plain, &event, 0) == pdPASS);
+        CHECK(event.count == 1);
+        CHECK(BUTTON_EVENT_ID(event.arg) == (i == 2 ? 1 : 0));
+    }
+    CHECK(event_bus_receive(plain, &event, 0) == pdFAIL);
+
+    event_bus_stats_t stats;
+    event_bus_get_stats(merged, &stats);
+    CHECK(stats.merged == 3);
+    CHECK(stats.dropped == 0);
+
+    // 取出后重新开始计数
+    prv_press(1);
+    CHECK(event_bus_receive(merged, &event, 0) == pdPASS);
+    CHECK(BUTTON_EVENT_ID(event.arg) == 1);
+    CHECK(event.count == 1);
+    CHECK(event_bus_receive(plain, &event, 0) == pdPASS);
+}
+
+static void test_latest_wins_count(event_subscriber_t subscriber)
+{
+    AppEvent_t event = { .event_type = EVENT_BUTTON_HOLD_REPEAT };
+    for (uint32_t i = 1; i <= 3; i++) {
+        event.arg = i;
+        CHECK(event_bus_publish(&event, 0) == ESP_OK);
+    }
+    CHECK(event_bus_receive(subscriber, &event, 0) == pdPASS);
+    CHECK(event.arg == 3);
+    CHECK(event.count == 1);
+    CHECK(event_bus_receive(subscriber, &event, 0) == pdFAIL);
+}
+
+int main(void)
+{
+    host_log_set_quiet(1);
+    event_bus_init();
+
+    const event_bus_policy_t counted = { .coalesce = EVENT_COALESCE_COUNTED_MERGE };
+    const event_bus_policy_t latest = { .coalesce = EVENT_COALESCE_LATEST_WINS };
+    event_subscriber_t merged = event_bus_subscriber_create("merged", 8);
+    event_subscriber_t plain = event_bus_subscriber_create("plain", 8);
+    CHECK(event_bus_subscribe_with_policy(merged, EVENT_BUTTON_SHORT_PRESS, &counted) == ESP_OK);
+    CHECK(event_bus_subscribe_with_policy(merged, EVENT_BUTTON_HOLD_REPEAT, &latest) == ESP_OK);
+    CHECK(event_bus_subscribe(plain, EVENT_BUTTON_SHORT_PRESS) == ESP_OK);
+
+    test_counted_merge_keeps_id(merged, plain);
+    test_latest_wins_count(merged);
+    host_log_set_quiet(0);
+
+    printf("%s (%d failures)\n", s_failures ? "FAILED" : "OK", s_failures);
+    return s_failures ? 1 : 0;
+}
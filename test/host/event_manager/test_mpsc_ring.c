@@ -0,0 +1,157 @@
+// mpsc_ring 的并发压力测试: 多个生产者线程同时写入，单个消费者批量取出，
+// 检查每个生产者的序号连续、不丢不重，并覆盖写满失败与回绕
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "mpsc_ring.h"
+
+#define PRODUCERS 4
+
+typedef struct {
+    uint32_t producer;
+    uint32_t seq;
+    uint32_t check;     // 由前两项算出，检查元素是否被撕裂
+} item_t;
+
+typedef struct {
+    mpsc_ring_t *ring;
+    uint32_t     producer;
+    uint32_t     count;
+    uint32_t     full_retries;
+} producer_arg_t;
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static uint32_t prv_check_value(uint32_t producer, uint32_t seq)
+{
+    return (producer * 0x9E3779B1u) ^ (seq * 0x85EBCA77u);
+}
+
+static void *prv_producer(void *arg)
+{
+    producer_arg_t *p = (producer_arg_t *)arg;
+    for (uint32_t seq = 0; seq < p->count; seq++) {
+        item_t item = {p->producer, seq, prv_check_value(p->producer, seq)};
+        while (!mpsc_ring_push(p->ring, &item)) {
+            // 写满时让出 CPU 等消费者取走
+            p->full_retries++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// capacity 越小，写满与回绕越频繁
+static void prv_stress(uint32_t capacity, uint32_t per_producer, size_t batch)
+{
+    size_t storage_size = MPSC_RING_STORAGE_SIZE(capacity, sizeof(item_t));
+    void *storage = aligned_alloc(4, (storage_size + 3) & ~(size_t)3);
+    mpsc_ring_t ring;
+    CHECK(mpsc_ring_init(&ring, storage, storage_size, capacity, sizeof(item_t)) == ESP_OK);
+
+    pthread_t threads[PRODUCERS];
+    producer_arg_t args[PRODUCERS];
+    for (uint32_t i = 0; i < PRODUCERS; i++) {
+        args[i] = (producer_arg_t){&ring, i, per_producer, 0};
+        pthread_create(&threads[i], NULL, prv_producer, &args[i]);
+    }
+
+    uint32_t next_seq[PRODUCERS] = {0};
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    item_t *items = malloc(batch * sizeof(item_t));
+    while (received < PRODUCERS * per_producer && errors == 0) {
+        size_t count = mpsc_ring_pop_batch(&ring, items, batch);
+        if (count == 0) {
+            sched_yield();
+            continue;
+        }
+        for (size_t i = 0; i < count; i++) {
+            const item_t *item = &items[i];
+            if (item->producer >= PRODUCERS || item->check != prv_check_value(item->producer, item->seq) ||
+                item->seq != next_seq[item->producer]) {
+                printf("bad item: producer %u seq %u (expected %u)\n", item->producer, item->seq,
+                       item->producer < PRODUCERS ? next_seq[item->producer] : 0);
+                errors++;
+                break;
+            }
+            next_seq[item->producer]++;
+        }
+        received += (uint32_t)count;
+    }
+
+    uint32_t retries = 0;
+    for (uint32_t i = 0; i < PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+        retries += args[i].full_retries;
+        CHECK(next_seq[i] == per_producer);
+    }
+    CHECK(errors == 0);
+    CHECK(received == PRODUCERS * per_producer);
+    CHECK(mpsc_ring_pop(&ring, items) == false);
+    CHECK(mpsc_ring_count_approx(&ring) == 0);
+    // 写满时的失败都应被计数
+    CHECK(ring.push_failed == retries);
+    printf("capacity %4u batch %3zu: %u items, %u full retries\n", capacity, batch, received, retries);
+
+    free(items);
+    free(storage);
+}
+
+static void test_init_rejects_bad_args(void)
+{
+    static uint32_t storage[64];
+    mpsc_ring_t ring;
+    CHECK(mpsc_ring_init(&ring, storage, sizeof(storage), 6, 4) == ESP_ERR_INVALID_ARG);     // 非2的幂
+    CHECK(mpsc_ring_init(&ring, storage, sizeof(storage), 64, 4) == ESP_ERR_INVALID_ARG);    // 存储区不足
+    CHECK(mpsc_ring_init(&ring, (uint8_t *)storage + 1, sizeof(storage) - 4, 4, 4) == ESP_ERR_INVALID_ARG); // 未对齐
+    CHECK(mpsc_ring_init(&ring, storage, sizeof(storage), 32, 0) == ESP_ERR_INVALID_ARG);
+    CHECK(mpsc_ring_init(&ring, storage, sizeof(storage), 32, 4) == ESP_OK);
+}
+
+static void test_single_thread_full_and_order(void)
+{
+    static uint32_t storage[MPSC_RING_STORAGE_SIZE(8, 4) / 4];
+    mpsc_ring_t ring;
+    CHECK(mpsc_ring_init(&ring, storage, sizeof(storage), 8, 4) == ESP_OK);
+
+    // 多圈写满再取空，验证序号在回绕后仍正确
+    for (uint32_t round = 0; round < 3; round++) {
+        for (uint32_t i = 0; i < 8; i++) {
+            uint32_t value = round * 100 + i;
+            CHECK(mpsc_ring_push(&ring, &value));
+        }
+        uint32_t extra = 0;
+        CHECK(!mpsc_ring_push(&ring, &extra));
+        CHECK(mpsc_ring_count_approx(&ring) == 8);
+
+        uint32_t out[8];
+        CHECK(mpsc_ring_pop_batch(&ring, out, 3) == 3);
+        CHECK(mpsc_ring_pop_batch(&ring, out + 3, 8) == 5);
+        for (uint32_t i = 0; i < 8; i++) {
+            CHECK(out[i] == round * 100 + i);
+        }
+    }
+    CHECK(ring.push_failed == 3);
+}
+
+int main(void)
+{
+    test_init_rejects_bad_args();
+    test_single_thread_full_and_order();
+    prv_stress(4, 200000, 1);
+    prv_stress(64, 500000, 16);
+    prv_stress(1024, 500000, 256);
+
+    printf("%s (%d failures)\n", s_failures ? "FAILED" : "OK", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,261 @@
+// AtUart 接收分帧的基准: 把记录下的模组流量回放给 AtUart，只测切行、解析参数、按长度切二进制 URC 与分发的开销。
+//   bench_at_framing [<记录文件.atr> ...]
+// 不带参数时先用模组模拟器录两段: ML307 (原始数据的 +MIPURC 二进制帧) 与 EC801E (十六进制的 +QIURC 长行)，
+// 各含启动、注网和一次 TCP 回环。也可以传入设备上用 AtUart::SetTranscript() 录下的文件。
+// 回放时只保留 RX 记录 (不需要驱动按原样发出命令)，以不等待的速度交给 AtUart，
+// 每次读取按 UART 驱动的典型分块限制长度，比较不同分块下每字节的耗时: 分帧的代价应与分块无关。
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "at_modem.h"
+#include "at_modem_simulator.h"
+#include "at_transcript.h"
+#include "local_servers.h"
+#include "esp_log.h"
+
+#define BENCH_ECHO_SIZE     (64 * 1024)
+#define BENCH_ROUNDS        (3)         // 每种分块回放的次数，取最快一次
+#define BENCH_LINK_IDS      (6)         // 回放时按长度切帧的 +MIPURC 连接号 0..5
+#define BENCH_END_URC       "BENCHEND"  // 追加在记录末尾，收到即回放完毕
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_failures++; \
+        } \
+    } while (0)
+
+typedef std::chrono::steady_clock Clock;
+
+struct Transcript {
+    std::string name;
+    std::vector<AtTranscriptRecord> records;    // 只含 RX
+    size_t rx_bytes = 0;
+    size_t urc_count = 0;                       // 录制时分发的 URC 数，外部文件为 0 (不核对)
+};
+
+// 每次 Read 最多交出 chunk 字节，Available 仍报告全部，AtUart 会在一次唤醒中逐块读取、逐块解析
+class ChunkedTransport : public AtTransport {
+public:
+    ChunkedTransport(std::unique_ptr<AtTransport> inner, size_t chunk) : inner_(std::move(inner)), chunk_(chunk) {}
+
+    bool Open(int baud_rate, size_t rx_buffer_size, size_t tx_buffer_size, AtTransportEventCallback callback) override {
+        return inner_->Open(baud_rate, rx_buffer_size, tx_buffer_size, std::move(callback));
+    }
+    size_t Available() override { return inner_->Available(); }
+    int Read(char* buffer, size_t length) override { return inner_->Read(buffer, std::min(length, chunk_)); }
+    int Write(const char* data, size_t length) override { return inner_->Write(data, length); }
+    void SetBaudRate(int baud_rate) override {}
+
+private:
+    std::unique_ptr<AtTransport> inner_;
+    size_t chunk_;
+};
+
+struct UrcCounter {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t count = 0;
+    bool finished = false;
+
+    void Attach(AtUart& uart) {
+        uart.RegisterUrcCallback([this](std::string_view command, const AtArguments& arguments) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (command == BENCH_END_URC) {
+                finished = true;
+                cv.notify_all();
+            } else {
+                count++;
+            }
+        });
+    }
+
+    bool WaitFinished(int timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] { return finished; });
+    }
+};
+
+static void KeepRx(Transcript& transcript, std::vector<AtTranscriptRecord>& records) {
+    for (auto& record : records) {
+        if (record.direction == AtTranscriptDirection::Rx) {
+            transcript.rx_bytes += record.data.size();
+            transcript.records.push_back(std::move(record));
+        }
+    }
+}
+
+static bool ReadRecords(FILE* file, std::vector<AtTranscriptRecord>& records) {
+    AtTranscriptReader reader;
+    if (!reader.Open(file)) {
+        return false;
+    }
+    AtTranscriptRecord record;
+    while (reader.Next(record)) {
+        records.push_back(record);
+    }
+    return true;
+}
+
+// 在模拟器上跑一遍 检测 -> 注网 -> TCP 回环，同时录下 AtUart 的收发
+static bool Record(Transcript& transcript, const char* revision, const LocalServer& echo) {
+    FILE* file = tmpfile();
+    if (!file) {
+        return false;
+    }
+    auto writer = std::make_shared<AtTranscriptWriter>(file);
+    AtModemSimulatorConfig config;
+    config.revision = revision;
+    auto uart = std::make_shared<AtUart>(std::make_unique<AtModemSimulator>(config));
+    // shim 无法从外部删除 AtUart 的接收任务，模组对象保留到进程退出
+    auto counter = new UrcCounter();
+    counter->Attach(*uart);
+    uart->SetTranscript(writer);
+    uart->Initialize();
+
+    bool ok = false;
+    AtModem* modem = AtModem::Detect(uart, 115200, 3000).release();
+    if (modem && modem->WaitForNetworkReady(3000) == NetworkStatus::Ready) {
+        modem->GetCsq();
+        auto tcp = modem->CreateTcp(0);
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t received = 0;
+        tcp->OnStream([&](const std::string& data) {
+            std::lock_guard<std::mutex> lock(mutex);
+            received += data.size();
+            cv.notify_all();
+        });
+        if (tcp->Connect("127.0.0.1", echo.port())) {
+            std::string chunk(1024, '\0');
+            for (size_t i = 0; i < chunk.size(); i++) {
+                chunk[i] = (char)(i * 7);
+            }
+            for (size_t sent = 0; sent < BENCH_ECHO_SIZE; sent += chunk.size()) {
+                tcp->Send(chunk);
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            ok = cv.wait_for(lock, std::chrono::seconds(30), [&] { return received >= BENCH_ECHO_SIZE; });
+        }
+        tcp->Disconnect();
+    }
+    uart->SetTranscript(nullptr);
+    writer->Flush();
+
+    std::vector<AtTranscriptRecord> records;
+    rewind(file);
+    ok = ok && ReadRecords(file, records);
+    fclose(file);
+    KeepRx(transcript, records);
+    std::lock_guard<std::mutex> lock(counter->mutex);
+    transcript.urc_count = counter->count;
+    return ok;
+}
+
+static bool Load(Transcript& transcript, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<AtTranscriptRecord> records;
+    bool ok = ReadRecords(file, records);
+    fclose(file);
+    KeepRx(transcript, records);
+    return ok;
+}
+
+// 回放一次，返回从打开传输到收到结束 URC 的耗时 (ms)，失败返回负数
+static double Replay(const Transcript& transcript, size_t chunk, size_t* urc_count, size_t* rx_overflow_count) {
+    auto records = transcript.records;
+    AtTranscriptRecord end;
+    end.direction = AtTranscriptDirection::Rx;
+    end.data = "\r\n+" BENCH_END_URC "\r\n";
+    records.push_back(std::move(end));
+
+    auto replay = std::make_unique<AtReplayTransport>(std::move(records), 0);
+    // 回放的 AtUart 同样无法删除
+    auto uart = new AtUart(std::make_unique<ChunkedTransport>(std::move(replay), chunk));
+    auto counter = new UrcCounter();
+    counter->Attach(*uart);
+    for (int link_id = 0; link_id < BENCH_LINK_IDS; link_id++) {
+        uart->SetBinaryUrc("MIPURC", 1, 2, link_id, true);
+    }
+
+    auto start = Clock::now();
+    uart->Initialize();
+    if (!counter->WaitFinished(30000)) {
+        return -1;
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(counter->mutex);
+    *urc_count = counter->count;
+    *rx_overflow_count = uart->GetRxOverflowCount();
+    return ms;
+}
+
+static void Bench(const Transcript& transcript) {
+    printf("%s: %zu RX records, %zu bytes\n", transcript.name.c_str(), transcript.records.size(), transcript.rx_bytes);
+    // 小块、ESP32 UART 的 FIFO 阈值量级、驱动环形缓冲区的一次读取
+    for (size_t chunk : {16, 120, 1024}) {
+        double best = -1;
+        size_t urc_count = 0, rx_overflow_count = 0;
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            double ms = Replay(transcript, chunk, &urc_count, &rx_overflow_count);
+            if (ms < 0) {
+                best = -1;
+                break;
+            }
+            best = best < 0 ? ms : std::min(best, ms);
+        }
+        CHECK(best >= 0);
+        CHECK(rx_overflow_count == 0);
+        if (transcript.urc_count > 0) {
+            // 分帧与录制时一致: 分发的 URC 数相同，二进制帧里的 \r\n 没有被当成行尾
+            CHECK(urc_count == transcript.urc_count);
+        }
+        if (best >= 0) {
+            printf("  read %4zu B  %8.2f ms  %7.1f MB/s  %6.1f ns/B  %6zu URCs\n", chunk, best,
+                   transcript.rx_bytes / best / 1000, best * 1e6 / transcript.rx_bytes, urc_count);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<Transcript> transcripts;
+    host_log_set_quiet(getenv("AT_MODEM_VERBOSE") == nullptr);
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            Transcript transcript;
+            transcript.name = argv[i];
+            CHECK(Load(transcript, argv[i]));
+            transcripts.push_back(std::move(transcript));
+        }
+    } else {
+        LocalServer echo(LocalServerKind::Echo);
+        Transcript ml307, ec801e;
+        ml307.name = "ML307 (binary MIPURC)";
+        ec801e.name = "EC801E (hex QIURC)";
+        CHECK(Record(ml307, "ML307R-DC_V1.0.0", echo));
+        CHECK(Record(ec801e, "EC801ECNLAR01A01M08", echo));
+        transcripts.push_back(std::move(ml307));
+        transcripts.push_back(std::move(ec801e));
+    }
+
+    for (auto& transcript : transcripts) {
+        Bench(transcript);
+    }
+    host_log_set_quiet(0);
+
+    printf("%s (%d failures)\n", s_failures ? "FAILED" : "OK", s_failures);
+    // 接收任务仍在运行，不执行静态析构
+    fflush(stdout);
+    _exit(s_failures ? 1 : 0);
+}
@@ -0,0 +1,2 @@
+// web_socket.cc 引用了此头文件但不调用其中的接口，主机上留空
+#pragma once
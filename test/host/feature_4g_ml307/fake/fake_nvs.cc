@@ -0,0 +1,77 @@
+#include "nvs.h"
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+// 每次 nvs_open 分配新句柄，记下它对应的命名空间
+static std::mutex s_mutex;
+static std::map<std::string, std::map<std::string, std::string>> s_namespaces;
+static std::map<nvs_handle_t, std::string> s_handles;
+static nvs_handle_t s_next_handle = 1;
+static int s_commit_count = 0;
+
+extern "C" esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (open_mode == NVS_READONLY && s_namespaces.find(name) == s_namespaces.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    s_namespaces[name];
+    *out_handle = s_next_handle++;
+    s_handles[*out_handle] = name;
+    return ESP_OK;
+}
+
+extern "C" void nvs_close(nvs_handle_t handle) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_handles.erase(handle);
+}
+
+extern "C" esp_err_t nvs_commit(nvs_handle_t handle) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_commit_count++;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto& values = s_namespaces[s_handles[handle]];
+    auto it = values.find(key);
+    if (it == values.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    size_t required = it->second.size() + 1;
+    if (out_value) {
+        if (*length < required) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memcpy(out_value, it->second.c_str(), required);
+    }
+    *length = required;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_namespaces[s_handles[handle]][key] = value;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto& values = s_namespaces[s_handles[handle]];
+    if (values.erase(key) == 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+extern "C" void fake_nvs_clear(void) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_namespaces.clear();
+}
+
+extern "C" int fake_nvs_commit_count(void) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_commit_count;
+}
@@ -0,0 +1,27 @@
+// 主机测试用的 NVS 替身: 内存中的键值表，只实现 at_modem.cc 用到的字符串接口
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+typedef uint32_t nvs_handle_t;
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle);
+void nvs_close(nvs_handle_t handle);
+esp_err_t nvs_commit(nvs_handle_t handle);
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length);
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value);
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key);
+
+// 清空所有命名空间，模拟擦除 flash
+void fake_nvs_clear(void);
+// nvs_commit 的调用次数，用于检查启动时是否写 flash
+int fake_nvs_commit_count(void);
+#ifdef __cplusplus
+}
+#endif
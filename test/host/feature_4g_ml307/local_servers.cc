@@ -0,0 +1,331 @@
+#include "local_servers.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+static bool ReadExact(int fd, void* buffer, size_t length) {
+    char* p = static_cast<char*>(buffer);
+    while (length > 0) {
+        ssize_t n = recv(fd, p, length, 0);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        length -= n;
+    }
+    return true;
+}
+
+static bool WriteAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t n = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        offset += n;
+    }
+    return true;
+}
+
+// 读到 "\r\n\r\n" 为止，多读的部分留在 rest 中
+static bool ReadHeader(int fd, std::string& header, std::string& rest) {
+    std::string data;
+    char buffer[1024];
+    size_t end;
+    while ((end = data.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return false;
+        }
+        data.append(buffer, n);
+    }
+    header = data.substr(0, end + 4);
+    rest = data.substr(end + 4);
+    return true;
+}
+
+// 不区分大小写查找请求头，找不到返回空串
+static std::string HeaderValue(const std::string& header, const char* key) {
+    size_t key_length = strlen(key);
+    size_t pos = 0;
+    while ((pos = header.find("\r\n", pos)) != std::string::npos) {
+        pos += 2;
+        if (strncasecmp(header.c_str() + pos, key, key_length) == 0 && header[pos + key_length] == ':') {
+            size_t begin = header.find_first_not_of(' ', pos + key_length + 1);
+            return header.substr(begin, header.find("\r\n", begin) - begin);
+        }
+    }
+    return "";
+}
+
+// 从 rest 和 socket 中补足 length 字节
+static bool TakeExact(int fd, std::string& rest, size_t length, std::string& out) {
+    size_t from_rest = std::min(length, rest.size());
+    out.append(rest, 0, from_rest);
+    rest.erase(0, from_rest);
+    size_t missing = length - from_rest;
+    if (missing == 0) {
+        return true;
+    }
+    size_t offset = out.size();
+    out.resize(offset + missing);
+    return ReadExact(fd, &out[offset], missing);
+}
+
+static bool TakeLine(int fd, std::string& rest, std::string& line) {
+    size_t end;
+    while ((end = rest.find("\r\n")) == std::string::npos) {
+        char buffer[256];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return false;
+        }
+        rest.append(buffer, n);
+    }
+    line = rest.substr(0, end);
+    rest.erase(0, end + 2);
+    return true;
+}
+
+LocalServer::LocalServer(LocalServerKind kind) : kind_(kind) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(listen_fd_, (sockaddr*)&address, sizeof(address)) != 0 || listen(listen_fd_, 8) != 0 ||
+        getsockname(listen_fd_, (sockaddr*)&address, &length) != 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return;
+    }
+    port_ = ntohs(address.sin_port);
+    thread_ = std::thread(&LocalServer::Accept, this);
+}
+
+LocalServer::~LocalServer() {
+    stopping_ = true;
+    if (listen_fd_ >= 0) {
+        shutdown(listen_fd_, SHUT_RDWR);
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int fd : client_fds_) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+    for (auto& client : clients_) {
+        client.join();
+    }
+    for (int fd : client_fds_) {
+        close(fd);
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+    }
+}
+
+void LocalServer::Accept() {
+    while (!stopping_) {
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            break;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::lock_guard<std::mutex> lock(mutex_);
+        client_fds_.push_back(fd);
+        clients_.emplace_back(&LocalServer::Serve, this, fd);
+    }
+}
+
+void LocalServer::Serve(int fd) {
+    switch (kind_) {
+        case LocalServerKind::Echo: ServeEcho(fd); break;
+        case LocalServerKind::Http: ServeHttp(fd); break;
+        case LocalServerKind::Mqtt: ServeMqtt(fd); break;
+        case LocalServerKind::WebSocket: ServeWebSocket(fd); break;
+    }
+    // 只关闭写方向，fd 在析构时才关闭，避免被复用后误 shutdown
+    shutdown(fd, SHUT_WR);
+}
+
+void LocalServer::ServeEcho(int fd) {
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        if (!WriteAll(fd, std::string(buffer, n))) {
+            break;
+        }
+    }
+}
+
+// 每个连接处理一个请求，应答后关闭 (HttpClient 发 Connection: close，ML307 按 HTTP/1.0 发送)
+void LocalServer::ServeHttp(int fd) {
+    std::string header, rest, body;
+    if (!ReadHeader(fd, header, rest)) {
+        return;
+    }
+    std::string content_length = HeaderValue(header, "Content-Length");
+    if (HeaderValue(header, "Transfer-Encoding").find("chunked") != std::string::npos) {
+        std::string line;
+        while (TakeLine(fd, rest, line)) {
+            size_t size = strtoul(line.c_str(), nullptr, 16);
+            if (!TakeExact(fd, rest, size + 2, body)) {
+                return;
+            }
+            body.resize(body.size() - 2);
+            if (size == 0) {
+                break;
+            }
+        }
+    } else if (!content_length.empty()) {
+        if (!TakeExact(fd, rest, strtoul(content_length.c_str(), nullptr, 10), body)) {
+            return;
+        }
+    }
+    request_count_++;
+
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n";
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+    WriteAll(fd, response + body);
+}
+
+static std::string MqttPacket(uint8_t type, const std::string& body) {
+    std::string packet(1, (char)type);
+    size_t length = body.size();
+    do {
+        uint8_t byte = length % 128;
+        length /= 128;
+        packet.push_back((char)(byte | (length ? 0x80 : 0)));
+    } while (length);
+    return packet + body;
+}
+
+void LocalServer::ServeMqtt(int fd) {
+    while (true) {
+        uint8_t type, byte;
+        if (!ReadExact(fd, &type, 1)) {
+            return;
+        }
+        size_t length = 0;
+        int shift = 0;
+        do {
+            if (!ReadExact(fd, &byte, 1)) {
+                return;
+            }
+            length |= (size_t)(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        std::string body(length, '\0');
+        if (length > 0 && !ReadExact(fd, &body[0], length)) {
+            return;
+        }
+
+        std::string reply;
+        switch (type & 0xf0) {
+            case 0x10:  // CONNECT -> CONNACK
+                reply = MqttPacket(0x20, std::string("\0\0", 2));
+                break;
+            case 0x30: {  // PUBLISH: QoS 1 先回 PUBACK，再以 QoS 0 回送给发布者
+                request_count_++;
+                int qos = (type >> 1) & 3;
+                size_t topic_length = ((uint8_t)body[0] << 8) | (uint8_t)body[1];
+                size_t payload_offset = 2 + topic_length + (qos ? 2 : 0);
+                if (qos) {
+                    reply = MqttPacket(0x40, body.substr(2 + topic_length, 2));
+                }
+                reply += MqttPacket(0x30, body.substr(0, 2 + topic_length) + body.substr(payload_offset));
+                break;
+            }
+            case 0x80:  // SUBSCRIBE -> SUBACK，按请求的 QoS 授予
+                reply = MqttPacket(0x90, body.substr(0, 2) + body.substr(body.size() - 1));
+                break;
+            case 0xa0:  // UNSUBSCRIBE -> UNSUBACK
+                reply = MqttPacket(0xb0, body.substr(0, 2));
+                break;
+            case 0xc0:  // PINGREQ -> PINGRESP
+                reply = MqttPacket(0xd0, "");
+                break;
+            case 0xe0:  // DISCONNECT
+                return;
+            default:
+                break;
+        }
+        if (!reply.empty() && !WriteAll(fd, reply)) {
+            return;
+        }
+    }
+}
+
+void LocalServer::ServeWebSocket(int fd) {
+    std::string header, rest;
+    if (!ReadHeader(fd, header, rest)) {
+        return;
+    }
+    if (!WriteAll(fd, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\r\n")) {
+        return;
+    }
+    while (true) {
+        std::string frame;
+        if (!TakeExact(fd, rest, 2, frame)) {
+            return;
+        }
+        uint8_t opcode = frame[0] & 0x0f;
+        bool masked = (frame[1] & 0x80) != 0;
+        size_t length = frame[1] & 0x7f;
+        std::string extended;
+        if (length == 126) {
+            if (!TakeExact(fd, rest, 2, extended)) {
+                return;
+            }
+            length = ((uint8_t)extended[0] << 8) | (uint8_t)extended[1];
+        } else if (length == 127) {
+            if (!TakeExact(fd, rest, 8, extended)) {
+                return;
+            }
+            length = 0;
+            for (int i = 0; i < 8; i++) {
+                length = (length << 8) | (uint8_t)extended[i];
+            }
+        }
+        std::string mask, payload;
+        if ((masked && !TakeExact(fd, rest, 4, mask)) || !TakeExact(fd, rest, length, payload)) {
+            return;
+        }
+        for (size_t i = 0; masked && i < payload.size(); i++) {
+            payload[i] ^= mask[i % 4];
+        }
+
+        // 服务器发出的帧不加掩码
+        std::string reply(1, (char)(0x80 | opcode));
+        if (opcode == 0x9) {
+            reply[0] = (char)0x8a;  // Ping -> Pong
+        }
+        if (payload.size() < 126) {
+            reply.push_back((char)payload.size());
+        } else {
+            reply.push_back((char)126);
+            reply.push_back((char)(payload.size() >> 8));
+            reply.push_back((char)(payload.size() & 0xff));
+        }
+        reply += payload;
+        if (opcode == 0x1 || opcode == 0x2 || opcode == 0x0) {
+            request_count_++;
+        }
+        if (!WriteAll(fd, reply) || opcode == 0x8) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,44 @@
+// 模组模拟器把模组内的连接映射为本机 socket，这里是测试和基准连接的本机服务器。
+// 每个服务器监听 127.0.0.1 上系统分配的端口，每个客户端一个线程:
+//   Echo       原样回送
+//   Http       回送请求体，状态码 200，带 Content-Length
+//   Mqtt       最小的 3.1.1 broker，把 PUBLISH 回送给发布者 (不论是否订阅)
+//   WebSocket  握手后回送数据帧，不校验 Sec-WebSocket-Key
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class LocalServerKind { Echo, Http, Mqtt, WebSocket };
+
+class LocalServer {
+public:
+    explicit LocalServer(LocalServerKind kind);
+    ~LocalServer();
+
+    // 监听失败时为 0
+    int port() const { return port_; }
+    // 已处理的请求数: HTTP 请求、MQTT PUBLISH、WebSocket 数据帧
+    int request_count() const { return request_count_; }
+
+private:
+    LocalServerKind kind_;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> request_count_{0};
+    std::thread thread_;
+    std::mutex mutex_;
+    std::vector<int> client_fds_;
+    std::vector<std::thread> clients_;
+
+    void Accept();
+    void Serve(int fd);
+    void ServeEcho(int fd);
+    void ServeHttp(int fd);
+    void ServeMqtt(int fd);
+    void ServeWebSocket(int fd);
+};
@@ -0,0 +1,257 @@
+// feature_4g_ml307 的端到端测试: AtUart 与 ML307/EC801E 驱动接到 AtModemSimulator 上，
+// 模组内的 TCP/MQTT/HTTP 连接落到本机的 LocalServer，走完 检测 -> 注网 -> 收发 的完整流程。
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include "at_modem.h"
+#include "at_modem_simulator.h"
+#include "local_servers.h"
+#include "esp_log.h"
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// 回调线程写入、测试线程等待的数据
+struct Received {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::string data;
+
+    void Append(const std::string& more) {
+        std::lock_guard<std::mutex> lock(mutex);
+        data += more;
+        cv.notify_all();
+    }
+
+    bool WaitFor(size_t size, int timeout_ms = 5000) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] { return data.size() >= size; });
+    }
+};
+
+// 载荷里混入 "\r\nOK\r\n" 和 URC 样式的行，检查数据不会被当成应答或 URC 解析
+static std::string MakePayload(size_t size) {
+    static const char pattern[] = "\r\nOK\r\n+MIPURC: \"rtcp\",0,4\r\n+QIURC: \"recv\",1\r\nabc\0xyz";
+    std::string payload(size, '\0');
+    for (size_t i = 0; i < size; i++) {
+        payload[i] = pattern[i % (sizeof(pattern) - 1)];
+    }
+    return payload;
+}
+
+// shim 无法从外部删除 AtUart 的接收任务，模组对象保留到进程退出
+static AtModem* DetectModem(const AtModemSimulatorConfig& config, AtModemSimulator** simulator) {
+    auto transport = std::make_unique<AtModemSimulator>(config);
+    *simulator = transport.get();
+    auto uart = std::make_shared<AtUart>(std::move(transport));
+    uart->Initialize();
+    return AtModem::Detect(uart, 115200, 3000).release();
+}
+
+static void test_identity(AtModem* modem, const AtModemSimulatorConfig& config) {
+    CHECK(modem->WaitForNetworkReady(3000) == NetworkStatus::Ready);
+    CHECK(modem->GetModuleRevision() == config.revision);
+    CHECK(modem->GetImei() == config.imei);
+    CHECK(modem->GetIccid() == config.iccid);
+    CHECK(modem->GetCarrierName().find(config.carrier) != std::string::npos);
+    CHECK(modem->GetCsq() == config.csq);
+}
+
+static void test_tcp_echo(AtModem* modem, const LocalServer& server, size_t size) {
+    auto tcp = modem->CreateTcp(0);
+    Received received;
+    tcp->OnStream([&](const std::string& data) { received.Append(data); });
+    CHECK(tcp->Connect("127.0.0.1", server.port()));
+
+    std::string payload = MakePayload(size);
+    CHECK(tcp->Send(payload) == (int)payload.size());
+    CHECK(received.WaitFor(payload.size()));
+    CHECK(received.data == payload);
+    tcp->Disconnect();
+}
+
+static void test_mqtt_round_trip(AtModem* modem, const LocalServer& server, size_t size, int qos) {
+    auto mqtt = modem->CreateMqtt(0);
+    Received received;
+    std::string topic;
+    mqtt->OnMessage([&](const std::string& message_topic, const std::string& payload) {
+        topic = message_topic;
+        received.Append(payload);
+    });
+    CHECK(mqtt->Connect("127.0.0.1", server.port(), "host-test", "user", "password"));
+    CHECK(mqtt->Subscribe("molly/test", qos));
+
+    std::string payload(size, 'm');
+    for (size_t i = 0; i < size; i++) {
+        payload[i] = 'a' + i % 26;
+    }
+    CHECK(mqtt->Publish("molly/test", payload, qos));
+    CHECK(received.WaitFor(payload.size()));
+    CHECK(topic == "molly/test");
+    CHECK(received.data == payload);
+    mqtt->Disconnect();
+}
+
+static void test_http_post(AtModem* modem, const LocalServer& server) {
+    auto http = modem->CreateHttp(0);
+    std::string body = "{\"device\":\"molly\",\"payload\":\"" + std::string(1500, 'h') + "\"}";
+    http->SetHeader("Content-Type", "application/json");
+    http->SetContent(std::string(body));
+    CHECK(http->Open("POST", "http://127.0.0.1:" + std::to_string(server.port()) + "/upload"));
+    CHECK(http->GetStatusCode() == 200);
+    CHECK(http->ReadAll() == body);
+    http->Close();
+}
+
+static void test_websocket_echo(AtModem* modem, const LocalServer& server) {
+    auto ws = modem->CreateWebSocket(0);
+    Received received;
+    ws->OnData([&](const char* data, size_t length, bool binary) { received.Append(std::string(data, length)); });
+    CHECK(ws->Connect(("ws://127.0.0.1:" + std::to_string(server.port()) + "/ws").c_str()));
+
+    std::string payload = MakePayload(3000);
+    CHECK(ws->Send(payload.data(), payload.size(), true));
+    CHECK(received.WaitFor(payload.size()));
+    CHECK(received.data == payload);
+    ws->Close();
+}
+
+// 接收途中 FIFO 溢出: 连接按断开处理，交给上层的只能是完整数据的前缀；之后命令照常，同一连接号可以重连
+static void test_fifo_overflow(AtModem* modem, AtModemSimulator* simulator, const LocalServer& server) {
+    auto tcp = modem->CreateTcp(0);
+    Received received;
+    std::atomic<bool> disconnected{false};
+    tcp->OnStream([&](const std::string& data) { received.Append(data); });
+    tcp->OnDisconnected([&] { disconnected = true; });
+    CHECK(tcp->Connect("127.0.0.1", server.port()));
+
+    std::string payload = MakePayload(8000);
+    size_t overflow_count = modem->GetAtUart()->GetFifoOverflowCount();
+    CHECK(tcp->Send(payload) == (int)payload.size());
+    CHECK(received.WaitFor(1));
+    simulator->DropRxBytes(64);
+    received.WaitFor(payload.size(), 1000);
+
+    CHECK(disconnected);
+    CHECK(!tcp->connected());
+    CHECK(modem->GetAtUart()->GetFifoOverflowCount() == overflow_count + 1);
+    {
+        std::lock_guard<std::mutex> lock(received.mutex);
+        CHECK(received.data.size() < payload.size());
+        CHECK(payload.compare(0, received.data.size(), received.data) == 0);
+    }
+    tcp->Disconnect();
+
+    CHECK(modem->GetAtUart()->SendCommand("AT"));
+    test_tcp_echo(modem, server, 2000);
+}
+
+// 命令超时后应答才到: 迟到的 OK 不能算到后面的命令头上，之后每条命令拿到的仍是自己的结果
+static void test_late_result(AtModem* modem, AtModemSimulator* simulator, const AtModemSimulatorConfig& config) {
+    auto uart = modem->GetAtUart();
+    simulator->SetResponseDelay(100);
+    auto slow = uart->SendCommandAsync("AT+CSQ", 10);
+    auto queued = uart->SendCommandAsync("AT+CGMR", 1000);
+    simulator->SetResponseDelay(0);
+    slow->Wait(2000);
+    queued->Wait(2000);
+    CHECK(slow->IsDone() && slow->result().result == AtResult::Timeout);
+    // 与超时命令同时在途，结果无法对应，一并按超时结束
+    CHECK(queued->IsDone() && queued->result().result == AtResult::Timeout);
+
+    CHECK(uart->SendCommand("AT+CGMR"));
+    CHECK(uart->GetResponse() == config.revision);
+    CHECK(uart->SendCommand("AT+CGSN"));
+    CHECK(uart->GetResponse() == config.imei);
+    CHECK(modem->GetCsq() == config.csq);
+}
+
+// 模组重启 (RDY) 后缓存的配置失效: 下次连接重新下发 QICFG，信号强度改为查询直到重新订阅上报
+static void test_ec801e_restart(AtModem* modem, AtModemSimulator* simulator, const LocalServer& server) {
+    test_tcp_echo(modem, server, 100);
+    int qicfg = simulator->command_count("QICFG");
+    test_tcp_echo(modem, server, 100);
+    CHECK(simulator->command_count("QICFG") == qicfg);
+
+    int csq = simulator->command_count("CSQ");
+    modem->GetCsq();
+    CHECK(simulator->command_count("CSQ") == csq);
+    simulator->InjectUrc("RDY");
+    CHECK(modem->GetAtUart()->SendCommand("AT"));
+    modem->GetCsq();
+    CHECK(simulator->command_count("CSQ") == csq + 1);
+
+    test_tcp_echo(modem, server, 100);
+    CHECK(simulator->command_count("QICFG") > qicfg);
+}
+
+static void test_ml307(const LocalServer& echo, const LocalServer& mqtt, const LocalServer& http, const LocalServer& ws) {
+    AtModemSimulatorConfig config;
+    config.network_latency_ms = 5;
+    config.uart_baud_rate = 921600;
+    AtModemSimulator* simulator;
+    AtModem* modem = DetectModem(config, &simulator);
+    CHECK(modem != nullptr);
+    if (!modem) {
+        return;
+    }
+    test_identity(modem, config);
+    test_tcp_echo(modem, echo, 5000);
+    test_mqtt_round_trip(modem, mqtt, 3000, 1);
+    test_http_post(modem, http);
+    test_websocket_echo(modem, ws);
+    test_fifo_overflow(modem, simulator, echo);
+    test_late_result(modem, simulator, config);
+}
+
+static void test_ec801e(const LocalServer& echo, const LocalServer& mqtt, const LocalServer& http, const LocalServer& ws) {
+    AtModemSimulatorConfig config;
+    config.revision = "EC801ECNLAR01A01M08";
+    config.csq = 17;
+    config.network_latency_ms = 5;
+    config.uart_baud_rate = 921600;
+    AtModemSimulator* simulator;
+    AtModem* modem = DetectModem(config, &simulator);
+    CHECK(modem != nullptr);
+    if (!modem) {
+        return;
+    }
+    test_identity(modem, config);
+    test_tcp_echo(modem, echo, 4000);
+    test_mqtt_round_trip(modem, mqtt, 200, 0);
+    test_http_post(modem, http);
+    test_websocket_echo(modem, ws);
+    test_fifo_overflow(modem, simulator, echo);
+    test_late_result(modem, simulator, config);
+    test_ec801e_restart(modem, simulator, echo);
+}
+
+int main(int argc, char** argv) {
+    LocalServer echo(LocalServerKind::Echo);
+    LocalServer mqtt(LocalServerKind::Mqtt);
+    LocalServer http(LocalServerKind::Http);
+    LocalServer ws(LocalServerKind::WebSocket);
+    CHECK(echo.port() && mqtt.port() && http.port() && ws.port());
+
+    host_log_set_quiet(getenv("AT_MODEM_VERBOSE") == nullptr);
+    test_ml307(echo, mqtt, http, ws);
+    test_ec801e(echo, mqtt, http, ws);
+    host_log_set_quiet(0);
+
+    printf("%s (%d failures)\n", s_failures ? "FAILED" : "OK", s_failures);
+    // 接收任务仍在运行，不执行静态析构
+    fflush(stdout);
+    _exit(s_failures ? 1 : 0);
+}
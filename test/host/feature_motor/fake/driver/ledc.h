@@ -0,0 +1,80 @@
+// 主机测试用的 LEDC 假驱动: 记录占空比和渐变请求，渐变由测试调用 fake_ledc_finish_fade() 结束
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { LEDC_LOW_SPEED_MODE = 0 } ledc_mode_t;
+typedef enum { LEDC_CHANNEL_0 = 0, LEDC_CHANNEL_1, LEDC_CHANNEL_MAX } ledc_channel_t;
+typedef enum { LEDC_TIMER_0 = 0 } ledc_timer_t;
+typedef enum { LEDC_TIMER_8_BIT = 8 } ledc_timer_bit_t;
+typedef enum { LEDC_AUTO_CLK = 0 } ledc_clk_cfg_t;
+typedef enum { LEDC_INTR_DISABLE = 0 } ledc_intr_type_t;
+typedef enum { LEDC_FADE_NO_WAIT = 0, LEDC_FADE_WAIT_DONE } ledc_fade_mode_t;
+typedef enum { LEDC_FADE_END_EVT = 0 } ledc_cb_event_t;
+
+typedef struct {
+    ledc_mode_t      speed_mode;
+    ledc_timer_bit_t duty_resolution;
+    ledc_timer_t     timer_num;
+    uint32_t         freq_hz;
+    ledc_clk_cfg_t   clk_cfg;
+} ledc_timer_config_t;
+
+typedef struct {
+    int              gpio_num;
+    ledc_mode_t      speed_mode;
+    ledc_channel_t   channel;
+    ledc_intr_type_t intr_type;
+    ledc_timer_t     timer_sel;
+    uint32_t         duty;
+    int              hpoint;
+} ledc_channel_config_t;
+
+typedef struct {
+    ledc_cb_event_t event;
+    uint32_t        speed_mode;
+    uint32_t        channel;
+    uint32_t        duty;
+} ledc_cb_param_t;
+
+typedef bool (*ledc_cb_t)(const ledc_cb_param_t *param, void *user_arg);
+
+typedef struct {
+    ledc_cb_t fade_cb;
+} ledc_cbs_t;
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *config);
+esp_err_t ledc_channel_config(const ledc_channel_config_t *config);
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty);
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel);
+esp_err_t ledc_fade_func_install(int intr_alloc_flags);
+void      ledc_fade_func_uninstall(void);
+esp_err_t ledc_cb_register(ledc_mode_t mode, ledc_channel_t channel, ledc_cbs_t *cbs, void *user_arg);
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel, uint32_t target_duty, int max_fade_time_ms);
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel, ledc_fade_mode_t fade_mode);
+esp_err_t ledc_fade_stop(ledc_mode_t mode, ledc_channel_t channel);
+
+// --- 测试接口 ---
+typedef struct {
+    uint32_t duty;            // 当前生效的占空比
+    bool     fading;          // 是否有正在进行的渐变
+    uint32_t fade_target;     // 最近一次渐变的目标占空比
+    uint32_t fade_time_ms;    // 最近一次渐变的时长
+    uint32_t fades_started;
+    uint32_t fades_stopped;
+    uint32_t gpio_level;      // 数字模式下的输出电平
+} fake_ledc_state_t;
+
+void fake_ledc_get_state(fake_ledc_state_t *out);
+// 结束正在进行的渐变: 占空比跳到目标值并在调用线程中触发渐变结束回调，没有渐变时返回 false
+bool fake_ledc_finish_fade(void);
+
+#ifdef __cplusplus
+}
+#endif
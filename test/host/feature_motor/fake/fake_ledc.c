@@ -0,0 +1,138 @@
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "freertos/FreeRTOS.h"
+
+static fake_ledc_state_t s_state;
+static uint32_t s_pending_duty;     // ledc_set_duty 设置、ledc_update_duty 生效
+static uint32_t s_fade_request;     // ledc_set_fade_with_time 设置、ledc_fade_start 生效
+static uint32_t s_fade_request_ms;
+static bool s_fade_installed;
+static ledc_cb_t s_fade_cb;
+static void *s_fade_cb_arg;
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    return config ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    host_enter_critical();
+    s_state.gpio_level = level;
+    host_exit_critical();
+    return ESP_OK;
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *config)
+{
+    return config ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *config)
+{
+    if (!config) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_enter_critical();
+    s_state.duty = config->duty;
+    host_exit_critical();
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty)
+{
+    host_enter_critical();
+    s_pending_duty = duty;
+    host_exit_critical();
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel)
+{
+    host_enter_critical();
+    // 与硬件一致: 渐变进行中直接改占空比是未定义行为，这里按错误处理
+    esp_err_t ret = s_state.fading ? ESP_ERR_INVALID_STATE : ESP_OK;
+    if (ret == ESP_OK) {
+        s_state.duty = s_pending_duty;
+    }
+    host_exit_critical();
+    return ret;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags)
+{
+    s_fade_installed = true;
+    return ESP_OK;
+}
+
+void ledc_fade_func_uninstall(void)
+{
+    s_fade_installed = false;
+    s_fade_cb = NULL;
+}
+
+esp_err_t ledc_cb_register(ledc_mode_t mode, ledc_channel_t channel, ledc_cbs_t *cbs, void *user_arg)
+{
+    s_fade_cb = cbs->fade_cb;
+    s_fade_cb_arg = user_arg;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel, uint32_t target_duty, int max_fade_time_ms)
+{
+    if (!s_fade_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    host_enter_critical();
+    s_fade_request = target_duty;
+    s_fade_request_ms = (uint32_t)max_fade_time_ms;
+    host_exit_critical();
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel, ledc_fade_mode_t fade_mode)
+{
+    host_enter_critical();
+    s_state.fading = true;
+    s_state.fade_target = s_fade_request;
+    s_state.fade_time_ms = s_fade_request_ms;
+    s_state.fades_started++;
+    host_exit_critical();
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t mode, ledc_channel_t channel)
+{
+    host_enter_critical();
+    if (s_state.fading) {
+        s_state.fading = false;
+        s_state.fades_stopped++;
+    }
+    host_exit_critical();
+    return ESP_OK;
+}
+
+void fake_ledc_get_state(fake_ledc_state_t *out)
+{
+    host_enter_critical();
+    *out = s_state;
+    host_exit_critical();
+}
+
+bool fake_ledc_finish_fade(void)
+{
+    host_enter_critical();
+    bool fading = s_state.fading;
+    if (fading) {
+        s_state.fading = false;
+        s_state.duty = s_state.fade_target;
+    }
+    ledc_cb_param_t param = { .event = LEDC_FADE_END_EVT, .duty = s_state.duty };
+    ledc_cb_t cb = s_fade_cb;
+    host_exit_critical();
+
+    if (fading && cb) {
+        cb(&param, s_fade_cb_arg);
+    }
+    return fading;
+}
@@ -0,0 +1,124 @@
+// feature_motor 的主机测试，按 PWM 模式编译并接假的 LEDC 驱动 (fake/driver/ledc.h):
+// 覆盖板上数字模式用不到的硬件渐变路径，以及定时震动与波形停止之间的先后顺序
+#include <stdio.h>
+#include <unistd.h>
+#include "feature_motor.h"
+#include "driver/ledc.h"
+#include "esp_log.h"
+
+#define DUTY_ON   ((50 * 255) / 100)   // mada_driver_on() 的默认占空比
+#define DUTY_FULL (255)
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static fake_ledc_state_t s_ledc;
+static volatile int s_output_starts = 0;
+
+static void prv_on_output_start(int64_t start_us, void* arg)
+{
+    s_output_starts++;
+}
+
+// 触觉任务异步执行，轮询等待条件成立 (最多 1 秒)
+#define WAIT_UNTIL(cond) ({ \
+        int ok_ = 0; \
+        for (int i_ = 0; i_ < 1000; i_++) { \
+            fake_ledc_get_state(&s_ledc); \
+            if (cond) { ok_ = 1; break; } \
+            usleep(1000); \
+        } \
+        ok_; \
+    })
+
+static void test_ramp_uses_hardware_fade(void)
+{
+    fake_ledc_get_state(&s_ledc);
+    uint32_t started = s_ledc.fades_started;
+    mada_set_output_start_cb(prv_on_output_start, NULL);
+
+    mada_play_preset(MADA_PRESET_RAMP_UP);
+    CHECK(mada_is_vibrating());
+    CHECK(WAIT_UNTIL(s_ledc.fading && s_ledc.fades_started == started + 1));
+    // 开始输出的回调在第一段渐变发出后调用，每个波形一次
+    CHECK(WAIT_UNTIL(s_output_starts == 1));
+    CHECK(s_ledc.fade_target == DUTY_FULL && s_ledc.fade_time_ms == 400);
+
+    // 渐变结束 -> 保持 100 ms -> 渐出到 0
+    CHECK(fake_ledc_finish_fade());
+    CHECK(WAIT_UNTIL(s_ledc.fading && s_ledc.fades_started == started + 2));
+    CHECK(s_ledc.fade_target == 0 && s_ledc.fade_time_ms == 300);
+    CHECK(fake_ledc_finish_fade());
+    CHECK(WAIT_UNTIL(!s_ledc.fading && s_ledc.duty == 0 && !mada_is_vibrating()));
+    CHECK(s_output_starts == 1);
+    mada_set_output_start_cb(NULL, NULL);
+}
+
+static void test_vibrate_after_pattern_stays_on(void)
+{
+    // 波形刚开始就切到定时震动: 触觉任务处理停止必须发生在打开马达之前
+    for (int i = 0; i < 200; i++) {
+        mada_play_preset(MADA_PRESET_HEARTBEAT);
+        if (i & 1) {
+            mada_continuous_vibrate();
+        } else {
+            mada_vibrate(10000);
+        }
+        CHECK(WAIT_UNTIL(!s_ledc.fading && s_ledc.duty == DUTY_ON));
+        usleep(2000);
+        fake_ledc_get_state(&s_ledc);
+        CHECK(s_ledc.duty == DUTY_ON);
+        CHECK(mada_is_vibrating());
+        if (s_failures) {
+            printf("iteration %d: duty %u\n", i, (unsigned)s_ledc.duty);
+            break;
+        }
+    }
+    mada_stop();
+    CHECK(WAIT_UNTIL(s_ledc.duty == 0));
+    CHECK(!mada_is_vibrating());
+}
+
+static void test_timed_vibrate_expires(void)
+{
+    mada_vibrate(50);
+    CHECK(WAIT_UNTIL(s_ledc.duty == DUTY_ON));
+    CHECK(WAIT_UNTIL(s_ledc.duty == 0));
+    CHECK(!mada_is_vibrating());
+}
+
+static void test_pattern_replaces_vibrate(void)
+{
+    mada_continuous_vibrate();
+    CHECK(WAIT_UNTIL(s_ledc.duty == DUTY_ON));
+    mada_play_preset(MADA_PRESET_TAP);
+    CHECK(WAIT_UNTIL(s_ledc.duty == DUTY_FULL));
+    // 轻触保持 40 ms 后关闭，马达不会回到持续震动
+    CHECK(WAIT_UNTIL(s_ledc.duty == 0 && !mada_is_vibrating()));
+    usleep(20000);
+    fake_ledc_get_state(&s_ledc);
+    CHECK(s_ledc.duty == 0);
+}
+
+int main(void)
+{
+    host_log_set_quiet(1);
+    CHECK(mada_initialize() == ESP_OK);
+
+    test_ramp_uses_hardware_fade();
+    test_vibrate_after_pattern_stays_on();
+    test_timed_vibrate_expires();
+    test_pattern_replaces_vibrate();
+
+    mada_deinitialize();
+    host_log_set_quiet(0);
+
+    printf("%s (%d failures)\n", s_failures ? "FAILED" : "OK", s_failures);
+    return s_failures ? 1 : 0;
+}
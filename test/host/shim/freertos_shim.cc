@@ -0,0 +1,357 @@
+// FreeRTOS 任务、队列、信号量、事件组、任务通知的主机实现
+// 任务为分离的线程；阻塞等待统一换算为 steady_clock 超时，portMAX_DELAY 表示一直等待
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+#include <pthread.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const Clock::time_point s_tick_origin = Clock::now();
+static std::atomic<TickType_t> s_tick_skipped{0};
+
+static Clock::time_point Deadline(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        return Clock::time_point::max();
+    }
+    return Clock::now() + std::chrono::milliseconds(pdTICKS_TO_MS(ticks));
+}
+
+// 在 deadline 之前等待 pred 成立
+template <typename Pred>
+static bool WaitUntil(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, Clock::time_point deadline, Pred pred) {
+    if (deadline == Clock::time_point::max()) {
+        cv.wait(lock, pred);
+        return true;
+    }
+    return cv.wait_until(lock, deadline, pred);
+}
+
+/* 任务与任务通知 */
+
+struct HostTask {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t value = 0;
+    bool pending = false;
+};
+
+static thread_local HostTask* s_current_task = nullptr;
+
+static HostTask* CurrentTask() {
+    // 非 xTaskCreate 创建的线程 (如 main) 首次调用时分配，进程结束前不释放
+    if (!s_current_task) {
+        s_current_task = new HostTask;
+    }
+    return s_current_task;
+}
+
+extern "C" {
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth, void* parameters,
+                                   UBaseType_t priority, TaskHandle_t* created_task, BaseType_t core_id) {
+    auto task = new HostTask;
+    if (created_task) {
+        *created_task = task;
+    }
+    std::thread([task, function, parameters]() {
+        s_current_task = task;
+        function(parameters);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_depth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* created_task) {
+    return xTaskCreatePinnedToCore(function, name, stack_depth, parameters, priority, created_task, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // 只支持删除自身；任务对象可能仍被其他线程引用，不释放
+    if (task == nullptr || task == s_current_task) {
+        pthread_exit(nullptr);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(pdTICKS_TO_MS(ticks)));
+}
+
+TickType_t xTaskGetTickCount(void) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - s_tick_origin).count();
+    return (TickType_t)pdMS_TO_TICKS(elapsed) + s_tick_skipped;
+}
+
+void host_ticks_skip(TickType_t ticks) { s_tick_skipped += ticks; }
+
+TickType_t xTaskGetTickCountFromISR(void) { return xTaskGetTickCount(); }
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return CurrentTask(); }
+
+BaseType_t xTaskNotify(TaskHandle_t handle, uint32_t value, eNotifyAction action) {
+    auto task = (HostTask*)handle;
+    std::lock_guard<std::mutex> lock(task->mutex);
+    switch (action) {
+        case eSetBits: task->value |= value; break;
+        case eIncrement: task->value++; break;
+        case eSetValueWithOverwrite: task->value = value; break;
+        case eSetValueWithoutOverwrite:
+            if (task->pending) {
+                return pdFAIL;
+            }
+            task->value = value;
+            break;
+        case eNoAction: break;
+    }
+    task->pending = true;
+    task->cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t* woken) {
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value, TickType_t ticks) {
+    auto task = CurrentTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    if (!task->pending) {
+        task->value &= ~clear_on_entry;
+    }
+    bool notified = WaitUntil(task->cv, lock, Deadline(ticks), [task] { return task->pending; });
+    if (value) {
+        *value = task->value;
+    }
+    if (!notified) {
+        return pdFALSE;
+    }
+    task->pending = false;
+    task->value &= ~clear_on_exit;
+    return pdTRUE;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) { return xTaskNotify(task, 0, eIncrement); }
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    xTaskNotify(task, 0, eIncrement);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    auto task = CurrentTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    WaitUntil(task->cv, lock, Deadline(ticks), [task] { return task->value != 0; });
+    uint32_t value = task->value;
+    if (value != 0) {
+        task->value = clear_on_exit ? 0 : value - 1;
+    }
+    task->pending = task->value != 0;
+    return value;
+}
+
+}
+
+/* 队列与信号量 */
+
+struct HostQueue {
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::vector<uint8_t> storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head = 0;
+    UBaseType_t count = 0;
+    bool is_mutex = false;
+};
+
+static BaseType_t QueueSend(QueueHandle_t handle, const void* item, TickType_t ticks, bool front) {
+    auto queue = (HostQueue*)handle;
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!WaitUntil(queue->not_full, lock, Deadline(ticks), [queue] { return queue->count < queue->length; })) {
+        return pdFAIL;
+    }
+    UBaseType_t index;
+    if (front) {
+        queue->head = (queue->head + queue->length - 1) % queue->length;
+        index = queue->head;
+    } else {
+        index = (queue->head + queue->count) % queue->length;
+    }
+    if (queue->item_size > 0) {
+        memcpy(&queue->storage[(size_t)index * queue->item_size], item, queue->item_size);
+    }
+    queue->count++;
+    queue->not_empty.notify_one();
+    return pdPASS;
+}
+
+extern "C" {
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    auto queue = new HostQueue;
+    queue->length = length;
+    queue->item_size = item_size;
+    queue->storage.resize((size_t)length * item_size);
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) { delete (HostQueue*)queue; }
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    return QueueSend(queue, item, ticks, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    return QueueSend(queue, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    return QueueSend(queue, item, ticks, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken) {
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return QueueSend(queue, item, 0, false);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t handle, void* item, TickType_t ticks) {
+    auto queue = (HostQueue*)handle;
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!WaitUntil(queue->not_empty, lock, Deadline(ticks), [queue] { return queue->count > 0; })) {
+        return pdFAIL;
+    }
+    if (queue->item_size > 0) {
+        memcpy(item, &queue->storage[(size_t)queue->head * queue->item_size], queue->item_size);
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    queue->not_full.notify_one();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t queue, void* item, BaseType_t* woken) {
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return xQueueReceive(queue, item, 0);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle) {
+    auto queue = (HostQueue*)handle;
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t handle) {
+    auto queue = (HostQueue*)handle;
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->length - queue->count;
+}
+
+// 信号量是长度为 max_count、元素大小为 0 的队列，与 FreeRTOS 的实现方式相同；
+// 互斥锁初始为可获取，不支持优先级继承与递归计数
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    auto queue = (HostQueue*)xQueueCreate(max_count, 0);
+    queue->count = initial_count;
+    return queue;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { return xSemaphoreCreateCounting(1, 0); }
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    auto queue = (HostQueue*)xSemaphoreCreateCounting(1, 1);
+    queue->is_mutex = true;
+    return queue;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) { return xSemaphoreCreateMutex(); }
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) { vQueueDelete(semaphore); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) { return xQueueReceive(semaphore, nullptr, ticks); }
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) { return xQueueSend(semaphore, nullptr, 0); }
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* woken) {
+    return xQueueSendFromISR(semaphore, nullptr, woken);
+}
+
+}
+
+/* 事件组 */
+
+struct HostEventGroup {
+    std::mutex mutex;
+    std::condition_variable cv;
+    EventBits_t bits = 0;
+};
+
+extern "C" {
+
+EventGroupHandle_t xEventGroupCreate(void) { return new HostEventGroup; }
+
+void vEventGroupDelete(EventGroupHandle_t group) { delete (HostEventGroup*)group; }
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t handle, EventBits_t bits) {
+    auto group = (HostEventGroup*)handle;
+    std::lock_guard<std::mutex> lock(group->mutex);
+    group->bits |= bits;
+    group->cv.notify_all();
+    return group->bits;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, EventBits_t bits, BaseType_t* woken) {
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    xEventGroupSetBits(group, bits);
+    return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t handle, EventBits_t bits) {
+    auto group = (HostEventGroup*)handle;
+    std::lock_guard<std::mutex> lock(group->mutex);
+    EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t handle) {
+    auto group = (HostEventGroup*)handle;
+    std::lock_guard<std::mutex> lock(group->mutex);
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t handle, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks) {
+    auto group = (HostEventGroup*)handle;
+    std::unique_lock<std::mutex> lock(group->mutex);
+    auto satisfied = [group, bits, wait_for_all] {
+        return wait_for_all ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+    };
+    bool ok = WaitUntil(group->cv, lock, Deadline(ticks), satisfied);
+    EventBits_t result = group->bits;
+    if (ok && clear_on_exit) {
+        group->bits &= ~bits;
+    }
+    return result;
+}
+
+}
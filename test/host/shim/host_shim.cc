@@ -0,0 +1,105 @@
+// FreeRTOS / ESP-IDF 在主机上的最小实现，只覆盖被测组件用到的部分
+#include <freertos/FreeRTOS.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+static std::recursive_mutex s_critical;
+static const auto s_start = std::chrono::steady_clock::now();
+static std::atomic<bool> s_manual_clock{false};
+static std::atomic<int64_t> s_manual_now_us{0};
+
+static std::mutex s_log_mutex;
+static char *s_capture = nullptr;
+static size_t s_capture_size = 0;
+static size_t s_capture_length = 0;
+static bool s_quiet = false;
+
+extern "C" {
+
+void host_enter_critical(void) { s_critical.lock(); }
+void host_exit_critical(void) { s_critical.unlock(); }
+BaseType_t xPortGetCoreID(void) { return 0; }
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size) {
+    size_t length = strlen(src);
+    if (size > 0) {
+        size_t copy = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, copy);
+        dst[copy] = '\0';
+    }
+    return length;
+}
+#endif
+
+int64_t esp_timer_get_time(void) {
+    if (s_manual_clock) {
+        return s_manual_now_us;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+void host_clock_set_manual(int64_t now_us) {
+    s_manual_now_us = now_us;
+    s_manual_clock = true;
+}
+
+void host_clock_advance_us(int64_t delta_us) { s_manual_now_us += delta_us; }
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "ESP_ERR";
+    }
+}
+
+void host_log(char level, const char *tag, const char *format, ...) {
+    char line[512];
+    int prefix = snprintf(line, sizeof(line), "%c (%lld) %s: ", level, (long long)(esp_timer_get_time() / 1000), tag);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line + prefix, sizeof(line) - prefix, format, args);
+    va_end(args);
+
+    std::lock_guard<std::mutex> lock(s_log_mutex);
+    if (!s_quiet) {
+        printf("%s\n", line);
+    }
+    if (s_capture) {
+        size_t length = strlen(line);
+        if (s_capture_length + length + 2 <= s_capture_size) {
+            memcpy(s_capture + s_capture_length, line, length);
+            s_capture_length += length;
+            s_capture[s_capture_length++] = '\n';
+            s_capture[s_capture_length] = '\0';
+        }
+    }
+}
+
+void host_log_capture(char *buffer, size_t size) {
+    std::lock_guard<std::mutex> lock(s_log_mutex);
+    s_capture = buffer;
+    s_capture_size = size;
+    s_capture_length = 0;
+    if (buffer && size > 0) {
+        buffer[0] = '\0';
+    }
+}
+
+void host_log_set_quiet(int quiet) {
+    std::lock_guard<std::mutex> lock(s_log_mutex);
+    s_quiet = quiet != 0;
+}
+
+}
@@ -0,0 +1,5 @@
+#pragma once
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define EXT_RAM_BSS_ATTR
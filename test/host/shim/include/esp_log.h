@@ -0,0 +1,33 @@
+// 日志按 ESP-IDF 的格式 "I (<ms>) <tag>: ..." 输出到 stdout，测试可另外截取到内存中解析
+#pragma once
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void host_log(char level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief 开始把日志额外写入 buffer (以 '\0' 结尾，写满后截断)，buffer 为 NULL 时停止
+ */
+void host_log_capture(char *buffer, size_t size);
+
+/**
+ * @brief 关闭/打开日志输出到 stdout (截取不受影响)，基准测试中避免日志干扰计时
+ */
+void host_log_set_quiet(int quiet);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define ESP_LOGE(tag, format, ...) host_log('E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) host_log('W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) host_log('I', tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) do { } while (0)
+#define ESP_LOGV(tag, format, ...) do { } while (0)
+#define ESP_EARLY_LOGE ESP_LOGE
+#define ESP_EARLY_LOGW ESP_LOGW
+#define ESP_DRAM_LOGE  ESP_LOGE
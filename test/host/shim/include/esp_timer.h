@@ -0,0 +1,19 @@
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+/**
+ * @brief 切换为手动时钟：esp_timer_get_time 返回 now_us，之后只由 host_clock_advance_us 推进
+ */
+void host_clock_set_manual(int64_t now_us);
+void host_clock_advance_us(int64_t delta_us);
+
+#ifdef __cplusplus
+}
+#endif
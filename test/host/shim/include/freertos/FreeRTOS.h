@@ -0,0 +1,63 @@
+// 主机测试用的 FreeRTOS 最小替身，接口与 ESP-IDF 一致，实现见 host_shim.cc
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdPASS              1
+#define pdFAIL              0
+#define pdTRUE              1
+#define pdFALSE             0
+#define portMAX_DELAY       ((TickType_t)0xffffffffu)
+#define configTICK_RATE_HZ  100     // 与 sdkconfig 的 CONFIG_FREERTOS_HZ 一致
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define pdTICKS_TO_MS(t)    ((uint32_t)(((uint64_t)(t) * 1000) / configTICK_RATE_HZ))
+#define configMAX_PRIORITIES 25
+#define tskNO_AFFINITY      0x7fffffff
+#define portNUM_PROCESSORS  2
+
+#define BIT0  0x01
+#define BIT1  0x02
+#define BIT2  0x04
+#define BIT3  0x08
+#define BIT4  0x10
+#define BIT5  0x20
+#define BIT6  0x40
+#define BIT7  0x80
+#define BIT8  0x100
+#define BIT9  0x200
+#define BIT10 0x400
+#define BIT11 0x800
+
+// 临界区统一映射到一把全局递归锁，ISR 版本相同
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void host_enter_critical(void);
+void host_exit_critical(void);
+#define taskENTER_CRITICAL(mux)         host_enter_critical()
+#define taskEXIT_CRITICAL(mux)          host_exit_critical()
+#define taskENTER_CRITICAL_ISR(mux)     host_enter_critical()
+#define taskEXIT_CRITICAL_ISR(mux)      host_exit_critical()
+#define portENTER_CRITICAL(mux)         host_enter_critical()
+#define portEXIT_CRITICAL(mux)          host_exit_critical()
+#define portENTER_CRITICAL_SAFE(mux)    host_enter_critical()
+#define portEXIT_CRITICAL_SAFE(mux)     host_exit_critical()
+#define portYIELD_FROM_ISR(...)         do { } while (0)
+#define xPortInIsrContext()             0
+BaseType_t xPortGetCoreID(void);
+
+// 让 xTaskGetTickCount 立即前进 ticks，模拟长时间空闲 (休眠等待仍按真实时间)
+void host_ticks_skip(TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+// newlib 提供而 glibc (2.38 之前) 没有的函数，经 -include 注入每个编译单元
+#pragma once
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size);
+#endif
+#ifdef __cplusplus
+}
+#endif
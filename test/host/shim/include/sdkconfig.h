@@ -0,0 +1,3 @@
+// 主机测试的 sdkconfig，只保留被测组件引用的选项
+#pragma once
+#define CONFIG_FREERTOS_HZ 100
@@ -0,0 +1,103 @@
+// timer_service 的主机测试: 到期时间、周期、取消，以及长时间空闲后启动定时器
+#include <stdio.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "timer_service.h"
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// 定时器服务依赖的事件总线接口，本测试只用回调型定时器
+esp_err_t event_bus_publish(const AppEvent_t *event, TickType_t ticks_to_wait)
+{
+    return ESP_OK;
+}
+
+static SemaphoreHandle_t s_fired;
+static volatile int s_fire_count;
+
+static double prv_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void prv_on_timer(timer_service_timer_t *timer, void *arg)
+{
+    s_fire_count++;
+    xSemaphoreGive(s_fired);
+}
+
+// 启动一个 delay_ms 的单次定时器，返回实际到期耗时 (ms)，超时返回 -1
+static double prv_measure_one_shot(timer_service_timer_t *timer, uint32_t delay_ms, double *start_cost_ms)
+{
+    double start = prv_now_ms();
+    CHECK(timer_service_start(timer, delay_ms, 0) == ESP_OK);
+    *start_cost_ms = prv_now_ms() - start;
+    if (xSemaphoreTake(s_fired, pdMS_TO_TICKS(delay_ms + 2000)) != pdPASS) {
+        return -1;
+    }
+    return prv_now_ms() - start;
+}
+
+static void test_one_shot_and_periodic(void)
+{
+    static timer_service_timer_t timer;
+    double start_cost;
+    timer_service_timer_init(&timer, prv_on_timer, NULL);
+
+    double elapsed = prv_measure_one_shot(&timer, 100, &start_cost);
+    CHECK(elapsed >= 90 && elapsed < 200);
+    CHECK(!timer_service_is_active(&timer));
+
+    s_fire_count = 0;
+    CHECK(timer_service_start(&timer, 50, 50) == ESP_OK);
+    vTaskDelay(pdMS_TO_TICKS(275));
+    CHECK(timer_service_cancel(&timer));
+    int fired = s_fire_count;
+    CHECK(fired >= 4 && fired <= 6);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    CHECK(s_fire_count == fired);
+    while (xSemaphoreTake(s_fired, 0) == pdPASS) {
+    }
+}
+
+// 时间轮为空时服务任务无限期休眠，不推进时间基准。之后再启动的定时器必须按当前时间计算，
+// 既不能在截断后立即到期，也不能让服务任务逐 tick 追赶整个空闲期
+static void test_start_after_long_idle(TickType_t idle_ticks)
+{
+    static timer_service_timer_t timer;
+    double start_cost;
+    timer_service_timer_init(&timer, prv_on_timer, NULL);
+
+    host_ticks_skip(idle_ticks);
+    double elapsed = prv_measure_one_shot(&timer, 100, &start_cost);
+    printf("idle %lu ticks: start %.3f ms, fired after %.1f ms\n", (unsigned long)idle_ticks, start_cost, elapsed);
+    CHECK(start_cost < 5);
+    CHECK(elapsed >= 90 && elapsed < 200);
+    CHECK(timer_service_get_next_deadline() == portMAX_DELAY);
+}
+
+int main(void)
+{
+    s_fired = xSemaphoreCreateCounting(16, 0);
+    CHECK(timer_service_init() == ESP_OK);
+    vTaskDelay(pdMS_TO_TICKS(20));
+
+    test_one_shot_and_periodic();
+    test_start_after_long_idle(100 * 60 * 60 * 24);   // 一天
+    test_start_after_long_idle(1UL << 27);            // 超过时间轮覆盖范围 (约15天)
+    test_start_after_long_idle(1UL << 31);            // 超过 int32 的一半 (约248天)
+
+    printf("%s (%d failures)\n", s_failures ? "FAILED" : "OK", s_failures);
+    return s_failures ? 1 : 0;
+}